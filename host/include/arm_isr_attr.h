@@ -0,0 +1,13 @@
+/*
+@file: arm_isr_attr.h
+@author: ZZH
+@date: 2026-10-19
+@info: host build stand-in, the simulated handlers are plain functions
+*/
+
+#ifndef __ARM_ISR_ATTR_H__
+#define __ARM_ISR_ATTR_H__
+
+#define ARM_IRQ
+
+#endif // __ARM_ISR_ATTR_H__
@@ -0,0 +1,48 @@
+/*
+@file: sim.h
+@author: ZZH
+@date: 2026-10-19
+@info: host side controls of the simulated peripherals, for test and
+       benchmark code that runs in the host build only
+*/
+
+#ifndef __SIM_H__
+#define __SIM_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include "stm32f10x.h"
+
+// exchange one frame with the device on the bus, mosi in, miso out
+typedef uint16_t (*sim_spi_dev_t)(void* ctx, uint16_t mosi);
+
+typedef struct
+{
+    // characters leave the USARTs at once instead of at the baud rate
+    int instant;
+    // time left to the firmware after the end of stdin
+    uint32_t linger_ms;
+} sim_opts_t;
+
+extern sim_opts_t sim_opts;
+
+// monotonic host time
+uint64_t sim_time_ns(void);
+
+// queue received characters, safe from any thread, returns the number taken
+size_t sim_usart_inject(USART_TypeDef* usart, const void* data, size_t len);
+// characters injected but not read by the firmware yet
+size_t sim_usart_rx_pending(USART_TypeDef* usart);
+// characters the firmware has sent so far, safe from any thread
+size_t sim_usart_tx_count(USART_TypeDef* usart);
+// transmitted characters go to fd, -1 drops them, USART1 writes to stdout
+int sim_usart_connect(USART_TypeDef* usart, int fd);
+
+// level of the pins configured as inputs
+void sim_gpio_set_input(GPIO_TypeDef* port, uint16_t pins, int level);
+uint16_t sim_gpio_get_output(GPIO_TypeDef* port);
+
+// NULL detaches, an idle bus reads all ones
+int sim_spi_attach(SPI_TypeDef* spi, sim_spi_dev_t dev, void* ctx);
+
+#endif // __SIM_H__
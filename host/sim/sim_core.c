@@ -0,0 +1,596 @@
+/*
+@file: sim_core.c
+@author: ZZH
+@date: 2026-10-19
+@info: the peripheral address ranges are mapped at their real addresses
+       without access rights, an access of the firmware faults, the page is
+       opened for the one faulting instruction (single stepped) and the
+       models run before and after it
+*/
+
+#define _GNU_SOURCE
+// before termios.h, which has macros named like the CR1 and CR2 registers
+#include "sim_model.h"
+#include "sim_cpu.h"
+
+#include <errno.h>
+#include <getopt.h>
+#include <malloc.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <termios.h>
+#include <time.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+#define SIM_PAGE_SIZE 0x1000UL
+#define EFLAGS_TF     0x100
+// page fault error code, set for a write access
+#define PF_WRITE      0x2
+
+#ifndef CONFIG_SIM_STACK_SIZE
+#define CONFIG_SIM_STACK_SIZE (1024 * 1024)
+#endif
+
+// how often the host thread lets the time run on the firmware thread
+#define SIM_TICK_MS 1
+
+typedef void (*init_func_t)(void);
+
+typedef struct
+{
+    uint32_t base;
+    uint32_t size;
+    uint8_t* view;
+} sim_window_t;
+
+extern int __real_main(void);
+extern const init_func_t __sinit_func[];
+extern const init_func_t __einit_func[];
+
+sim_opts_t sim_opts = {
+    .linger_ms = 200,
+};
+
+volatile uint32_t sim_primask;
+volatile uint32_t sim_in_isr;
+volatile uint32_t sim_irq_waiting;
+
+static sim_window_t windows[] = {
+    // APB1, APB2 and AHB up to the CRC unit
+    {.base = PERIPH_BASE, .size = 0x24000},
+    // SysTick, NVIC and SCB
+    {.base = SCS_BASE, .size = 0x1000},
+};
+
+static sim_model_t* models;
+static pthread_t cpu_thread;
+static volatile int cpu_started;
+
+// the access in flight between the fault and the trap after it
+static struct
+{
+    uintptr_t page;
+    sim_model_t* model;
+    uint32_t addr;
+    uint32_t old;
+    uint8_t write;
+    uint8_t active;
+    uint8_t irq_blocked;
+} trap;
+
+static struct termios term_saved;
+static int term_raw;
+
+uint64_t sim_time_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static sim_window_t* window_of(uintptr_t addr)
+{
+    for (size_t i = 0; i < sizeof(windows) / sizeof(windows[0]); i++) {
+        if (addr >= windows[i].base &&
+            addr - windows[i].base < windows[i].size)
+            return &windows[i];
+    }
+
+    return NULL;
+}
+
+volatile uint32_t* sim_reg_addr(uint32_t addr)
+{
+    sim_window_t* w = window_of(addr);
+
+    if (NULL == w)
+        return NULL;
+
+    return (volatile uint32_t*) (w->view + (addr - w->base));
+}
+
+void sim_model_add(sim_model_t* m)
+{
+    m->next = models;
+    models = m;
+}
+
+sim_model_t* sim_model_find(uint32_t addr)
+{
+    for (sim_model_t* m = models; NULL != m; m = m->next) {
+        if (addr >= m->base && addr - m->base < m->size)
+            return m;
+    }
+
+    return NULL;
+}
+
+void sim_model_reset(uint32_t rcc_off, uint32_t bits)
+{
+    for (sim_model_t* m = models; NULL != m; m = m->next) {
+        if (rcc_off == m->rcc_off && (bits & m->rcc_bit) && NULL != m->reset)
+            m->reset(m);
+    }
+}
+
+static uint32_t mem_read(const volatile void* p, uint32_t size)
+{
+    switch (size) {
+        case 1: return *(const volatile uint8_t*) p;
+        case 2: return *(const volatile uint16_t*) p;
+        default: return *(const volatile uint32_t*) p;
+    }
+}
+
+static void mem_write(volatile void* p, uint32_t size, uint32_t val)
+{
+    switch (size) {
+        case 1: *(volatile uint8_t*) p = val; break;
+        case 2: *(volatile uint16_t*) p = val; break;
+        default: *(volatile uint32_t*) p = val; break;
+    }
+}
+
+uint32_t sim_bus_read(uint32_t addr, uint32_t size)
+{
+    sim_window_t* w = window_of(addr);
+
+    // DMA addresses of the host build are plain (low) host pointers
+    if (NULL == w)
+        return mem_read((const void*) (uintptr_t) addr, size);
+
+    sim_model_t* m = sim_model_find(addr);
+    uint32_t word = addr & ~3U;
+
+    if (NULL != m && NULL != m->pre)
+        m->pre(m, word - m->base, 0);
+
+    uint32_t old = *sim_reg_addr(word);
+    uint32_t val = mem_read(w->view + (addr - w->base), size);
+
+    if (NULL != m && NULL != m->post)
+        m->post(m, word - m->base, 0, old);
+
+    return val;
+}
+
+void sim_bus_write(uint32_t addr, uint32_t size, uint32_t val)
+{
+    sim_window_t* w = window_of(addr);
+
+    if (NULL == w) {
+        mem_write((void*) (uintptr_t) addr, size, val);
+        return;
+    }
+
+    sim_model_t* m = sim_model_find(addr);
+    uint32_t word = addr & ~3U;
+
+    if (NULL != m && NULL != m->pre)
+        m->pre(m, word - m->base, 1);
+
+    uint32_t old = *sim_reg_addr(word);
+    mem_write(w->view + (addr - w->base), size, val);
+
+    if (NULL != m && NULL != m->post)
+        m->post(m, word - m->base, 1, old);
+}
+
+static void sim_advance(void)
+{
+    uint64_t now = sim_time_ns();
+
+    for (sim_model_t* m = models; NULL != m; m = m->next) {
+        if (NULL != m->advance)
+            m->advance(m, now);
+    }
+
+    sim_dma_service();
+}
+
+void sim_cpu_wake(void)
+{
+    if (cpu_started)
+        pthread_kill(cpu_thread, SIGUSR1);
+}
+
+void sim_irq_resume(void)
+{
+    pthread_kill(pthread_self(), SIGUSR1);
+}
+
+// interrupts do not nest, one handler runs to its end before the next
+static void sim_irq_dispatch(void)
+{
+    while (!sim_primask) {
+        int irqn = sim_nvic_take();
+
+        if (SIM_IRQ_NONE == irqn)
+            break;
+
+        sim_in_isr++;
+        sim_vector(irqn)();
+        sim_in_isr--;
+
+        sim_nvic_done(irqn);
+    }
+}
+
+static void sim_irq_signal(int sig)
+{
+    int saved = errno;
+
+    (void) sig;
+
+    sim_advance();
+    sim_irq_dispatch();
+
+    errno = saved;
+}
+
+static void sim_fault(int sig, siginfo_t* info, void* ctx)
+{
+    ucontext_t* uc = (ucontext_t*) ctx;
+    uintptr_t addr = (uintptr_t) info->si_addr;
+    int saved = errno;
+
+    // a real crash, let it happen again without the handler
+    if (trap.active || NULL == window_of(addr) ||
+        !pthread_equal(pthread_self(), cpu_thread)) {
+        signal(sig, SIG_DFL);
+        return;
+    }
+
+    trap.active = 1;
+    trap.write = 0 != (uc->uc_mcontext.gregs[REG_ERR] & PF_WRITE);
+    trap.page = addr & ~(SIM_PAGE_SIZE - 1);
+    trap.addr = (uint32_t) addr & ~3U;
+    trap.model = sim_model_find(trap.addr);
+
+    sim_advance();
+
+    if (NULL != trap.model && NULL != trap.model->pre)
+        trap.model->pre(trap.model, trap.addr - trap.model->base, trap.write);
+
+    trap.old = *sim_reg_addr(trap.addr);
+
+    // no interrupt between the access and the trap behind it
+    trap.irq_blocked = sigismember(&uc->uc_sigmask, SIGUSR1);
+    sigaddset(&uc->uc_sigmask, SIGUSR1);
+
+    mprotect((void*) trap.page, SIM_PAGE_SIZE, PROT_READ | PROT_WRITE);
+    uc->uc_mcontext.gregs[REG_EFL] |= EFLAGS_TF;
+
+    errno = saved;
+}
+
+static void sim_step(int sig, siginfo_t* info, void* ctx)
+{
+    ucontext_t* uc = (ucontext_t*) ctx;
+    int saved = errno;
+
+    (void) info;
+
+    // not ours, a breakpoint compiled into the firmware for example
+    if (!trap.active) {
+        signal(sig, SIG_DFL);
+        raise(sig);
+        return;
+    }
+
+    uc->uc_mcontext.gregs[REG_EFL] &= ~EFLAGS_TF;
+    mprotect((void*) trap.page, SIM_PAGE_SIZE, PROT_NONE);
+    trap.active = 0;
+
+    if (NULL != trap.model && NULL != trap.model->post)
+        trap.model->post(trap.model, trap.addr - trap.model->base, trap.write,
+                         trap.old);
+
+    sim_dma_service();
+
+    // taken as soon as the handler returns, right after the access
+    if (!trap.irq_blocked) {
+        sigdelset(&uc->uc_sigmask, SIGUSR1);
+        if (sim_irq_waiting && !sim_primask)
+            sim_irq_resume();
+    }
+
+    errno = saved;
+}
+
+static void sim_term_restore(void)
+{
+    if (term_raw)
+        tcsetattr(STDIN_FILENO, TCSANOW, &term_saved);
+}
+
+static void sim_term_signal(int sig)
+{
+    sim_term_restore();
+    signal(sig, SIG_DFL);
+    raise(sig);
+}
+
+// a terminal behaves like a serial terminal, no line editing and no echo
+static void sim_term_raw(void)
+{
+    if (!isatty(STDIN_FILENO) || 0 != tcgetattr(STDIN_FILENO, &term_saved))
+        return;
+
+    struct termios raw = term_saved;
+
+    raw.c_lflag &= ~(ICANON | ECHO);
+    raw.c_iflag &= ~ICRNL;
+    raw.c_cc[VMIN] = 1;
+    raw.c_cc[VTIME] = 0;
+
+    if (0 != tcsetattr(STDIN_FILENO, TCSANOW, &raw))
+        return;
+
+    term_raw = 1;
+    atexit(sim_term_restore);
+    signal(SIGINT, sim_term_signal);
+    signal(SIGTERM, sim_term_signal);
+}
+
+static int sim_map(void)
+{
+    size_t total = 0;
+
+    for (size_t i = 0; i < sizeof(windows) / sizeof(windows[0]); i++)
+        total += windows[i].size;
+
+    int fd = memfd_create("sim_regs", 0);
+    if (fd < 0 || 0 != ftruncate(fd, total))
+        return -errno;
+
+    off_t offset = 0;
+
+    // the firmware sees the registers at their addresses, the models see
+    // the same pages through a second mapping that never traps
+    for (size_t i = 0; i < sizeof(windows) / sizeof(windows[0]); i++) {
+        sim_window_t* w = &windows[i];
+        void* fw = mmap((void*) (uintptr_t) w->base, w->size, PROT_NONE,
+                        MAP_SHARED | MAP_FIXED_NOREPLACE, fd, offset);
+
+        if ((void*) (uintptr_t) w->base != fw)
+            return MAP_FAILED == fw ? -errno : -EEXIST;
+
+        w->view = mmap(NULL, w->size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                       fd, offset);
+        if (MAP_FAILED == w->view)
+            return -errno;
+
+        offset += w->size;
+    }
+
+    close(fd);
+
+    return 0;
+}
+
+static int sim_signals_init(void)
+{
+    struct sigaction sa;
+
+    memset(&sa, 0, sizeof(sa));
+    sigemptyset(&sa.sa_mask);
+    sigaddset(&sa.sa_mask, SIGUSR1);
+
+    sa.sa_sigaction = sim_fault;
+    sa.sa_flags = SA_SIGINFO | SA_RESTART;
+    if (0 != sigaction(SIGSEGV, &sa, NULL))
+        return -errno;
+
+    // the firmware may fault again from an interrupt handler run by us
+    sa.sa_sigaction = sim_step;
+    sa.sa_flags = SA_SIGINFO | SA_RESTART | SA_NODEFER;
+    if (0 != sigaction(SIGTRAP, &sa, NULL))
+        return -errno;
+
+    memset(&sa, 0, sizeof(sa));
+    sigemptyset(&sa.sa_mask);
+    sa.sa_handler = sim_irq_signal;
+    sa.sa_flags = SA_RESTART;
+    if (0 != sigaction(SIGUSR1, &sa, NULL))
+        return -errno;
+
+    return 0;
+}
+
+static void* sim_cpu_entry(void* arg)
+{
+    sigset_t set;
+
+    (void) arg;
+
+    cpu_thread = pthread_self();
+    cpu_started = 1;
+
+    sigemptyset(&set);
+    sigaddset(&set, SIGUSR1);
+    pthread_sigmask(SIG_UNBLOCK, &set, NULL);
+
+    // what Reset_Handler does before main
+    SystemInit();
+    for (const init_func_t* f = __sinit_func; f < __einit_func; f++)
+        (*f)();
+
+    exit(__real_main());
+}
+
+static int sim_cpu_start(void)
+{
+    pthread_attr_t attr;
+    pthread_t tid;
+    sigset_t set;
+
+    // the firmware casts pointers to 32 bits for the DMA, so its stack
+    // and the heap have to stay in the low 4GiB (the image is not PIE)
+    void* stack = mmap(NULL, CONFIG_SIM_STACK_SIZE, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_32BIT | MAP_STACK,
+                       -1, 0);
+    if (MAP_FAILED == stack)
+        return -errno;
+
+    mallopt(M_ARENA_MAX, 1);
+    mallopt(M_MMAP_MAX, 0);
+
+    // interrupts go to the firmware thread only
+    sigemptyset(&set);
+    sigaddset(&set, SIGUSR1);
+    pthread_sigmask(SIG_BLOCK, &set, NULL);
+
+    pthread_attr_init(&attr);
+    pthread_attr_setstack(&attr, stack, CONFIG_SIM_STACK_SIZE);
+    int ret = pthread_create(&tid, &attr, sim_cpu_entry, NULL);
+    pthread_attr_destroy(&attr);
+
+    return -ret;
+}
+
+static void sim_usage(const char* name)
+{
+    fprintf(stderr,
+            "usage: %s [-i] [-l ms]\n"
+            "  -i, --instant    no baud rate, characters leave at once\n"
+            "  -l, --linger ms  run time left after the end of stdin "
+            "(default %u)\n",
+            name, sim_opts.linger_ms);
+}
+
+static int sim_parse_args(int argc, char** argv)
+{
+    static const struct option long_opts[] = {
+        {"instant", no_argument, NULL, 'i'},
+        {"linger", required_argument, NULL, 'l'},
+        {"help", no_argument, NULL, 'h'},
+        {NULL, 0, NULL, 0},
+    };
+    int opt;
+
+    while (-1 != (opt = getopt_long(argc, argv, "il:h", long_opts, NULL))) {
+        switch (opt) {
+            case 'i': sim_opts.instant = 1; break;
+            case 'l': sim_opts.linger_ms = strtoul(optarg, NULL, 0); break;
+            default: sim_usage(argv[0]); return -EINVAL;
+        }
+    }
+
+    return 0;
+}
+
+// stdin goes to USART1 and the time base runs until stdin ends, like a
+// user at a terminal the input waits for the first output of the firmware
+static int sim_host_loop(void)
+{
+    char buf[64];
+    size_t len = 0, done = 0;
+    int eof = 0;
+    uint64_t drained_at = 0;
+
+    while (1) {
+        // hold back reading while USART1 still has our last chunk
+        int hold = eof || done < len || 0 == sim_usart_tx_count(USART1);
+        struct pollfd pfd = {
+            .fd = hold ? -1 : STDIN_FILENO,
+            .events = POLLIN,
+        };
+
+        if (poll(&pfd, 1, SIM_TICK_MS) > 0) {
+            ssize_t n = read(STDIN_FILENO, buf, sizeof(buf));
+
+            if (n <= 0) {
+                eof = 1;
+            } else {
+                len = n;
+                done = 0;
+            }
+        }
+
+        if (done < len)
+            done += sim_usart_inject(USART1, buf + done, len - done);
+
+        sim_cpu_wake();
+
+        if (!eof || done < len || 0 != sim_usart_rx_pending(USART1))
+            continue;
+
+        uint64_t now = sim_time_ns();
+
+        if (0 == drained_at)
+            drained_at = now;
+        else if (now - drained_at >= sim_opts.linger_ms * 1000000ULL)
+            return 0;
+    }
+}
+
+// the firmware main becomes __real_main (linked with --wrap=main)
+int __wrap_main(int argc, char** argv)
+{
+    int ret;
+
+    if (0 != sim_parse_args(argc, argv))
+        return 2;
+
+    ret = sim_map();
+    if (0 != ret) {
+        fprintf(stderr, "sim: cannot map the register file: %s\n",
+                strerror(-ret));
+        return 1;
+    }
+
+    sim_scs_init();
+    sim_rcc_init();
+    sim_gpio_init();
+    sim_usart_init();
+    sim_spi_init();
+    sim_dma_init();
+
+    for (sim_model_t* m = models; NULL != m; m = m->next) {
+        if (NULL != m->reset)
+            m->reset(m);
+    }
+
+    ret = sim_signals_init();
+    if (0 == ret) {
+        sim_term_raw();
+        ret = sim_cpu_start();
+    }
+
+    if (0 != ret) {
+        fprintf(stderr, "sim: cannot start the firmware: %s\n",
+                strerror(-ret));
+        return 1;
+    }
+
+    return sim_host_loop();
+}
@@ -0,0 +1,41 @@
+/*
+@file: sim_cpu.h
+@author: ZZH
+@date: 2026-10-19
+@info: PRIMASK and IPSR of the simulated core, interrupts are delivered to
+       the firmware thread as signals and run inside the signal handler
+*/
+
+#ifndef __SIM_CPU_H__
+#define __SIM_CPU_H__
+
+#include <stdint.h>
+
+extern volatile uint32_t sim_primask;
+extern volatile uint32_t sim_in_isr;
+// an interrupt is pending and enabled, set and cleared by the NVIC model
+extern volatile uint32_t sim_irq_waiting;
+
+// take the pending interrupts on the firmware thread
+void sim_irq_resume(void);
+
+static inline uint32_t sim_irq_save(void)
+{
+    uint32_t primask = sim_primask;
+
+    sim_primask = 1;
+    __asm volatile("" ::: "memory");
+
+    return primask;
+}
+
+static inline void sim_irq_restore(uint32_t primask)
+{
+    __asm volatile("" ::: "memory");
+    sim_primask = primask;
+
+    if (0 == primask && sim_irq_waiting)
+        sim_irq_resume();
+}
+
+#endif // __SIM_CPU_H__
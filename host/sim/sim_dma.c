@@ -0,0 +1,288 @@
+/*
+@file: sim_dma.c
+@author: ZZH
+@date: 2026-10-19
+@info: DMA1 with the fixed request mapping of the F1 parts, a channel moves
+       one item per request and the arbiter always serves the highest
+       priority first
+*/
+
+#include <stddef.h>
+#include "sim_model.h"
+
+#define DMA_CHAN_NUM    7
+#define DMA_CHAN_OFF(n) (DMA1_Channel1_BASE - DMA1_BASE + 0x14 * (n))
+#define DMA_ISR_OFF     offsetof(DMA_TypeDef, ISR)
+#define DMA_IFCR_OFF    offsetof(DMA_TypeDef, IFCR)
+#define CHAN_OFF(reg)   offsetof(DMA_Channel_TypeDef, reg)
+
+// flags of one channel in ISR, in the order GIF, TCIF, HTIF, TEIF
+#define FLAG_GIF  0x1U
+#define FLAG_TCIF 0x2U
+#define FLAG_HTIF 0x4U
+#define FLAG_TEIF 0x8U
+#define FLAG_ALL  0xFU
+
+typedef struct
+{
+    // latched when EN is set, like the shadow registers of the hardware
+    uint32_t par;
+    uint32_t mar;
+    uint16_t count;
+    uint16_t left;
+    uint32_t pnext;
+    uint32_t mnext;
+} sim_dma_chan_t;
+
+typedef struct
+{
+    uint8_t chan;
+    uint8_t kind;
+    uint32_t base;
+} sim_dma_route_t;
+
+// channel numbers are 1 based as in the reference manual
+static const sim_dma_route_t routes[] = {
+    {2, SIM_DMA_RX, SPI1_BASE},   {2, SIM_DMA_TX, USART3_BASE},
+    {3, SIM_DMA_TX, SPI1_BASE},   {3, SIM_DMA_RX, USART3_BASE},
+    {4, SIM_DMA_RX, SPI2_BASE},   {4, SIM_DMA_TX, USART1_BASE},
+    {5, SIM_DMA_TX, SPI2_BASE},   {5, SIM_DMA_RX, USART1_BASE},
+    {6, SIM_DMA_RX, USART2_BASE}, {7, SIM_DMA_TX, USART2_BASE},
+};
+
+#define ROUTE_NUM (sizeof(routes) / sizeof(routes[0]))
+
+static struct
+{
+    sim_model_t model;
+    sim_dma_chan_t chan[DMA_CHAN_NUM];
+    sim_model_t* route_model[ROUTE_NUM];
+    uint8_t busy;
+    uint8_t again;
+} dma;
+
+static inline volatile uint32_t* reg(uint32_t off)
+{
+    return sim_reg(&dma.model, off);
+}
+
+static inline volatile uint32_t* chan_reg(int n, uint32_t off)
+{
+    return reg(DMA_CHAN_OFF(n) + off);
+}
+
+static void dma_update_lines(void)
+{
+    uint32_t isr = *reg(DMA_ISR_OFF);
+
+    for (int n = 0; n < DMA_CHAN_NUM; n++) {
+        uint32_t flags = (isr >> (4 * n)) & FLAG_ALL;
+        uint32_t ccr = *chan_reg(n, CHAN_OFF(CCR));
+        // TCIE, HTIE and TEIE line up with TCIF, HTIF and TEIF
+        int level = 0 != (flags & ccr & (FLAG_TCIF | FLAG_HTIF | FLAG_TEIF));
+
+        sim_irq_line(DMA1_Channel1_IRQn + n, level);
+    }
+}
+
+static void dma_flag(int n, uint32_t flags)
+{
+    *reg(DMA_ISR_OFF) |= (flags | FLAG_GIF) << (4 * n);
+}
+
+static int dma_requested(int n)
+{
+    uint32_t ccr = *chan_reg(n, CHAN_OFF(CCR));
+
+    if (!(ccr & DMA_CCR1_EN) || 0 == dma.chan[n].left)
+        return 0;
+
+    if (ccr & DMA_CCR1_MEM2MEM)
+        return 1;
+
+    for (size_t i = 0; i < ROUTE_NUM; i++) {
+        sim_model_t* m = dma.route_model[i];
+
+        if (routes[i].chan != n + 1 || NULL == m || NULL == m->dma_req)
+            continue;
+
+        if (m->dma_req(m, routes[i].kind))
+            return 1;
+    }
+
+    return 0;
+}
+
+// highest PL first, the lower channel number wins a tie
+static int dma_arbitrate(void)
+{
+    int best = -1;
+    uint32_t best_pl = 0;
+
+    for (int n = 0; n < DMA_CHAN_NUM; n++) {
+        uint32_t pl = *chan_reg(n, CHAN_OFF(CCR)) & DMA_CCR1_PL;
+
+        if ((best < 0 || pl > best_pl) && dma_requested(n)) {
+            best = n;
+            best_pl = pl;
+        }
+    }
+
+    return best;
+}
+
+static void dma_step(int n)
+{
+    sim_dma_chan_t* c = &dma.chan[n];
+    uint32_t ccr = *chan_reg(n, CHAN_OFF(CCR));
+    uint32_t psize = 1U << ((ccr & DMA_CCR1_PSIZE) >> 8);
+    uint32_t msize = 1U << ((ccr & DMA_CCR1_MSIZE) >> 10);
+
+    if (ccr & DMA_CCR1_DIR)
+        sim_bus_write(c->pnext, psize, sim_bus_read(c->mnext, msize));
+    else
+        sim_bus_write(c->mnext, msize, sim_bus_read(c->pnext, psize));
+
+    if (ccr & DMA_CCR1_PINC)
+        c->pnext += psize;
+    if (ccr & DMA_CCR1_MINC)
+        c->mnext += msize;
+
+    c->left--;
+
+    if (c->left == c->count / 2)
+        dma_flag(n, FLAG_HTIF);
+
+    if (0 == c->left) {
+        dma_flag(n, FLAG_TCIF);
+
+        if (ccr & DMA_CCR1_CIRC) {
+            c->left = c->count;
+            c->pnext = c->par;
+            c->mnext = c->mar;
+        }
+    }
+
+    *chan_reg(n, CHAN_OFF(CNDTR)) = c->left;
+}
+
+void sim_dma_service(void)
+{
+    // a transfer runs the models, which may ask for another service
+    if (dma.busy) {
+        dma.again = 1;
+        return;
+    }
+
+    dma.busy = 1;
+
+    do {
+        int n;
+
+        dma.again = 0;
+        while ((n = dma_arbitrate()) >= 0)
+            dma_step(n);
+    } while (dma.again);
+
+    dma.busy = 0;
+
+    dma_update_lines();
+}
+
+static void dma_chan_write(int n, uint32_t off, uint32_t old)
+{
+    sim_dma_chan_t* c = &dma.chan[n];
+    uint32_t ccr = *chan_reg(n, CHAN_OFF(CCR));
+
+    switch (off) {
+        case CHAN_OFF(CCR):
+            if ((ccr & ~old) & DMA_CCR1_EN) {
+                c->par = *chan_reg(n, CHAN_OFF(CPAR));
+                c->mar = *chan_reg(n, CHAN_OFF(CMAR));
+                c->count = *chan_reg(n, CHAN_OFF(CNDTR)) & 0xFFFF;
+                c->left = c->count;
+                c->pnext = c->par;
+                c->mnext = c->mar;
+            }
+            break;
+
+        // the count and the addresses are locked while the channel runs
+        case CHAN_OFF(CNDTR):
+        case CHAN_OFF(CPAR):
+        case CHAN_OFF(CMAR):
+            if (ccr & DMA_CCR1_EN)
+                *chan_reg(n, off) = old;
+            break;
+
+        default: break;
+    }
+}
+
+static void dma_post(sim_model_t* m, uint32_t off, int write, uint32_t old)
+{
+    uint32_t val = *reg(off);
+
+    (void) m;
+
+    if (!write)
+        return;
+
+    if (DMA_ISR_OFF == off) {
+        *reg(off) = old;
+    } else if (DMA_IFCR_OFF == off) {
+        uint32_t clear = 0;
+
+        // CGIF clears all the flags of its channel
+        for (int n = 0; n < DMA_CHAN_NUM; n++) {
+            uint32_t bits = (val >> (4 * n)) & FLAG_ALL;
+
+            if (bits & FLAG_GIF)
+                bits = FLAG_ALL;
+            clear |= bits << (4 * n);
+        }
+
+        *reg(DMA_ISR_OFF) &= ~clear;
+        *reg(off) = 0;
+    } else if (off >= DMA_CHAN_OFF(0) && off < DMA_CHAN_OFF(DMA_CHAN_NUM)) {
+        int n = (off - DMA_CHAN_OFF(0)) / 0x14;
+
+        dma_chan_write(n, (off - DMA_CHAN_OFF(0)) % 0x14, old);
+    }
+
+    sim_dma_service();
+}
+
+static void dma_reset(sim_model_t* m)
+{
+    (void) m;
+
+    *reg(DMA_ISR_OFF) = 0;
+    *reg(DMA_IFCR_OFF) = 0;
+
+    for (int n = 0; n < DMA_CHAN_NUM; n++) {
+        *chan_reg(n, CHAN_OFF(CCR)) = 0;
+        *chan_reg(n, CHAN_OFF(CNDTR)) = 0;
+        *chan_reg(n, CHAN_OFF(CPAR)) = 0;
+        *chan_reg(n, CHAN_OFF(CMAR)) = 0;
+        dma.chan[n] = (sim_dma_chan_t) {0};
+    }
+
+    dma_update_lines();
+}
+
+void sim_dma_init(void)
+{
+    dma.model = (sim_model_t) {
+        .name = "dma1",
+        .base = DMA1_BASE,
+        .size = 0x400,
+        .reset = dma_reset,
+        .post = dma_post,
+    };
+
+    sim_model_add(&dma.model);
+
+    // the peripheral models are registered before the DMA
+    for (size_t i = 0; i < ROUTE_NUM; i++)
+        dma.route_model[i] = sim_model_find(routes[i].base);
+}
@@ -0,0 +1,144 @@
+/*
+@file: sim_gpio.c
+@author: ZZH
+@date: 2026-10-19
+@info: ports A to E, IDR reads back ODR on the output pins and the level
+       set by the host on the input pins
+*/
+
+#include <stddef.h>
+#include "sim_model.h"
+
+#define GPIO_OFF(reg) offsetof(GPIO_TypeDef, reg)
+#define GPIO_NUM      5
+
+typedef struct
+{
+    sim_model_t model;
+    uint16_t input;
+} sim_gpio_t;
+
+static sim_gpio_t ports[GPIO_NUM];
+
+static const uint32_t port_base[GPIO_NUM] = {
+    GPIOA_BASE, GPIOB_BASE, GPIOC_BASE, GPIOD_BASE, GPIOE_BASE,
+};
+
+static const uint32_t port_rcc[GPIO_NUM] = {
+    RCC_APB2Periph_GPIOA, RCC_APB2Periph_GPIOB, RCC_APB2Periph_GPIOC,
+    RCC_APB2Periph_GPIOD, RCC_APB2Periph_GPIOE,
+};
+
+static sim_gpio_t* port_of(GPIO_TypeDef* port)
+{
+    for (int i = 0; i < GPIO_NUM; i++) {
+        if ((uint32_t) (uintptr_t) port == ports[i].model.base)
+            return &ports[i];
+    }
+
+    return NULL;
+}
+
+// MODE is 00 for the input configurations only
+static uint16_t output_pins(const sim_model_t* m)
+{
+    uint32_t crl = *sim_reg(m, GPIO_OFF(CRL));
+    uint32_t crh = *sim_reg(m, GPIO_OFF(CRH));
+    uint16_t pins = 0;
+
+    for (int i = 0; i < 8; i++) {
+        if ((crl >> (4 * i)) & 0x3)
+            pins |= 1U << i;
+        if ((crh >> (4 * i)) & 0x3)
+            pins |= 1U << (i + 8);
+    }
+
+    return pins;
+}
+
+static void gpio_pre(sim_model_t* m, uint32_t off, int write)
+{
+    sim_gpio_t* g = (sim_gpio_t*) m;
+
+    if (write || GPIO_OFF(IDR) != off)
+        return;
+
+    uint16_t out = output_pins(m);
+
+    *sim_reg(m, off) = (*sim_reg(m, GPIO_OFF(ODR)) & out) | (g->input & ~out);
+}
+
+static void gpio_post(sim_model_t* m, uint32_t off, int write, uint32_t old)
+{
+    volatile uint32_t* odr = sim_reg(m, GPIO_OFF(ODR));
+    uint32_t val = *sim_reg(m, off);
+
+    if (!write)
+        return;
+
+    switch (off) {
+        // set wins over reset when both bits are written
+        case GPIO_OFF(BSRR):
+            *odr = (*odr & ~(val >> 16)) | (val & 0xFFFF);
+            *sim_reg(m, off) = 0;
+            break;
+
+        case GPIO_OFF(BRR):
+            *odr &= ~(val & 0xFFFF);
+            *sim_reg(m, off) = 0;
+            break;
+
+        case GPIO_OFF(IDR): *sim_reg(m, off) = old; break;
+
+        default: break;
+    }
+}
+
+static void gpio_reset(sim_model_t* m)
+{
+    *sim_reg(m, GPIO_OFF(CRL)) = 0x44444444;
+    *sim_reg(m, GPIO_OFF(CRH)) = 0x44444444;
+    *sim_reg(m, GPIO_OFF(IDR)) = 0;
+    *sim_reg(m, GPIO_OFF(ODR)) = 0;
+    *sim_reg(m, GPIO_OFF(BSRR)) = 0;
+    *sim_reg(m, GPIO_OFF(BRR)) = 0;
+    *sim_reg(m, GPIO_OFF(LCKR)) = 0;
+}
+
+void sim_gpio_set_input(GPIO_TypeDef* port, uint16_t pins, int level)
+{
+    sim_gpio_t* g = port_of(port);
+
+    if (NULL == g)
+        return;
+
+    if (level)
+        g->input |= pins;
+    else
+        g->input &= ~pins;
+}
+
+uint16_t sim_gpio_get_output(GPIO_TypeDef* port)
+{
+    sim_gpio_t* g = port_of(port);
+
+    return NULL == g ? 0 : *sim_reg(&g->model, GPIO_OFF(ODR));
+}
+
+void sim_gpio_init(void)
+{
+    for (int i = 0; i < GPIO_NUM; i++) {
+        ports[i].model = (sim_model_t) {
+            .name = "gpio",
+            .base = port_base[i],
+            .size = 0x400,
+            .rcc_off = offsetof(RCC_TypeDef, APB2RSTR),
+            .rcc_bit = port_rcc[i],
+            .reset = gpio_reset,
+            .pre = gpio_pre,
+            .post = gpio_post,
+        };
+
+        sim_model_add(&ports[i].model);
+    }
+}
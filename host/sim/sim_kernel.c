@@ -0,0 +1,23 @@
+/*
+@file: sim_kernel.c
+@author: ZZH
+@date: 2026-10-19
+@info: the host build has no scheduler, the time base still asks for one
+*/
+
+#include "kernel/kernel.h"
+
+int kernel_is_running(void)
+{
+    return 0;
+}
+
+void kernel_tick_step(uint32_t ticks)
+{
+    (void) ticks;
+}
+
+uint32_t kernel_ticks_to_next_wake(void)
+{
+    return UINT32_MAX;
+}
@@ -0,0 +1,91 @@
+/*
+@file: sim_model.h
+@author: ZZH
+@date: 2026-10-19
+@info: interface between the register file and the peripheral models
+*/
+
+#ifndef __SIM_MODEL_H__
+#define __SIM_MODEL_H__
+
+#include <stdint.h>
+#include "sim.h"
+
+#define SIM_IRQ_NONE (-100)
+
+enum {
+    SIM_DMA_TX,
+    SIM_DMA_RX,
+};
+
+typedef struct sim_model sim_model_t;
+
+/*
+ * the registers themselves live in the register file, a model only keeps
+ * the state that is not visible there and reacts to the accesses, all
+ * callbacks run on the firmware thread with the interrupts held off
+ */
+struct sim_model
+{
+    const char* name;
+    uint32_t base;
+    uint32_t size;
+    // the peripheral reset bit in RCC, rcc_off is 0 if there is none
+    uint32_t rcc_off;
+    uint32_t rcc_bit;
+    // load the reset values
+    void (*reset)(sim_model_t* m);
+    // before a firmware access, refresh registers that change by themselves
+    void (*pre)(sim_model_t* m, uint32_t off, int write);
+    // after the access, old is the register word before it
+    void (*post)(sim_model_t* m, uint32_t off, int write, uint32_t old);
+    // let the time run up to now
+    void (*advance)(sim_model_t* m, uint64_t now);
+    // DMA request line, kind is SIM_DMA_TX or SIM_DMA_RX
+    int (*dma_req)(sim_model_t* m, int kind);
+    sim_model_t* next;
+};
+
+void sim_model_add(sim_model_t* m);
+sim_model_t* sim_model_find(uint32_t addr);
+// reset the models behind the bits set in an RCC reset register
+void sim_model_reset(uint32_t rcc_off, uint32_t bits);
+
+// the register at addr seen from the model side, never traps
+volatile uint32_t* sim_reg_addr(uint32_t addr);
+
+static inline volatile uint32_t* sim_reg(const sim_model_t* m, uint32_t off)
+{
+    return sim_reg_addr(m->base + off);
+}
+
+// access through the bus like a DMA controller, with the model callbacks
+uint32_t sim_bus_read(uint32_t addr, uint32_t size);
+void sim_bus_write(uint32_t addr, uint32_t size, uint32_t val);
+
+// peripheral interrupt line, irqn as in IRQn_Type
+void sim_irq_line(int irqn, int level);
+// let the firmware thread catch up with the time, safe from any thread
+void sim_cpu_wake(void);
+
+// NVIC side of the dispatcher, take returns SIM_IRQ_NONE if nothing is due
+int sim_nvic_take(void);
+void sim_nvic_done(int irqn);
+
+// clocks as configured in RCC right now
+uint32_t sim_core_clock(void);
+uint32_t sim_apb_clock(int apb2);
+
+// run every enabled channel with a pending request
+void sim_dma_service(void);
+
+void (*sim_vector(int irqn))(void);
+
+void sim_scs_init(void);
+void sim_rcc_init(void);
+void sim_gpio_init(void);
+void sim_usart_init(void);
+void sim_spi_init(void);
+void sim_dma_init(void);
+
+#endif // __SIM_MODEL_H__
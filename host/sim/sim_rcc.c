@@ -0,0 +1,153 @@
+/*
+@file: sim_rcc.c
+@author: ZZH
+@date: 2026-10-19
+@info: oscillators and the PLL are ready as soon as they are switched on,
+       the clock switch follows SW whenever the selected source is ready
+*/
+
+#include <stddef.h>
+#include "sim_model.h"
+
+#define RCC_OFF(reg) offsetof(RCC_TypeDef, reg)
+
+#define CR_ON      (RCC_CR_HSION | RCC_CR_HSEON | RCC_CR_PLLON)
+#define CR_READY   (RCC_CR_HSIRDY | RCC_CR_HSERDY | RCC_CR_PLLRDY)
+#define CSR_FLAGS  0xFC000000U
+// power on and pin reset, what a board sees after being plugged in
+#define CSR_RESET  (RCC_CSR_PORRSTF | RCC_CSR_PINRSTF)
+
+static sim_model_t rcc;
+
+static const uint8_t ahb_shift[16] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 3, 4, 6, 7, 8, 9,
+};
+
+static const uint8_t apb_shift[8] = {0, 0, 0, 0, 1, 2, 3, 4};
+
+static inline volatile uint32_t* reg(uint32_t off)
+{
+    return sim_reg(&rcc, off);
+}
+
+static uint32_t sysclk(void)
+{
+    uint32_t cfgr = *reg(RCC_OFF(CFGR));
+
+    switch (cfgr & RCC_CFGR_SWS) {
+        case RCC_CFGR_SWS_HSE: return HSE_VALUE;
+        case RCC_CFGR_SWS_PLL: break;
+        default: return HSI_VALUE;
+    }
+
+    uint32_t mul = ((cfgr & RCC_CFGR_PLLMULL) >> 18) + 2;
+    uint32_t src = HSI_VALUE / 2;
+
+    // the last two encodings are both x16
+    if (mul > 16)
+        mul = 16;
+
+    if (cfgr & RCC_CFGR_PLLSRC)
+        src = (cfgr & RCC_CFGR_PLLXTPRE) ? HSE_VALUE / 2 : HSE_VALUE;
+
+    return src * mul;
+}
+
+uint32_t sim_core_clock(void)
+{
+    uint32_t cfgr = *reg(RCC_OFF(CFGR));
+
+    return sysclk() >> ahb_shift[(cfgr & RCC_CFGR_HPRE) >> 4];
+}
+
+uint32_t sim_apb_clock(int apb2)
+{
+    uint32_t cfgr = *reg(RCC_OFF(CFGR));
+    uint32_t pre = apb2 ? (cfgr & RCC_CFGR_PPRE2) >> 11
+                        : (cfgr & RCC_CFGR_PPRE1) >> 8;
+
+    return sim_core_clock() >> apb_shift[pre];
+}
+
+static int source_ready(uint32_t sw)
+{
+    uint32_t cr = *reg(RCC_OFF(CR));
+
+    switch (sw) {
+        case RCC_CFGR_SW_HSI: return 0 != (cr & RCC_CR_HSIRDY);
+        case RCC_CFGR_SW_HSE: return 0 != (cr & RCC_CR_HSERDY);
+        case RCC_CFGR_SW_PLL: return 0 != (cr & RCC_CR_PLLRDY);
+        default: return 0;
+    }
+}
+
+static void rcc_post(sim_model_t* m, uint32_t off, int write, uint32_t old)
+{
+    volatile uint32_t* r = reg(off);
+    uint32_t val = *r;
+
+    (void) m;
+
+    if (!write)
+        return;
+
+    switch (off) {
+        case RCC_OFF(CR):
+            // every RDY bit sits right above its ON bit
+            *r = (val & ~CR_READY) | ((val & CR_ON) << 1);
+            break;
+
+        case RCC_OFF(CFGR): {
+            uint32_t sw = val & RCC_CFGR_SW;
+            uint32_t sws = source_ready(sw) ? sw << 2 : old & RCC_CFGR_SWS;
+
+            *r = (val & ~RCC_CFGR_SWS) | sws;
+            break;
+        }
+
+        case RCC_OFF(APB2RSTR):
+        case RCC_OFF(APB1RSTR): sim_model_reset(off, val); break;
+
+        case RCC_OFF(BDCR):
+            *r = (val & ~RCC_BDCR_LSERDY) | ((val & RCC_BDCR_LSEON) << 1);
+            break;
+
+        case RCC_OFF(CSR):
+            *r = (val & ~RCC_CSR_LSIRDY) | ((val & RCC_CSR_LSION) << 1);
+            // RMVF clears the reset flags and itself
+            if (val & RCC_CSR_RMVF)
+                *r &= ~CSR_FLAGS & ~RCC_CSR_RMVF;
+            break;
+
+        default: break;
+    }
+}
+
+static void rcc_reset(sim_model_t* m)
+{
+    (void) m;
+
+    *reg(RCC_OFF(CR)) = 0x00000083;
+    *reg(RCC_OFF(CFGR)) = 0;
+    *reg(RCC_OFF(CIR)) = 0;
+    *reg(RCC_OFF(APB2RSTR)) = 0;
+    *reg(RCC_OFF(APB1RSTR)) = 0;
+    *reg(RCC_OFF(AHBENR)) = 0x00000014;
+    *reg(RCC_OFF(APB2ENR)) = 0;
+    *reg(RCC_OFF(APB1ENR)) = 0;
+    *reg(RCC_OFF(BDCR)) = 0;
+    *reg(RCC_OFF(CSR)) = CSR_RESET;
+}
+
+void sim_rcc_init(void)
+{
+    rcc = (sim_model_t) {
+        .name = "rcc",
+        .base = RCC_BASE,
+        .size = 0x400,
+        .reset = rcc_reset,
+        .post = rcc_post,
+    };
+
+    sim_model_add(&rcc);
+}
@@ -0,0 +1,294 @@
+/*
+@file: sim_scs.c
+@author: ZZH
+@date: 2026-10-19
+@info: system control space, SysTick counts with the host clock, the NVIC
+       latches the peripheral lines and picks the next handler to run
+*/
+
+#include <stddef.h>
+#include "sim_model.h"
+#include "sim_cpu.h"
+
+#define SYST_OFF(reg) (SysTick_BASE - SCS_BASE + offsetof(SysTick_Type, reg))
+#define NVIC_OFF(reg) (NVIC_BASE - SCS_BASE + offsetof(NVIC_Type, reg))
+#define SCB_OFF(reg)  (SCB_BASE - SCS_BASE + offsetof(SCB_Type, reg))
+
+#define NVIC_WORDS 3
+#define NVIC_NUM   (NVIC_WORDS * 32)
+
+// Cortex-M3 r1p1 and the 1ms calibration value of the F1 parts
+#define SIM_CPUID     0x411FC231
+#define SIM_SYST_CAL  0x40002328
+// SHP index of SysTick, the exception number less 4
+#define SHP_SYSTICK   11
+
+static struct
+{
+    sim_model_t model;
+    uint32_t line[NVIC_WORDS];
+    uint32_t pending[NVIC_WORDS];
+    uint32_t enabled[NVIC_WORDS];
+    uint32_t active[NVIC_WORDS];
+    // SysTick counts from epoch, wraps have been seen by the model
+    uint64_t epoch;
+    uint64_t wraps;
+    // ticks the handler still has to run for
+    uint32_t owed;
+} scs;
+
+static inline volatile uint32_t* reg(uint32_t off)
+{
+    return sim_reg(&scs.model, off);
+}
+
+static void nvic_sync(void)
+{
+    uint32_t waiting = 0;
+
+    for (int i = 0; i < NVIC_WORDS; i++) {
+        *reg(NVIC_OFF(ISER) + 4 * i) = scs.enabled[i];
+        *reg(NVIC_OFF(ICER) + 4 * i) = scs.enabled[i];
+        *reg(NVIC_OFF(ISPR) + 4 * i) = scs.pending[i];
+        *reg(NVIC_OFF(ICPR) + 4 * i) = scs.pending[i];
+        *reg(NVIC_OFF(IABR) + 4 * i) = scs.active[i];
+        waiting |= scs.enabled[i] & scs.pending[i];
+    }
+
+    if (0 != scs.owed)
+        *reg(SCB_OFF(ICSR)) |= SCB_ICSR_PENDSTSET_Msk;
+    else
+        *reg(SCB_OFF(ICSR)) &= ~SCB_ICSR_PENDSTSET_Msk;
+
+    sim_irq_waiting = 0 != waiting || 0 != scs.owed;
+}
+
+void sim_irq_line(int irqn, int level)
+{
+    if (irqn < 0 || irqn >= NVIC_NUM)
+        return;
+
+    uint32_t bit = 1U << (irqn % 32);
+
+    if (level) {
+        scs.line[irqn / 32] |= bit;
+        scs.pending[irqn / 32] |= bit;
+    } else {
+        scs.line[irqn / 32] &= ~bit;
+    }
+
+    nvic_sync();
+}
+
+static uint32_t irq_prio(int irqn)
+{
+    volatile uint8_t* ip = (volatile uint8_t*) reg(NVIC_OFF(IP));
+    volatile uint8_t* shp = (volatile uint8_t*) reg(SCB_OFF(SHP));
+
+    return (irqn < 0 ? shp[SHP_SYSTICK] : ip[irqn]) >> (8 - __NVIC_PRIO_BITS);
+}
+
+int sim_nvic_take(void)
+{
+    int best = SIM_IRQ_NONE;
+    uint32_t best_prio = UINT32_MAX;
+
+    // the exception number breaks a tie, SysTick comes first
+    if (0 != scs.owed) {
+        best = SysTick_IRQn;
+        best_prio = irq_prio(SysTick_IRQn);
+    }
+
+    for (int i = 0; i < NVIC_NUM; i++) {
+        uint32_t bit = 1U << (i % 32);
+
+        if (!(scs.enabled[i / 32] & scs.pending[i / 32] & bit))
+            continue;
+
+        if (irq_prio(i) < best_prio) {
+            best = i;
+            best_prio = irq_prio(i);
+        }
+    }
+
+    if (SysTick_IRQn == best)
+        scs.owed--;
+    else if (SIM_IRQ_NONE != best) {
+        scs.pending[best / 32] &= ~(1U << (best % 32));
+        scs.active[best / 32] |= 1U << (best % 32);
+    }
+
+    nvic_sync();
+
+    return best;
+}
+
+void sim_nvic_done(int irqn)
+{
+    if (irqn < 0)
+        return;
+
+    uint32_t bit = 1U << (irqn % 32);
+
+    // a line still asserted pends the interrupt again
+    scs.active[irqn / 32] &= ~bit;
+    scs.pending[irqn / 32] |= scs.line[irqn / 32] & bit;
+
+    nvic_sync();
+}
+
+static uint64_t systick_cycles(uint64_t now)
+{
+    uint32_t hz = sim_core_clock();
+
+    if (!(*reg(SYST_OFF(CTRL)) & SysTick_CTRL_CLKSOURCE_Msk))
+        hz /= 8;
+
+    uint64_t ns = now - scs.epoch;
+
+    // in whole seconds first, ns * hz overflows after a few minutes
+    return ns / 1000000000U * hz + ns % 1000000000U * hz / 1000000000U;
+}
+
+static inline uint64_t systick_period(void)
+{
+    return (*reg(SYST_OFF(LOAD)) & SysTick_LOAD_RELOAD_Msk) + 1;
+}
+
+static void systick_restart(void)
+{
+    scs.epoch = sim_time_ns();
+    scs.wraps = 0;
+}
+
+// a host that falls behind gets every tick it missed, late
+static void scs_advance(sim_model_t* m, uint64_t now)
+{
+    uint32_t ctrl = *reg(SYST_OFF(CTRL));
+
+    (void) m;
+
+    if (!(ctrl & SysTick_CTRL_ENABLE_Msk))
+        return;
+
+    uint64_t wraps = systick_cycles(now) / systick_period();
+
+    if (wraps == scs.wraps)
+        return;
+
+    *reg(SYST_OFF(CTRL)) = ctrl | SysTick_CTRL_COUNTFLAG_Msk;
+    if (ctrl & SysTick_CTRL_TICKINT_Msk)
+        scs.owed += wraps - scs.wraps;
+    scs.wraps = wraps;
+
+    nvic_sync();
+}
+
+static void scs_pre(sim_model_t* m, uint32_t off, int write)
+{
+    (void) m;
+
+    if (write || SYST_OFF(VAL) != off)
+        return;
+
+    uint32_t ctrl = *reg(SYST_OFF(CTRL));
+    uint64_t period = systick_period();
+
+    if (ctrl & SysTick_CTRL_ENABLE_Msk) {
+        uint64_t phase = systick_cycles(sim_time_ns()) % period;
+        *reg(SYST_OFF(VAL)) = (uint32_t) (period - 1 - phase);
+    }
+}
+
+static void nvic_write(uint32_t off, uint32_t val)
+{
+    uint32_t i = (off & 0x7F) / 4;
+
+    if (i >= NVIC_WORDS)
+        return;
+
+    if (off >= NVIC_OFF(ISER) && off < NVIC_OFF(ICER))
+        scs.enabled[i] |= val;
+    else if (off >= NVIC_OFF(ICER) && off < NVIC_OFF(ISPR))
+        scs.enabled[i] &= ~val;
+    else if (off >= NVIC_OFF(ISPR) && off < NVIC_OFF(ICPR))
+        scs.pending[i] |= val;
+    else if (off >= NVIC_OFF(ICPR) && off < NVIC_OFF(IABR))
+        scs.pending[i] &= ~val;
+}
+
+static void scs_post(sim_model_t* m, uint32_t off, int write, uint32_t old)
+{
+    uint32_t val = *reg(off);
+
+    (void) m;
+
+    if (!write) {
+        // COUNTFLAG clears on read
+        if (SYST_OFF(CTRL) == off)
+            *reg(off) = val & ~SysTick_CTRL_COUNTFLAG_Msk;
+        return;
+    }
+
+    if (SYST_OFF(CTRL) == off) {
+        if ((val & ~old) & SysTick_CTRL_ENABLE_Msk)
+            systick_restart();
+    } else if (SYST_OFF(LOAD) == off) {
+        systick_restart();
+    } else if (SYST_OFF(VAL) == off) {
+        // any write clears the counter and COUNTFLAG
+        *reg(off) = 0;
+        *reg(SYST_OFF(CTRL)) &= ~SysTick_CTRL_COUNTFLAG_Msk;
+        systick_restart();
+    } else if (SYST_OFF(CALIB) == off || SCB_OFF(CPUID) == off) {
+        *reg(off) = old;
+    } else if (SCB_OFF(ICSR) == off) {
+        if (val & SCB_ICSR_PENDSTCLR_Msk)
+            scs.owed = 0;
+        else if (val & SCB_ICSR_PENDSTSET_Msk)
+            scs.owed++;
+        // the PendSV bits have nothing to switch without the kernel
+        *reg(off) = old;
+    } else if (off >= NVIC_OFF(ISER) && off < NVIC_OFF(IABR)) {
+        nvic_write(off, val);
+    } else if (off >= NVIC_OFF(IABR) && off < NVIC_OFF(IP)) {
+        *reg(off) = old;
+    } else {
+        return;
+    }
+
+    nvic_sync();
+}
+
+static void scs_reset(sim_model_t* m)
+{
+    (void) m;
+
+    for (int i = 0; i < NVIC_WORDS; i++) {
+        scs.line[i] = 0;
+        scs.pending[i] = 0;
+        scs.enabled[i] = 0;
+        scs.active[i] = 0;
+    }
+
+    scs.owed = 0;
+    *reg(SCB_OFF(CPUID)) = SIM_CPUID;
+    *reg(SYST_OFF(CALIB)) = SIM_SYST_CAL;
+    systick_restart();
+    nvic_sync();
+}
+
+void sim_scs_init(void)
+{
+    scs.model = (sim_model_t) {
+        .name = "scs",
+        .base = SCS_BASE,
+        .size = 0x1000,
+        .reset = scs_reset,
+        .pre = scs_pre,
+        .post = scs_post,
+        .advance = scs_advance,
+    };
+
+    sim_model_add(&scs.model);
+}
@@ -0,0 +1,177 @@
+/*
+@file: sim_spi.c
+@author: ZZH
+@date: 2026-10-19
+@info: master mode only, a DR write exchanges the frame with the attached
+       device at once, MISO idles high when nothing is attached
+*/
+
+#include <stddef.h>
+#include "sim_model.h"
+
+#define SPI_OFF(reg) offsetof(SPI_TypeDef, reg)
+#define SPI_NUM      2
+
+typedef struct
+{
+    sim_model_t model;
+    int irqn;
+    sim_spi_dev_t dev;
+    void* ctx;
+    // what DR reads back
+    uint16_t rx_data;
+} sim_spi_t;
+
+static sim_spi_t spis[SPI_NUM];
+
+static sim_spi_t* spi_of(SPI_TypeDef* spi)
+{
+    for (int i = 0; i < SPI_NUM; i++) {
+        if ((uint32_t) (uintptr_t) spi == spis[i].model.base)
+            return &spis[i];
+    }
+
+    return NULL;
+}
+
+static inline volatile uint32_t* reg(sim_spi_t* s, uint32_t off)
+{
+    return sim_reg(&s->model, off);
+}
+
+static void spi_update_line(sim_spi_t* s)
+{
+    uint32_t sr = *reg(s, SPI_OFF(SR));
+    uint32_t cr2 = *reg(s, SPI_OFF(CR2));
+    int level = 0;
+
+    if ((cr2 & SPI_CR2_RXNEIE) && (sr & SPI_SR_RXNE))
+        level = 1;
+    if ((cr2 & SPI_CR2_TXEIE) && (sr & SPI_SR_TXE))
+        level = 1;
+    if ((cr2 & SPI_CR2_ERRIE) && (sr & (SPI_SR_OVR | SPI_SR_MODF)))
+        level = 1;
+
+    sim_irq_line(s->irqn, level);
+}
+
+static void spi_exchange(sim_spi_t* s, uint16_t mosi)
+{
+    volatile uint32_t* sr = reg(s, SPI_OFF(SR));
+    uint16_t mask = (*reg(s, SPI_OFF(CR1)) & SPI_CR1_DFF) ? 0xFFFF : 0xFF;
+    uint16_t miso = NULL == s->dev ? 0xFFFF : s->dev(s->ctx, mosi & mask);
+
+    // the new frame is lost when the last one was never read
+    if (*sr & SPI_SR_RXNE)
+        *sr |= SPI_SR_OVR;
+    else
+        s->rx_data = miso & mask;
+
+    *sr |= SPI_SR_RXNE | SPI_SR_TXE;
+}
+
+static void spi_post(sim_model_t* m, uint32_t off, int write, uint32_t old)
+{
+    sim_spi_t* s = (sim_spi_t*) m;
+    volatile uint32_t* sr = reg(s, SPI_OFF(SR));
+    uint32_t val = *reg(s, off);
+
+    switch (off) {
+        case SPI_OFF(DR):
+            if (!write) {
+                *sr &= ~SPI_SR_RXNE;
+                break;
+            }
+
+            if (*reg(s, SPI_OFF(CR1)) & SPI_CR1_SPE)
+                spi_exchange(s, val);
+            *reg(s, off) = s->rx_data;
+            break;
+
+        // only CRCERR is cleared by software, the rest is read-only
+        case SPI_OFF(SR):
+            if (write)
+                *sr = old & ~(SPI_SR_CRCERR & ~val);
+            break;
+
+        default: break;
+    }
+
+    spi_update_line(s);
+}
+
+static int spi_dma_req(sim_model_t* m, int kind)
+{
+    sim_spi_t* s = (sim_spi_t*) m;
+    uint32_t sr = *reg(s, SPI_OFF(SR));
+    uint32_t cr2 = *reg(s, SPI_OFF(CR2));
+
+    if (SIM_DMA_TX == kind)
+        return (cr2 & SPI_CR2_TXDMAEN) && (sr & SPI_SR_TXE);
+
+    return (cr2 & SPI_CR2_RXDMAEN) && (sr & SPI_SR_RXNE);
+}
+
+static void spi_reset(sim_model_t* m)
+{
+    sim_spi_t* s = (sim_spi_t*) m;
+
+    *reg(s, SPI_OFF(CR1)) = 0;
+    *reg(s, SPI_OFF(CR2)) = 0;
+    *reg(s, SPI_OFF(SR)) = SPI_SR_TXE;
+    *reg(s, SPI_OFF(DR)) = 0;
+    *reg(s, SPI_OFF(CRCPR)) = 7;
+    *reg(s, SPI_OFF(RXCRCR)) = 0;
+    *reg(s, SPI_OFF(TXCRCR)) = 0;
+    *reg(s, SPI_OFF(I2SCFGR)) = 0;
+    *reg(s, SPI_OFF(I2SPR)) = 2;
+
+    s->rx_data = 0;
+
+    spi_update_line(s);
+}
+
+int sim_spi_attach(SPI_TypeDef* spi, sim_spi_dev_t dev, void* ctx)
+{
+    sim_spi_t* s = spi_of(spi);
+
+    if (NULL == s)
+        return -1;
+
+    s->dev = dev;
+    s->ctx = ctx;
+
+    return 0;
+}
+
+void sim_spi_init(void)
+{
+    static const struct
+    {
+        uint32_t base;
+        int irqn;
+        uint32_t rcc_off;
+        uint32_t rcc_bit;
+    } cfg[SPI_NUM] = {
+        {SPI1_BASE, SPI1_IRQn, offsetof(RCC_TypeDef, APB2RSTR),
+         RCC_APB2Periph_SPI1},
+        {SPI2_BASE, SPI2_IRQn, offsetof(RCC_TypeDef, APB1RSTR),
+         RCC_APB1Periph_SPI2},
+    };
+
+    for (int i = 0; i < SPI_NUM; i++) {
+        spis[i].model = (sim_model_t) {
+            .name = "spi",
+            .base = cfg[i].base,
+            .size = 0x400,
+            .rcc_off = cfg[i].rcc_off,
+            .rcc_bit = cfg[i].rcc_bit,
+            .reset = spi_reset,
+            .post = spi_post,
+            .dma_req = spi_dma_req,
+        };
+        spis[i].irqn = cfg[i].irqn;
+
+        sim_model_add(&spis[i].model);
+    }
+}
@@ -0,0 +1,355 @@
+/*
+@file: sim_usart.c
+@author: ZZH
+@date: 2026-10-19
+@info: DR feeds a holding register and a shift register that drain at the
+       baud rate from BRR, received characters are injected by the host and
+       show up one character time apart
+*/
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <unistd.h>
+#include "sim_model.h"
+
+#define USART_OFF(reg) offsetof(USART_TypeDef, reg)
+#define USART_NUM      3
+
+#define RX_RING_SIZE 256
+#define OUT_BUF_SIZE 64
+// a character RXNE was cleared for by hand is dropped after this long
+#define RX_DROP_NS   1000000ULL
+
+// cleared by a DR read, the rest of SR is read-only or cleared by writing 0
+#define SR_RX_FLAGS                                                        \
+    (USART_SR_RXNE | USART_SR_ORE | USART_SR_NE | USART_SR_FE | USART_SR_PE | \
+     USART_SR_IDLE)
+#define SR_W0C (USART_SR_RXNE | USART_SR_TC | USART_SR_LBD | USART_SR_CTS)
+
+typedef struct
+{
+    sim_model_t model;
+    int irqn;
+    int apb2;
+    int fd;
+
+    // written by sim_usart_inject on any thread, read by the model
+    _Atomic uint32_t rx_head;
+    _Atomic uint32_t rx_tail;
+    uint8_t rx_ring[RX_RING_SIZE];
+    // what DR reads back, DR itself is shared with the transmit side
+    uint16_t rx_data;
+    uint8_t rx_unread;
+    uint64_t rx_next;
+    uint64_t rx_drop;
+
+    uint16_t tx_hold;
+    uint16_t tx_shift;
+    uint8_t tx_held;
+    uint8_t tx_busy;
+    uint64_t tx_done;
+
+    uint8_t out[OUT_BUF_SIZE];
+    uint32_t out_len;
+    _Atomic uint32_t tx_count;
+} sim_usart_t;
+
+static sim_usart_t usarts[USART_NUM];
+
+static sim_usart_t* usart_of(USART_TypeDef* usart)
+{
+    for (int i = 0; i < USART_NUM; i++) {
+        if ((uint32_t) (uintptr_t) usart == usarts[i].model.base)
+            return &usarts[i];
+    }
+
+    return NULL;
+}
+
+static inline volatile uint32_t* reg(sim_usart_t* u, uint32_t off)
+{
+    return sim_reg(&u->model, off);
+}
+
+static void usart_flush(sim_usart_t* u)
+{
+    uint32_t done = 0;
+
+    while (u->fd >= 0 && done < u->out_len) {
+        ssize_t n = write(u->fd, u->out + done, u->out_len - done);
+
+        if (n <= 0)
+            break;
+
+        done += n;
+    }
+
+    u->out_len = 0;
+}
+
+static void usart_emit(sim_usart_t* u, uint16_t data)
+{
+    u->out[u->out_len++] = (uint8_t) data;
+    atomic_fetch_add_explicit(&u->tx_count, 1, memory_order_relaxed);
+
+    if (OUT_BUF_SIZE == u->out_len)
+        usart_flush(u);
+}
+
+// start, data and stop bits, no time at all in instant mode
+static uint64_t char_ns(sim_usart_t* u)
+{
+    uint32_t brr = *reg(u, USART_OFF(BRR)) & 0xFFFF;
+    uint32_t cr1 = *reg(u, USART_OFF(CR1));
+    uint32_t cr2 = *reg(u, USART_OFF(CR2));
+
+    if (sim_opts.instant || 0 == brr)
+        return 0;
+
+    uint32_t bits = 1 + ((cr1 & USART_CR1_M) ? 9 : 8) +
+                    ((cr2 & USART_CR2_STOP_1) ? 2 : 1);
+
+    return (uint64_t) bits * brr * 1000000000ULL / sim_apb_clock(u->apb2);
+}
+
+static void usart_update_line(sim_usart_t* u)
+{
+    uint32_t sr = *reg(u, USART_OFF(SR));
+    uint32_t cr1 = *reg(u, USART_OFF(CR1));
+    int level = 0;
+
+    if ((cr1 & USART_CR1_RXNEIE) &&
+        (sr & (USART_SR_RXNE | USART_SR_ORE)))
+        level = 1;
+    if ((cr1 & USART_CR1_TXEIE) && (sr & USART_SR_TXE))
+        level = 1;
+    if ((cr1 & USART_CR1_TCIE) && (sr & USART_SR_TC))
+        level = 1;
+    if ((cr1 & USART_CR1_IDLEIE) && (sr & USART_SR_IDLE))
+        level = 1;
+
+    sim_irq_line(u->irqn, level);
+}
+
+static void usart_advance(sim_model_t* m, uint64_t now)
+{
+    sim_usart_t* u = (sim_usart_t*) m;
+    volatile uint32_t* sr = reg(u, USART_OFF(SR));
+    uint32_t cr1 = *reg(u, USART_OFF(CR1));
+
+    while (u->tx_busy && now >= u->tx_done) {
+        usart_emit(u, u->tx_shift);
+        u->tx_busy = 0;
+
+        // the next character follows without a gap
+        if (u->tx_held) {
+            u->tx_shift = u->tx_hold;
+            u->tx_held = 0;
+            u->tx_busy = 1;
+            u->tx_done += char_ns(u);
+            *sr |= USART_SR_TXE;
+        } else {
+            *sr |= USART_SR_TC;
+        }
+    }
+
+    uint32_t head = atomic_load_explicit(&u->rx_head, memory_order_acquire);
+    uint32_t tail = atomic_load_explicit(&u->rx_tail, memory_order_relaxed);
+
+    // the firmware runs much slower than on the chip, so instead of an
+    // overrun the next character waits until the last one was read
+    if ((cr1 & USART_CR1_UE) && (cr1 & USART_CR1_RE) &&
+        !(*sr & USART_SR_RXNE) && now >= u->rx_next && head != tail &&
+        (!u->rx_unread || now >= u->rx_drop)) {
+        u->rx_data = u->rx_ring[tail % RX_RING_SIZE];
+        u->rx_unread = 1;
+        atomic_store_explicit(&u->rx_tail, tail + 1, memory_order_release);
+
+        *reg(u, USART_OFF(DR)) = u->rx_data;
+        *sr |= USART_SR_RXNE;
+        u->rx_next = now + char_ns(u);
+    }
+
+    usart_flush(u);
+    usart_update_line(u);
+}
+
+static void usart_transmit(sim_usart_t* u, uint16_t data)
+{
+    volatile uint32_t* sr = reg(u, USART_OFF(SR));
+
+    // a write with TXE clear overwrites the character waiting in there
+    if (u->tx_busy) {
+        u->tx_hold = data;
+        u->tx_held = 1;
+        *sr &= ~(USART_SR_TXE | USART_SR_TC);
+        return;
+    }
+
+    u->tx_shift = data;
+    u->tx_busy = 1;
+    u->tx_done = sim_time_ns() + char_ns(u);
+    *sr = (*sr | USART_SR_TXE) & ~USART_SR_TC;
+}
+
+static void usart_post(sim_model_t* m, uint32_t off, int write, uint32_t old)
+{
+    sim_usart_t* u = (sim_usart_t*) m;
+    volatile uint32_t* sr = reg(u, USART_OFF(SR));
+    uint32_t cr1 = *reg(u, USART_OFF(CR1));
+    uint32_t val = *reg(u, off);
+
+    switch (off) {
+        case USART_OFF(DR):
+            if (!write) {
+                *sr &= ~SR_RX_FLAGS;
+                u->rx_unread = 0;
+                break;
+            }
+
+            *reg(u, off) = u->rx_data;
+            if ((cr1 & USART_CR1_UE) && (cr1 & USART_CR1_TE))
+                usart_transmit(u, val & 0x1FF);
+            break;
+
+        case USART_OFF(SR):
+            if (!write)
+                break;
+
+            *sr = old & ~(SR_W0C & ~val);
+            if ((old & ~*sr) & USART_SR_RXNE)
+                u->rx_drop = sim_time_ns() + RX_DROP_NS;
+            break;
+
+        default: break;
+    }
+
+    usart_advance(m, sim_time_ns());
+}
+
+static int usart_dma_req(sim_model_t* m, int kind)
+{
+    sim_usart_t* u = (sim_usart_t*) m;
+    uint32_t sr = *reg(u, USART_OFF(SR));
+    uint32_t cr3 = *reg(u, USART_OFF(CR3));
+
+    if (SIM_DMA_TX == kind)
+        return (cr3 & USART_CR3_DMAT) && (sr & USART_SR_TXE);
+
+    return (cr3 & USART_CR3_DMAR) && (sr & USART_SR_RXNE);
+}
+
+static void usart_reset(sim_model_t* m)
+{
+    sim_usart_t* u = (sim_usart_t*) m;
+
+    *reg(u, USART_OFF(SR)) = USART_SR_TXE | USART_SR_TC;
+    *reg(u, USART_OFF(DR)) = 0;
+    *reg(u, USART_OFF(BRR)) = 0;
+    *reg(u, USART_OFF(CR1)) = 0;
+    *reg(u, USART_OFF(CR2)) = 0;
+    *reg(u, USART_OFF(CR3)) = 0;
+    *reg(u, USART_OFF(GTPR)) = 0;
+
+    u->rx_data = 0;
+    u->rx_unread = 0;
+    u->rx_next = 0;
+    u->tx_held = 0;
+    u->tx_busy = 0;
+    u->out_len = 0;
+
+    usart_update_line(u);
+}
+
+size_t sim_usart_inject(USART_TypeDef* usart, const void* data, size_t len)
+{
+    sim_usart_t* u = usart_of(usart);
+    const uint8_t* p = (const uint8_t*) data;
+    size_t n = 0;
+
+    if (NULL == u)
+        return 0;
+
+    uint32_t head = atomic_load_explicit(&u->rx_head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&u->rx_tail, memory_order_acquire);
+
+    for (; n < len && head - tail < RX_RING_SIZE; n++, head++)
+        u->rx_ring[head % RX_RING_SIZE] = p[n];
+
+    atomic_store_explicit(&u->rx_head, head, memory_order_release);
+
+    if (0 != n)
+        sim_cpu_wake();
+
+    return n;
+}
+
+size_t sim_usart_rx_pending(USART_TypeDef* usart)
+{
+    sim_usart_t* u = usart_of(usart);
+
+    if (NULL == u)
+        return 0;
+
+    return atomic_load(&u->rx_head) - atomic_load(&u->rx_tail);
+}
+
+size_t sim_usart_tx_count(USART_TypeDef* usart)
+{
+    sim_usart_t* u = usart_of(usart);
+
+    return NULL == u ? 0 : atomic_load(&u->tx_count);
+}
+
+int sim_usart_connect(USART_TypeDef* usart, int fd)
+{
+    sim_usart_t* u = usart_of(usart);
+
+    if (NULL == u)
+        return -1;
+
+    u->fd = fd;
+
+    return 0;
+}
+
+void sim_usart_init(void)
+{
+    static const struct
+    {
+        uint32_t base;
+        int irqn;
+        int apb2;
+        uint32_t rcc_off;
+        uint32_t rcc_bit;
+    } cfg[USART_NUM] = {
+        {USART1_BASE, USART1_IRQn, 1, offsetof(RCC_TypeDef, APB2RSTR),
+         RCC_APB2Periph_USART1},
+        {USART2_BASE, USART2_IRQn, 0, offsetof(RCC_TypeDef, APB1RSTR),
+         RCC_APB1Periph_USART2},
+        {USART3_BASE, USART3_IRQn, 0, offsetof(RCC_TypeDef, APB1RSTR),
+         RCC_APB1Periph_USART3},
+    };
+
+    for (int i = 0; i < USART_NUM; i++) {
+        usarts[i].model = (sim_model_t) {
+            .name = "usart",
+            .base = cfg[i].base,
+            .size = 0x400,
+            .rcc_off = cfg[i].rcc_off,
+            .rcc_bit = cfg[i].rcc_bit,
+            .reset = usart_reset,
+            .post = usart_post,
+            .advance = usart_advance,
+            .dma_req = usart_dma_req,
+        };
+        usarts[i].irqn = cfg[i].irqn;
+        usarts[i].apb2 = cfg[i].apb2;
+        usarts[i].fd = -1;
+
+        sim_model_add(&usarts[i].model);
+    }
+
+    // the console of the board
+    usarts[0].fd = STDOUT_FILENO;
+}
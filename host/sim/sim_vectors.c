@@ -0,0 +1,121 @@
+/*
+@file: sim_vectors.c
+@author: ZZH
+@date: 2026-10-19
+@info: the vector table of the host build, the handlers the firmware does
+       not define fall back to an empty one as in the startup file
+*/
+
+#include "sim_model.h"
+
+#define HANDLER_ALIAS(name) __attribute__((__alias__(#name), __weak__))
+#define NULL_HANDLER(name)  void name(void) HANDLER_ALIAS(sim_null_handler)
+
+typedef void (*sim_handler_t)(void);
+
+void sim_null_handler(void)
+{
+}
+
+NULL_HANDLER(SysTick_Handler);
+NULL_HANDLER(WWDG_IRQHandler);
+NULL_HANDLER(PVD_IRQHandler);
+NULL_HANDLER(TAMPER_IRQHandler);
+NULL_HANDLER(RTC_IRQHandler);
+NULL_HANDLER(FLASH_IRQHandler);
+NULL_HANDLER(RCC_IRQHandler);
+NULL_HANDLER(EXTI0_IRQHandler);
+NULL_HANDLER(EXTI1_IRQHandler);
+NULL_HANDLER(EXTI2_IRQHandler);
+NULL_HANDLER(EXTI3_IRQHandler);
+NULL_HANDLER(EXTI4_IRQHandler);
+NULL_HANDLER(DMA1_Channel1_IRQHandler);
+NULL_HANDLER(DMA1_Channel2_IRQHandler);
+NULL_HANDLER(DMA1_Channel3_IRQHandler);
+NULL_HANDLER(DMA1_Channel4_IRQHandler);
+NULL_HANDLER(DMA1_Channel5_IRQHandler);
+NULL_HANDLER(DMA1_Channel6_IRQHandler);
+NULL_HANDLER(DMA1_Channel7_IRQHandler);
+NULL_HANDLER(ADC1_2_IRQHandler);
+NULL_HANDLER(USB_HP_CAN1_TX_IRQHandler);
+NULL_HANDLER(USB_LP_CAN1_RX0_IRQHandler);
+NULL_HANDLER(CAN1_RX1_IRQHandler);
+NULL_HANDLER(CAN1_SCE_IRQHandler);
+NULL_HANDLER(EXTI9_5_IRQHandler);
+NULL_HANDLER(TIM1_BRK_IRQHandler);
+NULL_HANDLER(TIM1_UP_IRQHandler);
+NULL_HANDLER(TIM1_TRG_COM_IRQHandler);
+NULL_HANDLER(TIM1_CC_IRQHandler);
+NULL_HANDLER(TIM2_IRQHandler);
+NULL_HANDLER(TIM3_IRQHandler);
+NULL_HANDLER(TIM4_IRQHandler);
+NULL_HANDLER(I2C1_EV_IRQHandler);
+NULL_HANDLER(I2C1_ER_IRQHandler);
+NULL_HANDLER(I2C2_EV_IRQHandler);
+NULL_HANDLER(I2C2_ER_IRQHandler);
+NULL_HANDLER(SPI1_IRQHandler);
+NULL_HANDLER(SPI2_IRQHandler);
+NULL_HANDLER(USART1_IRQHandler);
+NULL_HANDLER(USART2_IRQHandler);
+NULL_HANDLER(USART3_IRQHandler);
+NULL_HANDLER(EXTI15_10_IRQHandler);
+NULL_HANDLER(RTCAlarm_IRQHandler);
+NULL_HANDLER(USBWakeUp_IRQHandler);
+
+// indexed by IRQn, the device interrupts of the medium density parts
+static const sim_handler_t vectors[] = {
+    WWDG_IRQHandler,
+    PVD_IRQHandler,
+    TAMPER_IRQHandler,
+    RTC_IRQHandler,
+    FLASH_IRQHandler,
+    RCC_IRQHandler,
+    EXTI0_IRQHandler,
+    EXTI1_IRQHandler,
+    EXTI2_IRQHandler,
+    EXTI3_IRQHandler,
+    EXTI4_IRQHandler,
+    DMA1_Channel1_IRQHandler,
+    DMA1_Channel2_IRQHandler,
+    DMA1_Channel3_IRQHandler,
+    DMA1_Channel4_IRQHandler,
+    DMA1_Channel5_IRQHandler,
+    DMA1_Channel6_IRQHandler,
+    DMA1_Channel7_IRQHandler,
+    ADC1_2_IRQHandler,
+    USB_HP_CAN1_TX_IRQHandler,
+    USB_LP_CAN1_RX0_IRQHandler,
+    CAN1_RX1_IRQHandler,
+    CAN1_SCE_IRQHandler,
+    EXTI9_5_IRQHandler,
+    TIM1_BRK_IRQHandler,
+    TIM1_UP_IRQHandler,
+    TIM1_TRG_COM_IRQHandler,
+    TIM1_CC_IRQHandler,
+    TIM2_IRQHandler,
+    TIM3_IRQHandler,
+    TIM4_IRQHandler,
+    I2C1_EV_IRQHandler,
+    I2C1_ER_IRQHandler,
+    I2C2_EV_IRQHandler,
+    I2C2_ER_IRQHandler,
+    SPI1_IRQHandler,
+    SPI2_IRQHandler,
+    USART1_IRQHandler,
+    USART2_IRQHandler,
+    USART3_IRQHandler,
+    EXTI15_10_IRQHandler,
+    RTCAlarm_IRQHandler,
+    USBWakeUp_IRQHandler,
+};
+
+sim_handler_t sim_vector(int irqn)
+{
+    if (SysTick_IRQn == irqn)
+        return SysTick_Handler;
+
+    if (irqn < 0 || irqn >= (int) (sizeof(vectors) / sizeof(vectors[0])))
+        return sim_null_handler;
+
+    return vectors[irqn];
+}
@@ -1,16 +1,29 @@
 #include "stm32f10x.h"
 #include "arm_isr_attr.h"
 #include "tiny_console/tiny_console.h"
+#include "kernel/kernel.h"
+#include "hal/usart/usart_stream.h"
 
 extern console_t* console;
+extern usart_stream_t console_stream;
 extern volatile uint8_t rcv_flag;
+extern ksem_t console_rx_sem;
 
 void ARM_IRQ USART1_IRQHandler(void)
 {
     if (USART_GetITStatus(USART1, USART_IT_RXNE)) {
         USART_ClearITPendingBit(USART1, USART_IT_RXNE);
-        console_input_char(console, (char) USART_ReceiveData(USART1));
+        char ch = (char) USART_ReceiveData(USART1);
+
+        // stdin gets a copy only while something reads it, otherwise its
+        // ring would fill with old console input
+        console_input_char(console, ch);
+        if (usart_stream_rx_waiting(&console_stream))
+            usart_stream_rx_push(&console_stream, ch);
         rcv_flag = 1;
+#if CONFIG_ENABLE_KERNEL == 1
+        ksem_give(&console_rx_sem);
+#endif
     }
 
     // asm volatile('')
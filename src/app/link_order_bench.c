@@ -0,0 +1,131 @@
+/*
+@file: link_order_bench.c
+@author: ZZH
+@date: 2026-10-19
+@info: a chain of small functions separated by large fillers in the
+       source, so the default link order spreads them over several flash
+       prefetch lines, the hot list pulls them together
+
+Build once with 'hot_order': false in the target and once without it and
+compare the cycles per round.
+*/
+
+#include <stdint.h>
+#include "linker_tools.h"
+#include "sys/timebase.h"
+#include "tiny_console/tiny_console.h"
+#include "tiny_console/tiny_console_cmd.h"
+
+#define BENCH_ROUNDS 10000
+
+#define BENCH_STEP  __attribute__((__noinline__))
+#define FILLER_CASE(n) \
+    case n:            \
+        sink = (n) * 0x9E3779B9U + x; break
+
+LINKER_SYMBOL32(__shot_text);
+LINKER_SYMBOL32(__ehot_text);
+
+static volatile uint32_t sink;
+
+// about half a kilobyte of code that the benchmark never runs
+#define FILLER(name)                                           \
+    static BENCH_STEP void name(uint32_t x)                    \
+    {                                                          \
+        switch (x & 31) {                                      \
+            FILLER_CASE(0); FILLER_CASE(1); FILLER_CASE(2);    \
+            FILLER_CASE(3); FILLER_CASE(4); FILLER_CASE(5);    \
+            FILLER_CASE(6); FILLER_CASE(7); FILLER_CASE(8);    \
+            FILLER_CASE(9); FILLER_CASE(10); FILLER_CASE(11);  \
+            FILLER_CASE(12); FILLER_CASE(13); FILLER_CASE(14); \
+            FILLER_CASE(15); FILLER_CASE(16); FILLER_CASE(17); \
+            FILLER_CASE(18); FILLER_CASE(19); FILLER_CASE(20); \
+            FILLER_CASE(21); FILLER_CASE(22); FILLER_CASE(23); \
+            FILLER_CASE(24); FILLER_CASE(25); FILLER_CASE(26); \
+            FILLER_CASE(27); FILLER_CASE(28); FILLER_CASE(29); \
+            FILLER_CASE(30); FILLER_CASE(31);                  \
+        }                                                      \
+    }
+
+BENCH_STEP uint32_t order_bench_step3(uint32_t x)
+{
+    return x ^ (x >> 7);
+}
+
+FILLER(order_bench_filler0)
+
+BENCH_STEP uint32_t order_bench_step2(uint32_t x)
+{
+    return order_bench_step3(x * 33 + 1);
+}
+
+FILLER(order_bench_filler1)
+
+BENCH_STEP uint32_t order_bench_step1(uint32_t x)
+{
+    return order_bench_step2(x + (x << 3));
+}
+
+FILLER(order_bench_filler2)
+
+BENCH_STEP uint32_t order_bench_step0(uint32_t x)
+{
+    return order_bench_step1(x ^ 0x5A5A5A5AU);
+}
+
+FILLER(order_bench_filler3)
+
+// keeps the fillers in the image
+static void (*const order_bench_fillers[])(uint32_t) = {
+    order_bench_filler0,
+    order_bench_filler1,
+    order_bench_filler2,
+    order_bench_filler3,
+};
+
+typedef uint32_t (*bench_step_t)(uint32_t x);
+
+static int in_hot_text(bench_step_t fn)
+{
+    // bit 0 of a thumb function pointer is set
+    uint32_t addr = (uint32_t) fn & ~1U;
+
+    return addr >= (uint32_t) __shot_text && addr < (uint32_t) __ehot_text;
+}
+
+CONSOLE_CMD_DEF(link_order_bench)
+{
+    uint32_t x = argc > 0 ? argv[0].unum : 1;
+
+    // never taken for the default seed
+    if (x >= 0x80000000U)
+        order_bench_fillers[x & 3](x);
+
+    uint32_t start = (uint32_t) timebase_get_cycles();
+
+    for (uint32_t i = 0; i < BENCH_ROUNDS; i++)
+        x = order_bench_step0(x);
+
+    uint32_t cycles = (uint32_t) timebase_get_cycles() - start;
+    sink = x;
+
+    const bench_step_t steps[] = {
+        order_bench_step0,
+        order_bench_step1,
+        order_bench_step2,
+        order_bench_step3,
+    };
+
+    for (uint32_t i = 0; i < 4; i++)
+        console_println(this, "step%lu at 0x%08lx%s", i, (uint32_t) steps[i],
+                        in_hot_text(steps[i]) ? " (hot)" : "");
+
+    console_println(this, "hot text %lu bytes, %lu.%02lu cycles per round",
+                    (uint32_t) __ehot_text - (uint32_t) __shot_text,
+                    cycles / BENCH_ROUNDS, cycles % BENCH_ROUNDS / 100);
+
+    return 0;
+}
+
+EXPORT_CONSOLE_CMD("orderbench", link_order_bench,
+                   "time a call chain placed by the hot list", "[u]");
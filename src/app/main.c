@@ -1,3 +1,4 @@
+#include <stdlib.h>
 #include <string.h>
 
 #include "stm32f10x.h"
@@ -10,18 +11,126 @@
 #include "delay/delay.h"
 #include "iterators.h"
 #include "tiny_console/tiny_console.h"
+#include "hal/clock/clock.h"
+#include "hal/clock/clock_tree.h"
+#include "hal/clock/sysclk.h"
+#include "hal/dma/dma.h"
+#include "hal/usart/usart_stream.h"
+#include "kernel/kernel.h"
+#include "sys/timebase.h"
+#include "sys/soft_timer.h"
+#include "sys/semihost.h"
+
+#ifndef CONFIG_CONSOLE_STACK_SIZE
+#define CONFIG_CONSOLE_STACK_SIZE 1024
+#endif
+
+#ifndef CONFIG_CONSOLE_TX_BUF_SIZE
+#define CONFIG_CONSOLE_TX_BUF_SIZE 512
+#endif
+
+#ifndef CONFIG_CONSOLE_RX_BUF_SIZE
+#define CONFIG_CONSOLE_RX_BUF_SIZE 64
+#endif
+
+#define CONSOLE_TASK_PRIO 8
+#define CONSOLE_BAUD      115200
 
 console_t* console = NULL;
 volatile uint8_t rcv_flag = 0;
 
+usart_stream_t console_stream;
+static uint8_t console_tx_buf[CONFIG_CONSOLE_TX_BUF_SIZE];
+static uint8_t console_rx_buf[CONFIG_CONSOLE_RX_BUF_SIZE];
+
+#if CONFIG_SEMIHOSTING == 1
+// the console does not hand the return value of a command back, so the
+// output is watched instead: a "failed [n/m]" line with n > 0 or an
+// "error=" makes the run exit with 1
+static uint8_t script_failed;
+static char script_line[96];
+static uint32_t script_line_len;
+
+static void script_check_line(void)
+{
+    const char* failed = strstr(script_line, "failed [");
+
+    if (NULL != failed && 0 != strtoul(failed + 8, NULL, 10))
+        script_failed = 1;
+
+    if (NULL != strstr(script_line, "error="))
+        script_failed = 1;
+}
+
+// the markers come early, the rest of a long line is not kept
+static void script_scan(const char* str, uint32_t len)
+{
+    for (uint32_t i = 0; i < len; i++) {
+        if ('\r' == str[i] || '\n' == str[i]) {
+            script_line[script_line_len] = '\0';
+            script_check_line();
+            script_line_len = 0;
+        } else if (script_line_len < sizeof(script_line) - 1) {
+            script_line[script_line_len++] = str[i];
+        }
+    }
+}
+
+// the QEMU image types the commands of its command line into the console,
+// ';' ends a command, and leaves once they have run
+static __attribute__((__noreturn__)) void console_run_script(void)
+{
+    static char cmdline[CONFIG_SEMIHOST_CMDLINE_SIZE];
+    int len = semihost_get_cmdline(cmdline, sizeof(cmdline));
+    int i = 0;
+
+    // the path of the image comes first
+    while (i < len && ' ' != cmdline[i])
+        i++;
+
+    for (i++; i < len; i++) {
+        console_input_char(console, ';' == cmdline[i] ? '\r' : cmdline[i]);
+        console_update(console);
+    }
+
+    console_input_char(console, '\r');
+    console_update(console);
+
+    semihost_exit(len < 0 || script_failed ? 1 : 0);
+}
+#endif
+
+#if CONFIG_ENABLE_KERNEL == 1
+ksem_t console_rx_sem;
+static task_t console_task;
+KERNEL_STACK_DEF(console_stack, CONFIG_CONSOLE_STACK_SIZE);
+
+static void console_task_entry(void* arg)
+{
+    (void) arg;
+
+#if CONFIG_SEMIHOSTING == 1
+    console_run_script();
+#endif
+
+    while (1) {
+        ksem_take(&console_rx_sem, KERNEL_WAIT_FOREVER);
+        console_update(console);
+    }
+}
+#endif
+
+// PCLK2 after clock_init, known without asking RCC_GetClocksFreq
+static uint32_t boot_pclk2 = HSI_VALUE;
+
 void clock_init(void)
 {
     RCC_DeInit();
+    // on failure the board keeps running from HSI, undivided
+    if (0 == clock_tree_apply())
+        boot_pclk2 = CLOCK_TREE_PCLK2_HZ;
 
-    RCC_APB2PeriphClockCmd(RCC_APB2Periph_USART1, ENABLE);
-    RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOA, ENABLE);
-    RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOB, ENABLE);
-    RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOC, ENABLE);
+    CLOCK_ENABLE(USART1, GPIOA, GPIOB, GPIOC);
 }
 
 void gpio_init(void)
@@ -54,21 +163,43 @@ void gpio_init(void)
     GPIO_Init(GPIOA, &init_param);
 }
 
-void usart_init(void)
+void usart_init(uint32_t pclk2)
 {
-    USART_InitTypeDef init_param = {
-        .USART_BaudRate = 115200,
-        .USART_HardwareFlowControl = USART_HardwareFlowControl_None,
-        .USART_Mode = USART_Mode_Tx | USART_Mode_Rx,
-        .USART_Parity = USART_Parity_No,
-        .USART_StopBits = USART_StopBits_1,
-        .USART_WordLength = USART_WordLength_8b,
-    };
+    // 8N1 without flow control, the interrupt enables are kept
+    USART1->CR1 = (USART1->CR1 & ~(USART_CR1_M | USART_CR1_PCE)) |
+                  USART_CR1_TE | USART_CR1_RE;
+    USART1->CR2 &= ~USART_CR2_STOP;
+    USART1->CR3 &= ~(USART_CR3_RTSE | USART_CR3_CTSE);
+    // 16x oversampling, mantissa and fraction together are pclk2 / baud
+    USART1->BRR = (pclk2 + CONSOLE_BAUD / 2) / CONSOLE_BAUD;
 
-    USART_Init(USART1, &init_param);
     USART_Cmd(USART1, ENABLE);
 }
 
+// BRR is derived from PCLK2, recompute it whenever the clock changes
+static int usart_clock_notify(sysclk_notifier_t* nb, sysclk_event_t event,
+                              const sysclk_freq_t* from,
+                              const sysclk_freq_t* to)
+{
+    (void) nb;
+    (void) from;
+
+    // let the last character leave at the old baud rate
+    if (SYSCLK_PRE_CHANGE == event) {
+        usart_stream_flush(&console_stream);
+        while (RESET == USART_GetFlagStatus(USART1, USART_FLAG_TC))
+            __asm volatile ("nop");
+    } else if (SYSCLK_POST_CHANGE == event) {
+        usart_init(to->pclk2);
+    }
+
+    return 0;
+}
+
+static sysclk_notifier_t usart_clock_nb = {
+    .notify = usart_clock_notify,
+};
+
 void nvic_init(void)
 {
     NVIC_SetPriorityGrouping(NVIC_PriorityGroup_4);
@@ -89,12 +220,13 @@ int console_output(console_t* this, const char* str, uint32_t len)
 {
     (void) this;
 
-    for (uint32_t i = 0; i < len; i++) {
-        while (RESET == USART_GetFlagStatus(USART1, USART_FLAG_TC))
-            ;
-        USART_ClearFlag(USART1, USART_FLAG_TC);
-        USART_SendData(USART1, str[i]);
-    }
+#if CONFIG_SEMIHOSTING == 1
+    semihost_write(str, len);
+    script_scan(str, len);
+#else
+    usart_stream_write(&console_stream, str, len);
+#endif
+
     return 0;
 }
 
@@ -102,8 +234,16 @@ int main(void)
 {
     clock_init();
     gpio_init();
-    usart_init();
+    usart_init(boot_pclk2);
+    sysclk_register_notifier(&usart_clock_nb);
     nvic_init();
+    timebase_init();
+
+    // printf and the console share the DMA driven stream
+    usart_stream_init(&console_stream, USART1, USART1_TX_DMA_CHAN,
+                      console_tx_buf, sizeof(console_tx_buf), console_rx_buf,
+                      sizeof(console_rx_buf));
+    usart_stream_set_stdio(&console_stream);
 
     // run_all_demo();
     // run_all_testcases(NULL);
@@ -112,11 +252,26 @@ int main(void)
     console_display_prefix(console);
     console_flush(console);
 
+#if CONFIG_ENABLE_KERNEL == 1
+    kernel_init();
+    ksem_init(&console_rx_sem, 0, 1);
+    task_create(&console_task, "console", console_task_entry, NULL,
+                CONSOLE_TASK_PRIO, console_stack, sizeof(console_stack));
+    soft_timer_service_start();
+    kernel_start();
+#endif
+
+#if CONFIG_SEMIHOSTING == 1
+    console_run_script();
+#endif
+
     while (1) {
         if (1 == rcv_flag) {
             rcv_flag = 0;
             console_update(console);
         }
+
+        soft_timer_run();
     }
 
     return 0;
@@ -2,84 +2,232 @@
 @file: clock.c
 @author: ZZH
 @date: 2024-05-06
-@info:
+@info: every peripheral below CRC sits on its own 1KiB slot of the bus
+       address space, the slot number indexes a table holding the enable
+       register and bit of the peripheral, the reference counts are kept
+       per enable bit
 */
 
+#include <stddef.h>
 #include "clock.h"
 #include "stm32f10x_rcc.h"
+#include "kernel/kernel.h"
+#include "tiny_console/tiny_console.h"
+#include "tiny_console/tiny_console_cmd.h"
 
-#define __CLOCK_HANDLER(per, bus, en)                           \
-    case per##_BASE:                                            \
-        RCC_##bus##PeriphClockCmd(RCC_##bus##Periph_##per, en); \
-        break
+#define CLOCK_BUS_AHB  1
+#define CLOCK_BUS_APB1 2
+#define CLOCK_BUS_APB2 3
+
+#define CLOCK_SLOT(base) (((base) - PERIPH_BASE) >> 10)
+#define CLOCK_SLOT_NUM   (CLOCK_SLOT(CRC_BASE) + 1)
+
+// bus in bits 5..6, enable bit number in bits 0..4, 0 for an empty slot
+#define CLOCK_ENTRY_BUS(entry) ((entry) >> 5)
+#define CLOCK_ENTRY_BIT(entry) ((entry) & 0x1F)
+
+#define CLOCK_PERIPH_LIST(X) \
+    X(DMA1, AHB)             \
+    X(DMA2, AHB)             \
+    X(USART1, APB2)          \
+    X(USART2, APB1)          \
+    X(USART3, APB1)          \
+    X(UART4, APB1)           \
+    X(UART5, APB1)           \
+    X(GPIOA, APB2)           \
+    X(GPIOB, APB2)           \
+    X(GPIOC, APB2)           \
+    X(GPIOD, APB2)           \
+    X(GPIOE, APB2)           \
+    X(GPIOF, APB2)           \
+    X(GPIOG, APB2)           \
+    X(ADC1, APB2)            \
+    X(ADC2, APB2)            \
+    X(ADC3, APB2)            \
+    X(TIM1, APB2)            \
+    X(TIM2, APB1)            \
+    X(TIM3, APB1)            \
+    X(TIM4, APB1)            \
+    X(TIM5, APB1)            \
+    X(TIM6, APB1)            \
+    X(TIM7, APB1)            \
+    X(TIM8, APB2)            \
+    X(TIM9, APB2)            \
+    X(TIM10, APB2)           \
+    X(TIM11, APB2)           \
+    X(TIM12, APB1)           \
+    X(TIM13, APB1)           \
+    X(TIM14, APB1)           \
+    X(TIM15, APB2)           \
+    X(TIM16, APB2)           \
+    X(TIM17, APB2)           \
+    X(SPI1, APB2)            \
+    X(SPI2, APB1)            \
+    X(SPI3, APB1)            \
+    X(I2C1, APB1)            \
+    X(I2C2, APB1)            \
+    X(CAN1, APB1)            \
+    X(CAN2, APB1)            \
+    X(CRC, AHB)              \
+    X(SDIO, AHB)             \
+    X(AFIO, APB2)            \
+    X(WWDG, APB1)            \
+    X(BKP, APB1)             \
+    X(PWR, APB1)             \
+    X(DAC, APB1)             \
+    X(CEC, APB1)
+
+#define __CLOCK_ENTRY(per, bus)                         \
+    [CLOCK_SLOT(per##_BASE)] = (CLOCK_BUS_##bus << 5) | \
+                               __builtin_ctz(RCC_##bus##Periph_##per),
+
+#define __CLOCK_NAME(per, bus) [CLOCK_SLOT(per##_BASE)] = #per,
+
+static const uint8_t clock_table[CLOCK_SLOT_NUM] = {
+    CLOCK_PERIPH_LIST(__CLOCK_ENTRY)
+};
+
+static const char* const clock_name[CLOCK_SLOT_NUM] = {
+    CLOCK_PERIPH_LIST(__CLOCK_NAME)
+};
+
+static volatile uint32_t* const clock_bus_reg[] = {
+    [CLOCK_BUS_AHB] = &RCC->AHBENR,
+    [CLOCK_BUS_APB1] = &RCC->APB1ENR,
+    [CLOCK_BUS_APB2] = &RCC->APB2ENR,
+};
+
+static const char* const clock_bus_name[] = {
+    [CLOCK_BUS_AHB] = "AHB",
+    [CLOCK_BUS_APB1] = "APB1",
+    [CLOCK_BUS_APB2] = "APB2",
+};
+
+static uint8_t clock_refs[CLOCK_BUS_APB2 + 1][32];
+
+static int clock_lookup(const void* reg)
+{
+    uint32_t base = (uint32_t) reg;
+
+    if (base < PERIPH_BASE || base >= PERIPH_BASE + (CLOCK_SLOT_NUM << 10))
+        return -EINVAL;
+
+    uint8_t entry = clock_table[CLOCK_SLOT(base)];
+
+    return 0 == entry ? -EINVAL : entry;
+}
+
+static void clock_apply(const uint32_t* mask, FunctionalState cmd)
+{
+    for (int bus = CLOCK_BUS_AHB; bus <= CLOCK_BUS_APB2; bus++) {
+        if (0 == mask[bus])
+            continue;
+
+        if (ENABLE == cmd)
+            *clock_bus_reg[bus] |= mask[bus];
+        else
+            *clock_bus_reg[bus] &= ~mask[bus];
+    }
+}
+
+static inline uint8_t* clock_ref(int entry)
+{
+    return &clock_refs[CLOCK_ENTRY_BUS(entry)][CLOCK_ENTRY_BIT(entry)];
+}
 
 int clock_cmd_for(void* reg, FunctionalState cmd)
 {
-    unsigned int __reg = (unsigned int) reg;
-    switch (__reg) {
-        __CLOCK_HANDLER(DMA1, AHB, cmd);
-        __CLOCK_HANDLER(DMA2, AHB, cmd);
-
-        __CLOCK_HANDLER(USART1, APB2, cmd);
-        __CLOCK_HANDLER(USART2, APB1, cmd);
-        __CLOCK_HANDLER(USART3, APB1, cmd);
-        __CLOCK_HANDLER(UART4, APB1, cmd);
-        __CLOCK_HANDLER(UART5, APB1, cmd);
-
-        __CLOCK_HANDLER(GPIOA, APB2, cmd);
-        __CLOCK_HANDLER(GPIOB, APB2, cmd);
-        __CLOCK_HANDLER(GPIOC, APB2, cmd);
-        __CLOCK_HANDLER(GPIOD, APB2, cmd);
-        __CLOCK_HANDLER(GPIOE, APB2, cmd);
-        __CLOCK_HANDLER(GPIOF, APB2, cmd);
-        __CLOCK_HANDLER(GPIOG, APB2, cmd);
-
-        __CLOCK_HANDLER(ADC1, APB2, cmd);
-        __CLOCK_HANDLER(ADC2, APB2, cmd);
-        __CLOCK_HANDLER(ADC3, APB2, cmd);
-
-        __CLOCK_HANDLER(TIM1, APB2, cmd);
-        __CLOCK_HANDLER(TIM2, APB1, cmd);
-        __CLOCK_HANDLER(TIM3, APB1, cmd);
-        __CLOCK_HANDLER(TIM4, APB1, cmd);
-        __CLOCK_HANDLER(TIM5, APB1, cmd);
-        __CLOCK_HANDLER(TIM6, APB1, cmd);
-        __CLOCK_HANDLER(TIM7, APB1, cmd);
-        __CLOCK_HANDLER(TIM8, APB2, cmd);
-        __CLOCK_HANDLER(TIM9, APB2, cmd);
-        __CLOCK_HANDLER(TIM10, APB2, cmd);
-        __CLOCK_HANDLER(TIM11, APB2, cmd);
-        __CLOCK_HANDLER(TIM12, APB1, cmd);
-        __CLOCK_HANDLER(TIM13, APB1, cmd);
-        __CLOCK_HANDLER(TIM14, APB1, cmd);
-        __CLOCK_HANDLER(TIM15, APB2, cmd);
-        __CLOCK_HANDLER(TIM16, APB2, cmd);
-        __CLOCK_HANDLER(TIM17, APB2, cmd);
-
-        __CLOCK_HANDLER(SPI1, APB2, cmd);
-        __CLOCK_HANDLER(SPI2, APB1, cmd);
-        __CLOCK_HANDLER(SPI3, APB1, cmd);
-
-        __CLOCK_HANDLER(I2C1, APB1, cmd);
-        __CLOCK_HANDLER(I2C2, APB1, cmd);
-
-        __CLOCK_HANDLER(CAN1, APB1, cmd);
-        __CLOCK_HANDLER(CAN2, APB1, cmd);
-
-        // __CLOCK_HANDLER(SRAM, AHB, cmd);
-        __CLOCK_HANDLER(CRC, AHB, cmd);
-        // __CLOCK_HANDLER(FSMC, AHB, cmd);
-        __CLOCK_HANDLER(SDIO, AHB, cmd);
-        __CLOCK_HANDLER(AFIO, APB2, cmd);
-        __CLOCK_HANDLER(WWDG, APB1, cmd);
-        // __CLOCK_HANDLER(USB, APB1, cmd);
-        __CLOCK_HANDLER(BKP, APB1, cmd);
-        __CLOCK_HANDLER(PWR, APB1, cmd);
-        __CLOCK_HANDLER(DAC, APB1, cmd);
-        __CLOCK_HANDLER(CEC, APB1, cmd);
-
-        default: return -EINVAL;
+    int entry = clock_lookup(reg);
+    if (entry < 0)
+        return entry;
+
+    uint32_t mask[CLOCK_BUS_APB2 + 1] = {0};
+    mask[CLOCK_ENTRY_BUS(entry)] = 1UL << CLOCK_ENTRY_BIT(entry);
+    clock_apply(mask, cmd);
+
+    return 0;
+}
+
+int clock_cmd_batch(void* const* regs, uint32_t num, FunctionalState cmd)
+{
+    if (NULL == regs)
+        return -EINVAL;
+
+    // nothing is counted unless every peripheral is known
+    for (uint32_t i = 0; i < num; i++) {
+        int entry = clock_lookup(regs[i]);
+        if (entry < 0)
+            return entry;
+    }
+
+    uint32_t mask[CLOCK_BUS_APB2 + 1] = {0};
+    uint32_t key = kernel_irq_save();
+
+    for (uint32_t i = 0; i < num; i++) {
+        uint8_t refs = *clock_ref(clock_lookup(regs[i]));
+
+        if ((ENABLE == cmd && UINT8_MAX == refs) ||
+            (DISABLE == cmd && 0 == refs)) {
+            kernel_irq_restore(key);
+            return ENABLE == cmd ? -EOVERFLOW : -EALREADY;
+        }
     }
 
+    // only the first user switches a clock on and the last one off
+    for (uint32_t i = 0; i < num; i++) {
+        int entry = clock_lookup(regs[i]);
+        uint8_t* refs = clock_ref(entry);
+
+        if ((ENABLE == cmd && 0 == (*refs)++) ||
+            (DISABLE == cmd && 0 == --(*refs)))
+            mask[CLOCK_ENTRY_BUS(entry)] |= 1UL << CLOCK_ENTRY_BIT(entry);
+    }
+
+    clock_apply(mask, cmd);
+    kernel_irq_restore(key);
+
     return 0;
 }
+
+int clock_ref_count(const void* reg)
+{
+    int entry = clock_lookup(reg);
+    if (entry < 0)
+        return entry;
+
+    return *clock_ref(entry);
+}
+
+CONSOLE_CMD_DEF(clocks_cmd)
+{
+    (void) argc;
+    (void) argv;
+
+    for (uint32_t slot = 0; slot < CLOCK_SLOT_NUM; slot++) {
+        uint8_t entry = clock_table[slot];
+        if (0 == entry)
+            continue;
+
+        uint32_t bus = CLOCK_ENTRY_BUS(entry);
+        uint32_t bit = CLOCK_ENTRY_BIT(entry);
+        uint32_t on = (*clock_bus_reg[bus] >> bit) & 1;
+        uint32_t refs = clock_refs[bus][bit];
+
+        if (0 == on && 0 == refs)
+            continue;
+
+        // untracked: switched on behind the counts, e.g. by clock_cmd_for
+        console_println(this, "%-7s %-4s refs %lu%s", clock_name[slot],
+                        clock_bus_name[bus], refs,
+                        0 == on ? " (off)" : 0 == refs ? " (untracked)" : "");
+    }
+
+    for (int bus = CLOCK_BUS_AHB; bus <= CLOCK_BUS_APB2; bus++)
+        console_println(this, "%-4s enr 0x%08lx", clock_bus_name[bus],
+                        *clock_bus_reg[bus]);
+
+    return 0;
+}
+
+EXPORT_CONSOLE_CMD("clocks", clocks_cmd, "show the active peripheral clocks",
+                   NULL);
@@ -11,16 +11,40 @@
 #include <errno.h>
 #include "stm32f10x.h"
 
+// writes the enable bit directly, the reference counts are not touched
 int clock_cmd_for(void* reg, FunctionalState cmd);
 
+/*
+ * take (ENABLE) or drop (DISABLE) one reference on every peripheral in the
+ * list, a clock is switched on by its first user and off by its last one
+ * with one read-modify-write per bus enable register for the whole list,
+ * -EALREADY if a clock without references is dropped
+ */
+int clock_cmd_batch(void* const* regs, uint32_t num, FunctionalState cmd);
+
 static inline int clock_enable_for(void* reg)
 {
-    return clock_cmd_for(reg, ENABLE);
+    return clock_cmd_batch(&reg, 1, ENABLE);
 }
 
 static inline int clock_disable_for(void* reg)
 {
-    return clock_cmd_for(reg, DISABLE);
+    return clock_cmd_batch(&reg, 1, DISABLE);
 }
 
+int clock_ref_count(const void* reg);
+
+// CLOCK_ENABLE(USART1, GPIOA, GPIOB)
+#define CLOCK_ENABLE(...)                                   \
+    clock_cmd_batch((void* const[]) {__VA_ARGS__},          \
+                    sizeof((void* const[]) {__VA_ARGS__}) / \
+                        sizeof(void*),                      \
+                    ENABLE)
+
+#define CLOCK_DISABLE(...)                                  \
+    clock_cmd_batch((void* const[]) {__VA_ARGS__},          \
+                    sizeof((void* const[]) {__VA_ARGS__}) / \
+                        sizeof(void*),                      \
+                    DISABLE)
+
 #endif // __CLOCK_H__
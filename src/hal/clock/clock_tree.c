@@ -0,0 +1,84 @@
+/*
+@file: clock_tree.c
+@author: ZZH
+@date: 2026-10-19
+@info: programs the clock tree found by tools/clock_solver.py, expects the
+       reset state left by RCC_DeInit
+*/
+
+#include "clock_tree.h"
+#include "arg_checkers.h"
+#include "stm32f10x.h"
+
+#ifndef CONFIG_CLOCK_TREE_READY_TIMEOUT
+#define CONFIG_CLOCK_TREE_READY_TIMEOUT 0x5000
+#endif
+
+#ifndef STM32F10X_CL
+
+#define CFGR_SETUP_MASK                                                  \
+    (RCC_CFGR_HPRE | RCC_CFGR_PPRE1 | RCC_CFGR_PPRE2 | RCC_CFGR_ADCPRE | \
+     RCC_CFGR_PLLSRC | RCC_CFGR_PLLXTPRE | RCC_CFGR_PLLMULL |            \
+     RCC_CFGR_USBPRE)
+
+static int wait_bits(volatile uint32_t* reg, uint32_t mask, uint32_t value)
+{
+    for (uint32_t i = 0; i < CONFIG_CLOCK_TREE_READY_TIMEOUT; i++) {
+        if ((*reg & mask) == value)
+            return 0;
+    }
+
+    return -ETIMEDOUT;
+}
+
+static int clock_tree_switch(void)
+{
+#if CLOCK_TREE_USE_HSE == 1
+    RCC->CR |= RCC_CR_HSEON;
+    RETURN_IF_NZERO(wait_bits(&RCC->CR, RCC_CR_HSERDY, RCC_CR_HSERDY), -EIO);
+#endif
+
+    // everything but SW while the core still runs from HSI
+    RCC->CFGR = (RCC->CFGR & ~CFGR_SETUP_MASK) |
+                (CLOCK_TREE_CFGR & CFGR_SETUP_MASK);
+
+#if CLOCK_TREE_USE_PLL == 1
+    RCC->CR |= RCC_CR_PLLON;
+    RETURN_IF_NZERO(wait_bits(&RCC->CR, RCC_CR_PLLRDY, RCC_CR_PLLRDY), -EIO);
+#endif
+
+    RCC->CFGR = (RCC->CFGR & ~RCC_CFGR_SW) | (CLOCK_TREE_CFGR & RCC_CFGR_SW);
+
+    // SWS reads back SW two bits up
+    return wait_bits(&RCC->CFGR, RCC_CFGR_SWS,
+                     (CLOCK_TREE_CFGR & RCC_CFGR_SW) << 2);
+}
+
+int clock_tree_apply(void)
+{
+    FLASH->ACR = (FLASH->ACR & ~FLASH_ACR_LATENCY) |
+                 CLOCK_TREE_FLASH_LATENCY | FLASH_ACR_PRFTBE;
+    (void) FLASH->ACR;
+
+    int ret = clock_tree_switch();
+
+    if (0 != ret) {
+        RCC->CFGR &= ~(RCC_CFGR_SW | CFGR_SETUP_MASK);
+        RCC->CR &= ~(RCC_CR_PLLON | RCC_CR_HSEON);
+        FLASH->ACR &= ~FLASH_ACR_LATENCY;
+    }
+
+    SystemCoreClockUpdate();
+
+    return ret;
+}
+
+#else
+
+// connectivity line parts have a different PLL
+int clock_tree_apply(void)
+{
+    return -ENOTSUP;
+}
+
+#endif
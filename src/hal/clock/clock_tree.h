@@ -0,0 +1,21 @@
+/*
+@file: clock_tree.h
+@author: ZZH
+@date: 2026-10-19
+@info: boot clock tree solved at configure time by tools/clock_solver.py
+
+The CLOCK_TREE_*_HZ constants describe the clocks after clock_tree_apply,
+drivers set up before any sysclk_set can use them instead of asking
+RCC_GetClocksFreq.
+*/
+
+#ifndef __CLOCK_TREE_H__
+#define __CLOCK_TREE_H__
+
+#include <errno.h>
+#include "clock_tree_config.h"
+
+// the core is left on HSI if the crystal or the PLL does not start
+int clock_tree_apply(void);
+
+#endif // __CLOCK_TREE_H__
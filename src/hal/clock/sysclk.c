@@ -0,0 +1,315 @@
+/*
+@file: sysclk.c
+@author: ZZH
+@date: 2026-10-19
+@info: the core always passes through HSI while the PLL is reprogrammed,
+       flash wait states go up before a speed-up and down after a slow-down
+*/
+
+#include <stddef.h>
+#include "sysclk.h"
+#include "arg_checkers.h"
+#include "stm32f10x.h"
+#include "stm32f10x_rcc.h"
+#include "stm32f10x_flash.h"
+#include "kernel/kernel.h"
+#include "tiny_console/tiny_console.h"
+#include "tiny_console/tiny_console_cmd.h"
+
+_Static_assert(HSE_VALUE == 8000000,
+               "the sysclk operating points assume an 8MHz HSE");
+
+#ifndef CONFIG_SYSCLK_READY_TIMEOUT
+#define CONFIG_SYSCLK_READY_TIMEOUT 0x5000
+#endif
+
+#define CFGR_PLL_MASK (RCC_CFGR_PLLSRC | RCC_CFGR_PLLXTPRE | RCC_CFGR_PLLMULL)
+#define CFGR_PRE_MASK (RCC_CFGR_HPRE | RCC_CFGR_PPRE1 | RCC_CFGR_PPRE2)
+// PPRE1 takes RCC_HCLK_DivX as is, PPRE2 always stays at /1
+#define CFGR_PPRE1(div) (div)
+
+typedef struct
+{
+    uint32_t hz;
+    // 0 for HSI without the PLL
+    uint32_t pll;
+    uint32_t pre;
+    uint32_t latency;
+} sysclk_opp_desc_t;
+
+// APB1 is limited to 36MHz, flash needs 1 wait state above 24MHz and 2
+// above 48MHz
+static const sysclk_opp_desc_t sysclk_opps[SYSCLK_OPP_NUM] = {
+    [SYSCLK_8MHZ] = {
+        .hz = 8000000,
+        .pll = 0,
+        .pre = 0,
+        .latency = FLASH_Latency_0,
+    },
+    [SYSCLK_24MHZ] = {
+        .hz = 24000000,
+        .pll = RCC_PLLSource_HSE_Div1 | RCC_PLLMul_3,
+        .pre = 0,
+        .latency = FLASH_Latency_0,
+    },
+    [SYSCLK_36MHZ] = {
+        .hz = 36000000,
+        .pll = RCC_PLLSource_HSE_Div2 | RCC_PLLMul_9,
+        .pre = 0,
+        .latency = FLASH_Latency_1,
+    },
+    [SYSCLK_48MHZ] = {
+        .hz = 48000000,
+        .pll = RCC_PLLSource_HSE_Div1 | RCC_PLLMul_6,
+        .pre = CFGR_PPRE1(RCC_HCLK_Div2),
+        .latency = FLASH_Latency_1,
+    },
+    [SYSCLK_72MHZ] = {
+        .hz = 72000000,
+        .pll = RCC_PLLSource_HSE_Div1 | RCC_PLLMul_9,
+        .pre = CFGR_PPRE1(RCC_HCLK_Div2),
+        .latency = FLASH_Latency_2,
+    },
+};
+
+static sysclk_notifier_t* notifier_head;
+
+int sysclk_register_notifier(sysclk_notifier_t* nb)
+{
+    CHECK_PTR(nb, -EINVAL);
+    CHECK_PTR(nb->notify, -EINVAL);
+
+    sysclk_notifier_t** link = &notifier_head;
+    while (NULL != *link) {
+        RETURN_IF(*link == nb, -EEXIST);
+        link = &(*link)->next;
+    }
+
+    nb->next = NULL;
+    *link = nb;
+
+    return 0;
+}
+
+int sysclk_unregister_notifier(sysclk_notifier_t* nb)
+{
+    CHECK_PTR(nb, -EINVAL);
+
+    for (sysclk_notifier_t** link = &notifier_head; NULL != *link;
+         link = &(*link)->next) {
+        if (*link == nb) {
+            *link = nb->next;
+            return 0;
+        }
+    }
+
+    return -ENOENT;
+}
+
+void sysclk_get_freq(sysclk_freq_t* freq)
+{
+    RCC_ClocksTypeDef clocks;
+
+    if (NULL == freq)
+        return;
+
+    RCC_GetClocksFreq(&clocks);
+    freq->sysclk = clocks.SYSCLK_Frequency;
+    freq->hclk = clocks.HCLK_Frequency;
+    freq->pclk1 = clocks.PCLK1_Frequency;
+    freq->pclk2 = clocks.PCLK2_Frequency;
+}
+
+static void sysclk_opp_freq(const sysclk_opp_desc_t* desc,
+                            sysclk_freq_t* freq)
+{
+    freq->sysclk = desc->hz;
+    freq->hclk = desc->hz;
+    freq->pclk1 = (desc->pre & RCC_CFGR_PPRE1) ? desc->hz / 2 : desc->hz;
+    freq->pclk2 = desc->hz;
+}
+
+int sysclk_get(void)
+{
+    sysclk_freq_t freq;
+
+    sysclk_get_freq(&freq);
+
+    for (int i = 0; i < SYSCLK_OPP_NUM; i++) {
+        sysclk_freq_t opp;
+
+        sysclk_opp_freq(&sysclk_opps[i], &opp);
+        if (opp.sysclk == freq.sysclk && opp.pclk1 == freq.pclk1 &&
+            opp.pclk2 == freq.pclk2)
+            return i;
+    }
+
+    return -ENOENT;
+}
+
+int sysclk_opp_from_mhz(uint32_t mhz)
+{
+    for (int i = 0; i < SYSCLK_OPP_NUM; i++) {
+        if (sysclk_opps[i].hz == mhz * 1000000)
+            return i;
+    }
+
+    return -EINVAL;
+}
+
+static int wait_bits(volatile uint32_t* reg, uint32_t mask, uint32_t value)
+{
+    for (uint32_t i = 0; i < CONFIG_SYSCLK_READY_TIMEOUT; i++) {
+        if ((*reg & mask) == value)
+            return 0;
+    }
+
+    return -ETIMEDOUT;
+}
+
+static void flash_set_latency(uint32_t latency)
+{
+    // prefetch stays on at every point, it may only be toggled at 8MHz
+    FLASH->ACR = (FLASH->ACR & ~FLASH_ACR_LATENCY) | latency |
+                 FLASH_ACR_PRFTBE;
+    (void) FLASH->ACR;
+}
+
+static int sysclk_to_hsi(void)
+{
+    RCC->CR |= RCC_CR_HSION;
+    RETURN_IF_NZERO(wait_bits(&RCC->CR, RCC_CR_HSIRDY, RCC_CR_HSIRDY),
+                    -ETIMEDOUT);
+
+    RCC->CFGR = (RCC->CFGR & ~(RCC_CFGR_SW | CFGR_PRE_MASK)) |
+                RCC_CFGR_SW_HSI;
+    RETURN_IF_NZERO(wait_bits(&RCC->CFGR, RCC_CFGR_SWS, RCC_CFGR_SWS_HSI),
+                    -ETIMEDOUT);
+
+    RCC->CR &= ~RCC_CR_PLLON;
+    return wait_bits(&RCC->CR, RCC_CR_PLLRDY, 0);
+}
+
+static int sysclk_to_pll(const sysclk_opp_desc_t* desc)
+{
+    RCC->CR |= RCC_CR_HSEON;
+    RETURN_IF_NZERO(wait_bits(&RCC->CR, RCC_CR_HSERDY, RCC_CR_HSERDY), -EIO);
+
+    RCC->CFGR = (RCC->CFGR & ~CFGR_PLL_MASK) | desc->pll;
+    RCC->CR |= RCC_CR_PLLON;
+    RETURN_IF_NZERO(wait_bits(&RCC->CR, RCC_CR_PLLRDY, RCC_CR_PLLRDY), -EIO);
+
+    // prescalers first, so APB1 never runs above 36MHz
+    RCC->CFGR = (RCC->CFGR & ~CFGR_PRE_MASK) | desc->pre;
+    RCC->CFGR = (RCC->CFGR & ~RCC_CFGR_SW) | RCC_CFGR_SW_PLL;
+
+    return wait_bits(&RCC->CFGR, RCC_CFGR_SWS, RCC_CFGR_SWS_PLL);
+}
+
+static int sysclk_switch(const sysclk_opp_desc_t* desc, uint32_t from_hz)
+{
+    if (desc->hz > from_hz)
+        flash_set_latency(desc->latency);
+
+    int ret = sysclk_to_hsi();
+
+    if (0 == ret) {
+        if (0 != desc->pll)
+            ret = sysclk_to_pll(desc);
+        else
+            RCC->CR &= ~RCC_CR_HSEON;
+    }
+
+    // after a failure the core is left on HSI, the slowest latency fits
+    if (0 == ret && desc->hz <= from_hz)
+        flash_set_latency(desc->latency);
+
+    SystemCoreClockUpdate();
+
+    return ret;
+}
+
+static void sysclk_notify_from(sysclk_notifier_t* stop, sysclk_event_t event,
+                               const sysclk_freq_t* from,
+                               const sysclk_freq_t* to)
+{
+    for (sysclk_notifier_t* nb = notifier_head; nb != stop; nb = nb->next)
+        nb->notify(nb, event, from, to);
+}
+
+int sysclk_set(sysclk_opp_t opp)
+{
+    RETURN_IF((uint32_t) opp >= SYSCLK_OPP_NUM, -EINVAL);
+    RETURN_IF(kernel_in_isr(), -EPERM);
+
+#ifdef STM32F10X_CL
+    // connectivity line parts have a different PLL
+    return -ENOTSUP;
+#endif
+
+    const sysclk_opp_desc_t* desc = &sysclk_opps[opp];
+    sysclk_freq_t from, to;
+
+    sysclk_get_freq(&from);
+    sysclk_opp_freq(desc, &to);
+
+    if (sysclk_get() == (int) opp)
+        return 0;
+
+    for (sysclk_notifier_t* nb = notifier_head; NULL != nb; nb = nb->next) {
+        int ret = nb->notify(nb, SYSCLK_PRE_CHANGE, &from, &to);
+
+        if (0 != ret) {
+            sysclk_notify_from(nb, SYSCLK_ABORT_CHANGE, &from, &to);
+            return ret;
+        }
+    }
+
+    // nothing may run from a clock that is being torn down
+    uint32_t key = kernel_irq_save();
+    int ret = sysclk_switch(desc, from.sysclk);
+    kernel_irq_restore(key);
+
+    if (0 != ret) {
+        // the old point is restored on a best effort basis
+        int back = sysclk_opp_from_mhz(from.sysclk / 1000000);
+        key = kernel_irq_save();
+        if (back >= 0)
+            sysclk_switch(&sysclk_opps[back], sysclk_opps[SYSCLK_8MHZ].hz);
+        kernel_irq_restore(key);
+
+        sysclk_notify_from(NULL, SYSCLK_ABORT_CHANGE, &from, &to);
+        return ret;
+    }
+
+    sysclk_notify_from(NULL, SYSCLK_POST_CHANGE, &from, &to);
+
+    return 0;
+}
+
+CONSOLE_CMD_DEF(sysclk_cmd)
+{
+    if (argc > 0) {
+        int opp = sysclk_opp_from_mhz(argv[0].unum);
+        if (opp < 0) {
+            console_println(this, "supported: 8 24 36 48 72");
+            return opp;
+        }
+
+        int ret = sysclk_set(opp);
+        if (0 != ret) {
+            console_println(this, "switch failed: %d", ret);
+            return ret;
+        }
+    }
+
+    sysclk_freq_t freq;
+    sysclk_get_freq(&freq);
+    console_println(this, "sysclk %lu, hclk %lu, pclk1 %lu, pclk2 %lu",
+                    freq.sysclk, freq.hclk, freq.pclk1, freq.pclk2);
+
+    return 0;
+}
+
+EXPORT_CONSOLE_CMD("sysclk", sysclk_cmd, "show or switch the system clock",
+                   "[u]");
@@ -0,0 +1,64 @@
+/*
+@file: sysclk.h
+@author: ZZH
+@date: 2026-10-19
+@info: runtime system clock switching between fixed operating points
+*/
+
+#ifndef __SYSCLK_H__
+#define __SYSCLK_H__
+
+#include <errno.h>
+#include <stdint.h>
+
+typedef enum {
+    SYSCLK_8MHZ = 0,
+    SYSCLK_24MHZ,
+    SYSCLK_36MHZ,
+    SYSCLK_48MHZ,
+    SYSCLK_72MHZ,
+    SYSCLK_OPP_NUM,
+} sysclk_opp_t;
+
+typedef enum {
+    // before anything is touched, a nonzero return vetoes the change
+    SYSCLK_PRE_CHANGE,
+    // the new clocks are running
+    SYSCLK_POST_CHANGE,
+    // a later notifier vetoed or the switch failed, the old clocks remain
+    SYSCLK_ABORT_CHANGE,
+} sysclk_event_t;
+
+typedef struct
+{
+    uint32_t sysclk;
+    uint32_t hclk;
+    uint32_t pclk1;
+    uint32_t pclk2;
+} sysclk_freq_t;
+
+typedef struct sysclk_notifier sysclk_notifier_t;
+
+typedef int (*sysclk_notify_t)(sysclk_notifier_t* nb, sysclk_event_t event,
+                               const sysclk_freq_t* from,
+                               const sysclk_freq_t* to);
+
+struct sysclk_notifier
+{
+    sysclk_notifier_t* next;
+    sysclk_notify_t notify;
+    void* arg;
+};
+
+// notifiers run in registration order, from thread context
+int sysclk_register_notifier(sysclk_notifier_t* nb);
+int sysclk_unregister_notifier(sysclk_notifier_t* nb);
+
+// 8MHz runs from HSI, every other point from the PLL fed by an 8MHz HSE
+int sysclk_set(sysclk_opp_t opp);
+// the current point, -ENOENT when the clocks were set up by other code
+int sysclk_get(void);
+void sysclk_get_freq(sysclk_freq_t* freq);
+int sysclk_opp_from_mhz(uint32_t mhz);
+
+#endif // __SYSCLK_H__
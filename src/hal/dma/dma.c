@@ -0,0 +1,308 @@
+/*
+@file: dma.c
+@author: ZZH
+@date: 2026-10-19
+@info: owns every DMA channel interrupt handler, drivers register a
+       callback through dma_claim instead of defining the handler
+*/
+
+#include <stddef.h>
+#include "dma.h"
+#include "dma_config_check.h"
+#include "arg_checkers.h"
+#include "arm_isr_attr.h"
+#include "hal/clock/clock.h"
+#include "kernel/kernel.h"
+#include "tiny_console/tiny_console.h"
+#include "tiny_console/tiny_console_cmd.h"
+
+#define DMA_FLAGS_ALL 0x0FU
+
+typedef struct
+{
+    DMA_Channel_TypeDef* chan;
+    DMA_TypeDef* dma;
+    IRQn_Type irq;
+    uint8_t shift;
+    const char* name;
+} dma_chan_dev_t;
+
+typedef struct
+{
+    const char* owner;
+    dma_cb_t cb;
+    void* ctx;
+} dma_chan_state_t;
+
+#define DMA_CHAN_DEF(ctrl, num, irqn)  \
+    {                                  \
+        .chan = ctrl##_Channel##num,   \
+        .dma = ctrl,                   \
+        .irq = irqn,                   \
+        .shift = ((num) - 1) * 4,      \
+        .name = #ctrl "_Channel" #num, \
+    }
+
+#ifdef STM32F10X_CL
+#define DMA2_CH4_IRQn DMA2_Channel4_IRQn
+#define DMA2_CH5_IRQn DMA2_Channel5_IRQn
+#else
+#define DMA2_CH4_IRQn DMA2_Channel4_5_IRQn
+#define DMA2_CH5_IRQn DMA2_Channel4_5_IRQn
+#endif
+
+enum {
+    DMA1_CH1,
+    DMA1_CH2,
+    DMA1_CH3,
+    DMA1_CH4,
+    DMA1_CH5,
+    DMA1_CH6,
+    DMA1_CH7,
+#ifdef DMA_HAS_DMA2
+    DMA2_CH1,
+    DMA2_CH2,
+    DMA2_CH3,
+    DMA2_CH4,
+    DMA2_CH5,
+#endif
+    DMA_CHAN_NUM,
+};
+
+static const dma_chan_dev_t dma_chan_dev[DMA_CHAN_NUM] = {
+    [DMA1_CH1] = DMA_CHAN_DEF(DMA1, 1, DMA1_Channel1_IRQn),
+    [DMA1_CH2] = DMA_CHAN_DEF(DMA1, 2, DMA1_Channel2_IRQn),
+    [DMA1_CH3] = DMA_CHAN_DEF(DMA1, 3, DMA1_Channel3_IRQn),
+    [DMA1_CH4] = DMA_CHAN_DEF(DMA1, 4, DMA1_Channel4_IRQn),
+    [DMA1_CH5] = DMA_CHAN_DEF(DMA1, 5, DMA1_Channel5_IRQn),
+    [DMA1_CH6] = DMA_CHAN_DEF(DMA1, 6, DMA1_Channel6_IRQn),
+    [DMA1_CH7] = DMA_CHAN_DEF(DMA1, 7, DMA1_Channel7_IRQn),
+#ifdef DMA_HAS_DMA2
+    [DMA2_CH1] = DMA_CHAN_DEF(DMA2, 1, DMA2_Channel1_IRQn),
+    [DMA2_CH2] = DMA_CHAN_DEF(DMA2, 2, DMA2_Channel2_IRQn),
+    [DMA2_CH3] = DMA_CHAN_DEF(DMA2, 3, DMA2_Channel3_IRQn),
+    [DMA2_CH4] = DMA_CHAN_DEF(DMA2, 4, DMA2_CH4_IRQn),
+    [DMA2_CH5] = DMA_CHAN_DEF(DMA2, 5, DMA2_CH5_IRQn),
+#endif
+};
+
+static dma_chan_state_t dma_chan_state[DMA_CHAN_NUM];
+
+static int dma_index(const DMA_Channel_TypeDef* chan)
+{
+    for (int i = 0; i < DMA_CHAN_NUM; i++) {
+        if (dma_chan_dev[i].chan == chan)
+            return i;
+    }
+
+    return -ENODEV;
+}
+
+static void dma_irq_config(const dma_chan_dev_t* dev, FunctionalState cmd)
+{
+    NVIC_InitTypeDef init_param = {
+        .NVIC_IRQChannel = dev->irq,
+        .NVIC_IRQChannelCmd = cmd,
+        .NVIC_IRQChannelPreemptionPriority = CONFIG_DMA_IRQ_PRIO,
+        .NVIC_IRQChannelSubPriority = 0,
+    };
+
+    NVIC_Init(&init_param);
+}
+
+// channel 4 and 5 of DMA2 share one interrupt on most parts
+static int dma_irq_in_use(IRQn_Type irq)
+{
+    for (int i = 0; i < DMA_CHAN_NUM; i++) {
+        if (dma_chan_dev[i].irq == irq && NULL != dma_chan_state[i].cb)
+            return 1;
+    }
+
+    return 0;
+}
+
+int dma_claim(DMA_Channel_TypeDef* chan, const char* owner, dma_cb_t cb,
+              void* ctx)
+{
+    CHECK_PTR(owner, -EINVAL);
+
+    int idx = dma_index(chan);
+    RETURN_IF(idx < 0, idx);
+
+    const dma_chan_dev_t* dev = &dma_chan_dev[idx];
+    dma_chan_state_t* st = &dma_chan_state[idx];
+
+    uint32_t key = kernel_irq_save();
+    if (NULL != st->owner) {
+        kernel_irq_restore(key);
+        return -EBUSY;
+    }
+    st->owner = owner;
+    st->cb = cb;
+    st->ctx = ctx;
+    kernel_irq_restore(key);
+
+    clock_enable_for(dev->dma);
+
+    dev->chan->CCR = 0;
+    dev->dma->IFCR = DMA_FLAGS_ALL << dev->shift;
+
+    if (NULL != cb)
+        dma_irq_config(dev, ENABLE);
+
+    return 0;
+}
+
+int dma_release(DMA_Channel_TypeDef* chan)
+{
+    int idx = dma_index(chan);
+    RETURN_IF(idx < 0, idx);
+
+    const dma_chan_dev_t* dev = &dma_chan_dev[idx];
+    dma_chan_state_t* st = &dma_chan_state[idx];
+
+    // the controller clock may already be gated for a free channel
+    RETURN_IF(NULL == st->owner, -EALREADY);
+
+    dev->chan->CCR = 0;
+    dev->dma->IFCR = DMA_FLAGS_ALL << dev->shift;
+
+    uint32_t key = kernel_irq_save();
+    st->owner = NULL;
+    st->cb = NULL;
+    st->ctx = NULL;
+    kernel_irq_restore(key);
+
+    if (!dma_irq_in_use(dev->irq))
+        dma_irq_config(dev, DISABLE);
+
+    // every claimed channel holds one reference on its controller clock
+    clock_disable_for(dev->dma);
+
+    return 0;
+}
+
+const char* dma_owner(DMA_Channel_TypeDef* chan)
+{
+    int idx = dma_index(chan);
+
+    return idx < 0 ? NULL : dma_chan_state[idx].owner;
+}
+
+int dma_flag_shift(DMA_Channel_TypeDef* chan)
+{
+    int idx = dma_index(chan);
+    RETURN_IF(idx < 0, idx);
+
+    return dma_chan_dev[idx].shift;
+}
+
+DMA_TypeDef* dma_controller(DMA_Channel_TypeDef* chan)
+{
+    int idx = dma_index(chan);
+
+    return idx < 0 ? NULL : dma_chan_dev[idx].dma;
+}
+
+static void dma_dispatch(int idx)
+{
+    const dma_chan_dev_t* dev = &dma_chan_dev[idx];
+    const dma_chan_state_t* st = &dma_chan_state[idx];
+
+    // only the events that were seen are cleared, a new one raised while
+    // the callback runs fires the interrupt again
+    uint32_t events = (dev->dma->ISR >> dev->shift) & DMA_FLAGS_ALL;
+    if (0 == events)
+        return;
+
+    dev->dma->IFCR = events << dev->shift;
+
+    if (NULL != st->cb)
+        st->cb(st->ctx, events & (DMA_EVT_TC | DMA_EVT_HT | DMA_EVT_TE));
+}
+
+void ARM_IRQ DMA1_Channel1_IRQHandler(void)
+{
+    dma_dispatch(DMA1_CH1);
+}
+
+void ARM_IRQ DMA1_Channel2_IRQHandler(void)
+{
+    dma_dispatch(DMA1_CH2);
+}
+
+void ARM_IRQ DMA1_Channel3_IRQHandler(void)
+{
+    dma_dispatch(DMA1_CH3);
+}
+
+void ARM_IRQ DMA1_Channel4_IRQHandler(void)
+{
+    dma_dispatch(DMA1_CH4);
+}
+
+void ARM_IRQ DMA1_Channel5_IRQHandler(void)
+{
+    dma_dispatch(DMA1_CH5);
+}
+
+void ARM_IRQ DMA1_Channel6_IRQHandler(void)
+{
+    dma_dispatch(DMA1_CH6);
+}
+
+void ARM_IRQ DMA1_Channel7_IRQHandler(void)
+{
+    dma_dispatch(DMA1_CH7);
+}
+
+#ifdef DMA_HAS_DMA2
+void ARM_IRQ DMA2_Channel1_IRQHandler(void)
+{
+    dma_dispatch(DMA2_CH1);
+}
+
+void ARM_IRQ DMA2_Channel2_IRQHandler(void)
+{
+    dma_dispatch(DMA2_CH2);
+}
+
+void ARM_IRQ DMA2_Channel3_IRQHandler(void)
+{
+    dma_dispatch(DMA2_CH3);
+}
+
+#ifdef STM32F10X_CL
+void ARM_IRQ DMA2_Channel4_IRQHandler(void)
+{
+    dma_dispatch(DMA2_CH4);
+}
+
+void ARM_IRQ DMA2_Channel5_IRQHandler(void)
+{
+    dma_dispatch(DMA2_CH5);
+}
+#else
+void ARM_IRQ DMA2_Channel4_5_IRQHandler(void)
+{
+    dma_dispatch(DMA2_CH4);
+    dma_dispatch(DMA2_CH5);
+}
+#endif
+#endif
+
+CONSOLE_CMD_DEF(dma_info)
+{
+    CONSOLE_CMD_UNUSE_ARGS;
+
+    for (int i = 0; i < DMA_CHAN_NUM; i++) {
+        const char* owner = dma_chan_state[i].owner;
+
+        console_println(this, "%s: %s", dma_chan_dev[i].name,
+                        NULL == owner ? "-" : owner);
+    }
+
+    return 0;
+}
+
+EXPORT_CONSOLE_CMD("dma", dma_info, "DMA channel owners", NULL);
@@ -0,0 +1,50 @@
+/*
+@file: dma.h
+@author: ZZH
+@date: 2026-10-19
+@info: DMA channel ownership and interrupt dispatch
+*/
+
+#ifndef __DMA_H__
+#define __DMA_H__
+
+#include <errno.h>
+#include <stdint.h>
+#include "stm32f10x_dma.h"
+#include "channel_mapping.h"
+
+#if defined(STM32F10X_HD) || defined(STM32F10X_HD_VL) || \
+    defined(STM32F10X_XL) || defined(STM32F10X_CL)
+#define DMA_HAS_DMA2 1
+#endif
+
+#ifndef CONFIG_DMA_IRQ_PRIO
+#define CONFIG_DMA_IRQ_PRIO 6
+#endif
+
+// channel events, same layout as one channel's nibble of DMA_ISR
+#define DMA_EVT_TC 0x02U
+#define DMA_EVT_HT 0x04U
+#define DMA_EVT_TE 0x08U
+
+// runs in interrupt context with the events that were pending
+typedef void (*dma_cb_t)(void* ctx, uint32_t events);
+
+/*
+ * claim the channel behind a request, e.g. dma_claim(SPI2_RX_DMA_CHAN, ...).
+ * a channel has a single owner, a second claim fails with -EBUSY until the
+ * first one is released. with cb != NULL the channel interrupt is enabled
+ * and every TC/HT/TE event the channel raises (enable them in CCR) is
+ * handed to cb.
+ */
+int dma_claim(DMA_Channel_TypeDef* chan, const char* owner, dma_cb_t cb,
+              void* ctx);
+int dma_release(DMA_Channel_TypeDef* chan);
+// NULL for a free channel
+const char* dma_owner(DMA_Channel_TypeDef* chan);
+
+// ISR/IFCR bit offset of the channel
+int dma_flag_shift(DMA_Channel_TypeDef* chan);
+DMA_TypeDef* dma_controller(DMA_Channel_TypeDef* chan);
+
+#endif // __DMA_H__
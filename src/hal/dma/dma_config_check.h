@@ -0,0 +1,87 @@
+/*
+@file: dma_config_check.h
+@author: ZZH
+@date: 2026-10-19
+@info: build time check of the DMA requests enabled in .config
+
+A driver that wants its request checked adds a line like DMA_SPI1_RX=1 to
+.config, two enabled requests that share a channel stop the build. Only the
+requests named here are known, the runtime check in dma_claim covers the
+rest.
+*/
+
+#ifndef __DMA_CONFIG_CHECK_H__
+#define __DMA_CONFIG_CHECK_H__
+
+#if (CONFIG_DMA_ADC1 + 0) + (CONFIG_DMA_TIM2_CH3 + 0) + \
+    (CONFIG_DMA_TIM4_CH1 + 0) > 1
+#error "DMA1 channel 1 is claimed by more than one DMA_* entry of .config"
+#endif
+
+#if (CONFIG_DMA_SPI1_RX + 0) + (CONFIG_DMA_USART3_TX + 0) + \
+    (CONFIG_DMA_TIM1_CH1 + 0) + (CONFIG_DMA_TIM2_UP + 0) +  \
+    (CONFIG_DMA_TIM3_CH3 + 0) > 1
+#error "DMA1 channel 2 is claimed by more than one DMA_* entry of .config"
+#endif
+
+#if (CONFIG_DMA_SPI1_TX + 0) + (CONFIG_DMA_USART3_RX + 0) + \
+    (CONFIG_DMA_TIM1_CH2 + 0) + (CONFIG_DMA_TIM3_CH4 + 0) + \
+    (CONFIG_DMA_TIM3_UP + 0) > 1
+#error "DMA1 channel 3 is claimed by more than one DMA_* entry of .config"
+#endif
+
+#if (CONFIG_DMA_SPI2_RX + 0) + (CONFIG_DMA_I2S2_RX + 0) +    \
+    (CONFIG_DMA_USART1_TX + 0) + (CONFIG_DMA_I2C2_TX + 0) +  \
+    (CONFIG_DMA_TIM1_CH4 + 0) + (CONFIG_DMA_TIM1_TRIG + 0) + \
+    (CONFIG_DMA_TIM1_COM + 0) + (CONFIG_DMA_TIM4_CH2 + 0) > 1
+#error "DMA1 channel 4 is claimed by more than one DMA_* entry of .config"
+#endif
+
+#if (CONFIG_DMA_SPI2_TX + 0) + (CONFIG_DMA_I2S2_TX + 0) +   \
+    (CONFIG_DMA_USART1_RX + 0) + (CONFIG_DMA_I2C2_RX + 0) + \
+    (CONFIG_DMA_TIM1_UP + 0) + (CONFIG_DMA_TIM2_CH1 + 0) +  \
+    (CONFIG_DMA_TIM4_CH3 + 0) > 1
+#error "DMA1 channel 5 is claimed by more than one DMA_* entry of .config"
+#endif
+
+#if (CONFIG_DMA_USART2_RX + 0) + (CONFIG_DMA_I2C1_TX + 0) + \
+    (CONFIG_DMA_TIM1_CH3 + 0) + (CONFIG_DMA_TIM3_CH1 + 0) + \
+    (CONFIG_DMA_TIM3_TRIG + 0) > 1
+#error "DMA1 channel 6 is claimed by more than one DMA_* entry of .config"
+#endif
+
+#if (CONFIG_DMA_USART2_TX + 0) + (CONFIG_DMA_I2C1_RX + 0) + \
+    (CONFIG_DMA_TIM2_CH2 + 0) + (CONFIG_DMA_TIM2_CH4 + 0) + \
+    (CONFIG_DMA_TIM4_UP + 0) > 1
+#error "DMA1 channel 7 is claimed by more than one DMA_* entry of .config"
+#endif
+
+#if (CONFIG_DMA_SPI3_RX + 0) + (CONFIG_DMA_I2S3_RX + 0) +    \
+    (CONFIG_DMA_TIM5_CH4 + 0) + (CONFIG_DMA_TIM5_TRIG + 0) + \
+    (CONFIG_DMA_TIM8_CH3 + 0) + (CONFIG_DMA_TIM8_UP + 0) > 1
+#error "DMA2 channel 1 is claimed by more than one DMA_* entry of .config"
+#endif
+
+#if (CONFIG_DMA_SPI3_TX + 0) + (CONFIG_DMA_I2S3_TX + 0) +    \
+    (CONFIG_DMA_TIM5_CH3 + 0) + (CONFIG_DMA_TIM5_UP + 0) +   \
+    (CONFIG_DMA_TIM8_CH4 + 0) + (CONFIG_DMA_TIM8_TRIG + 0) + \
+    (CONFIG_DMA_TIM8_COM + 0) > 1
+#error "DMA2 channel 2 is claimed by more than one DMA_* entry of .config"
+#endif
+
+#if (CONFIG_DMA_USART4_RX + 0) + (CONFIG_DMA_TIM6_UP + 0) + \
+    (CONFIG_DMA_DAC_CH1 + 0) + (CONFIG_DMA_TIM8_CH1 + 0) > 1
+#error "DMA2 channel 3 is claimed by more than one DMA_* entry of .config"
+#endif
+
+#if (CONFIG_DMA_SDIO + 0) + (CONFIG_DMA_TIM5_CH2 + 0) + \
+    (CONFIG_DMA_TIM7_UP + 0) + (CONFIG_DMA_DAC_CH2 + 0) > 1
+#error "DMA2 channel 4 is claimed by more than one DMA_* entry of .config"
+#endif
+
+#if (CONFIG_DMA_ADC3 + 0) + (CONFIG_DMA_USART4_TX + 0) + \
+    (CONFIG_DMA_TIM5_CH1 + 0) + (CONFIG_DMA_TIM8_CH2 + 0) > 1
+#error "DMA2 channel 5 is claimed by more than one DMA_* entry of .config"
+#endif
+
+#endif // __DMA_CONFIG_CHECK_H__
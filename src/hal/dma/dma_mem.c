@@ -0,0 +1,219 @@
+/*
+@file: dma_mem.c
+@author: ZZH
+@date: 2026-10-19
+@info: the source is programmed as the peripheral side, CNDTR counts items
+       of the widest size both addresses and the length allow and requests
+       longer than 65535 items are split into chunks from the interrupt
+*/
+
+#include <stddef.h>
+#include <string.h>
+#include "dma_mem.h"
+#include "dma.h"
+#include "arg_checkers.h"
+#include "iterators.h"
+#include "kernel/kernel.h"
+
+#define MAX_ITEMS 0xFFFF
+
+typedef struct
+{
+    DMA_Channel_TypeDef* chan;
+    volatile uint8_t busy;
+    uint8_t fill;
+    uint8_t width_shift;
+    uint32_t pattern;
+    uintptr_t dst;
+    uintptr_t src;
+    uint32_t left;
+    dma_mem_cb_t cb;
+    void* arg;
+} dma_mem_t;
+
+static dma_mem_t dma_mem;
+
+static DMA_Channel_TypeDef* const dma_mem_candidates[] = {
+    DMA1_Channel7, DMA1_Channel6, DMA1_Channel5, DMA1_Channel4,
+    DMA1_Channel3, DMA1_Channel2, DMA1_Channel1,
+};
+
+static const uint32_t dma_mem_width[] = {
+    DMA_PeripheralDataSize_Byte | DMA_MemoryDataSize_Byte,
+    DMA_PeripheralDataSize_HalfWord | DMA_MemoryDataSize_HalfWord,
+    DMA_PeripheralDataSize_Word | DMA_MemoryDataSize_Word,
+};
+
+static void dma_mem_event(void* ctx, uint32_t events);
+
+int dma_mem_init(void)
+{
+    if (NULL != dma_mem.chan)
+        return 0;
+
+    for (uint32_t i = 0; i < ARRAY_SIZE(dma_mem_candidates); i++) {
+        DMA_Channel_TypeDef* chan = dma_mem_candidates[i];
+
+        if (0 == dma_claim(chan, "mem", dma_mem_event, &dma_mem)) {
+            dma_mem.chan = chan;
+            return 0;
+        }
+    }
+
+    return -EBUSY;
+}
+
+int dma_mem_is_busy(void)
+{
+    return dma_mem.busy;
+}
+
+static uint8_t dma_mem_pick_width(uintptr_t dst, uintptr_t src, uint32_t len)
+{
+    uintptr_t bits = dst | src | len;
+
+    if (0 == (bits & 3))
+        return 2;
+
+    if (0 == (bits & 1))
+        return 1;
+
+    return 0;
+}
+
+static void dma_mem_kick(dma_mem_t* m)
+{
+    uint32_t items = m->left >> m->width_shift;
+    if (items > MAX_ITEMS)
+        items = MAX_ITEMS;
+
+    uint32_t ccr = DMA_M2M_Enable | DMA_Priority_Low |
+                   DMA_MemoryInc_Enable | dma_mem_width[m->width_shift] |
+                   DMA_CCR1_TCIE | DMA_CCR1_TEIE;
+    if (!m->fill)
+        ccr |= DMA_PeripheralInc_Enable;
+
+    m->chan->CCR = 0;
+    m->chan->CPAR = m->fill ? (uint32_t) &m->pattern : (uint32_t) m->src;
+    m->chan->CMAR = (uint32_t) m->dst;
+    m->chan->CNDTR = items;
+
+    uint32_t bytes = items << m->width_shift;
+    m->dst += bytes;
+    if (!m->fill)
+        m->src += bytes;
+    m->left -= bytes;
+
+    m->chan->CCR = ccr | DMA_CCR1_EN;
+}
+
+static int dma_mem_start(void* dst, const void* src, uint8_t value,
+                         uint32_t len, int fill, dma_mem_cb_t cb, void* arg)
+{
+    RETURN_IF(0 == len, -EINVAL);
+    RETURN_IF(NULL == dma_mem.chan, -ENODEV);
+
+    dma_mem_t* m = &dma_mem;
+
+    uint32_t key = kernel_irq_save();
+    if (m->busy) {
+        kernel_irq_restore(key);
+        return -EBUSY;
+    }
+    m->busy = 1;
+    kernel_irq_restore(key);
+
+    m->fill = fill;
+    m->dst = (uintptr_t) dst;
+    m->left = len;
+    m->cb = cb;
+    m->arg = arg;
+
+    if (fill) {
+        // the source never moves, so the pattern is as wide as the items
+        m->pattern = value * 0x01010101U;
+        m->src = 0;
+        m->width_shift = dma_mem_pick_width(m->dst, 0, len);
+    } else {
+        m->src = (uintptr_t) src;
+        m->width_shift = dma_mem_pick_width(m->dst, m->src, len);
+    }
+
+    dma_mem_kick(m);
+
+    return 0;
+}
+
+static void dma_mem_event(void* ctx, uint32_t events)
+{
+    dma_mem_t* m = (dma_mem_t*) ctx;
+    int status;
+
+    if (events & DMA_EVT_TE) {
+        status = -EIO;
+    } else if (events & DMA_EVT_TC) {
+        if (0 != m->left) {
+            dma_mem_kick(m);
+            return;
+        }
+
+        status = 0;
+    } else {
+        return;
+    }
+
+    m->chan->CCR = 0;
+
+    dma_mem_cb_t cb = m->cb;
+    void* arg = m->arg;
+    m->busy = 0;
+
+    if (NULL != cb)
+        cb(arg, status);
+}
+
+int dma_memcpy_async(void* dst, const void* src, uint32_t len,
+                     dma_mem_cb_t cb, void* arg)
+{
+    CHECK_PTR(dst, -EINVAL);
+    CHECK_PTR(src, -EINVAL);
+
+    if (len < CONFIG_DMA_MEM_THRESHOLD || NULL == dma_mem.chan) {
+        RETURN_IF(dma_mem.busy, -EBUSY);
+
+        memcpy(dst, src, len);
+        if (NULL != cb)
+            cb(arg, 0);
+
+        return 0;
+    }
+
+    return dma_mem_start(dst, src, 0, len, 0, cb, arg);
+}
+
+int dma_memset_async(void* dst, uint8_t value, uint32_t len, dma_mem_cb_t cb,
+                     void* arg)
+{
+    CHECK_PTR(dst, -EINVAL);
+
+    if (len < CONFIG_DMA_MEM_THRESHOLD || NULL == dma_mem.chan) {
+        RETURN_IF(dma_mem.busy, -EBUSY);
+
+        memset(dst, value, len);
+        if (NULL != cb)
+            cb(arg, 0);
+
+        return 0;
+    }
+
+    return dma_mem_start(dst, NULL, value, len, 1, cb, arg);
+}
+
+int dma_memcpy_start(void* dst, const void* src, uint32_t len,
+                     dma_mem_cb_t cb, void* arg)
+{
+    CHECK_PTR(dst, -EINVAL);
+    CHECK_PTR(src, -EINVAL);
+
+    return dma_mem_start(dst, src, 0, len, 0, cb, arg);
+}
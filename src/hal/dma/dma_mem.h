@@ -0,0 +1,46 @@
+/*
+@file: dma_mem.h
+@author: ZZH
+@date: 2026-10-19
+@info: asynchronous memcpy/memset on a DMA channel in memory to memory mode
+*/
+
+#ifndef __DMA_MEM_H__
+#define __DMA_MEM_H__
+
+#include <errno.h>
+#include <stdint.h>
+
+/*
+ * below this many bytes the CPU does the job. the LDM/STM memcpy of
+ * string_thumb.s moves 32 bytes in about 21 cycles from SRAM, starting the
+ * DMA and taking its completion interrupt costs the CPU roughly 150 cycles
+ * (counted from the code path), enough to copy about 230 bytes. this is an
+ * estimate, the dmabench command prints the crossover seen on the board
+ */
+#ifndef CONFIG_DMA_MEM_THRESHOLD
+#define CONFIG_DMA_MEM_THRESHOLD 256
+#endif
+
+// status is 0 or -EIO on a DMA transfer error
+typedef void (*dma_mem_cb_t)(void* arg, int status);
+
+// claim the first free DMA1 channel, starting from channel 7
+int dma_mem_init(void);
+
+/*
+ * return at once, cb runs from the DMA interrupt when the data is in place.
+ * short requests are done on the CPU and cb is called before returning.
+ * only one request can be in progress, another one fails with -EBUSY.
+ */
+int dma_memcpy_async(void* dst, const void* src, uint32_t len,
+                     dma_mem_cb_t cb, void* arg);
+int dma_memset_async(void* dst, uint8_t value, uint32_t len, dma_mem_cb_t cb,
+                     void* arg);
+int dma_mem_is_busy(void);
+
+// dma_memcpy_async without the CPU path, for benchmarking
+int dma_memcpy_start(void* dst, const void* src, uint32_t len,
+                     dma_mem_cb_t cb, void* arg);
+
+#endif // __DMA_MEM_H__
@@ -0,0 +1,87 @@
+/*
+@file: dma_mem_bench.c
+@author: ZZH
+@date: 2026-10-19
+@info: CPU memcpy against a DMA memory to memory copy, the DMA time covers
+       setup, transfer and completion interrupt, the way a caller sees it
+*/
+
+#include <string.h>
+#include "dma_mem.h"
+#include "sys/timebase.h"
+#include "tiny_console/tiny_console.h"
+#include "tiny_console/tiny_console_cmd.h"
+
+#define BENCH_MAX_LEN 1024
+
+static uint32_t bench_src[BENCH_MAX_LEN / 4];
+static uint32_t bench_dst[BENCH_MAX_LEN / 4];
+static volatile uint8_t bench_done;
+
+static void bench_cb(void* arg, int status)
+{
+    (void) arg;
+    (void) status;
+
+    bench_done = 1;
+}
+
+static uint32_t bench_cpu(uint32_t len)
+{
+    uint32_t start = (uint32_t) timebase_get_cycles();
+
+    memcpy(bench_dst, bench_src, len);
+
+    return (uint32_t) timebase_get_cycles() - start;
+}
+
+static uint32_t bench_dma(uint32_t len)
+{
+    bench_done = 0;
+
+    uint32_t start = (uint32_t) timebase_get_cycles();
+
+    if (0 != dma_memcpy_start(bench_dst, bench_src, len, bench_cb, NULL))
+        return UINT32_MAX;
+
+    while (!bench_done)
+        __asm volatile ("nop");
+
+    return (uint32_t) timebase_get_cycles() - start;
+}
+
+CONSOLE_CMD_DEF(dma_mem_bench)
+{
+    CONSOLE_CMD_UNUSE_ARGS;
+
+    if (0 != dma_mem_init()) {
+        console_println(this, "no free DMA channel");
+        return -EBUSY;
+    }
+
+    uint32_t crossover = 0;
+
+    console_println(this, "len: cpu/dma cycles");
+
+    for (uint32_t len = 8; len <= BENCH_MAX_LEN; len *= 2) {
+        uint32_t cpu = bench_cpu(len);
+        uint32_t dma = bench_dma(len);
+
+        console_println(this, "%lu: %lu/%lu", len, cpu, dma);
+
+        if (0 == crossover && dma < cpu)
+            crossover = len;
+    }
+
+    if (0 != crossover)
+        console_println(this, "dma wins from %lu bytes, threshold is %lu",
+                        crossover, (uint32_t) CONFIG_DMA_MEM_THRESHOLD);
+    else
+        console_println(this, "dma never wins up to %lu bytes",
+                        (uint32_t) BENCH_MAX_LEN);
+
+    return 0;
+}
+
+EXPORT_CONSOLE_CMD("dmabench", dma_mem_bench,
+                   "memcpy vs DMA memory to memory crossover", NULL);
@@ -0,0 +1,196 @@
+/*
+@file: dma_stream.c
+@author: ZZH
+@date: 2026-10-19
+@info: when the DMA moves into a half the consumer has not released yet,
+       that half is dropped and counted as an overrun, the consumer then
+       skips to the half that was completed last
+*/
+
+#include <stddef.h>
+#include "dma_stream.h"
+#include "arg_checkers.h"
+#include "kernel/kernel.h"
+
+static void dma_stream_half_done(dma_stream_t* s, uint8_t done)
+{
+    uint8_t entered = done ^ 1;
+
+    if (s->ready & (1U << entered)) {
+        s->ready &= ~(1U << entered);
+        s->overruns++;
+    }
+
+    s->seq[done] = s->produced++;
+    s->ready |= 1U << done;
+}
+
+static void dma_stream_event(void* ctx, uint32_t events)
+{
+    dma_stream_t* s = (dma_stream_t*) ctx;
+
+    if (events & DMA_EVT_TE) {
+        // the channel disables itself on a transfer error
+        s->errors++;
+        return;
+    }
+
+    // a late interrupt can report both, the first half finished earlier
+    if (events & DMA_EVT_HT)
+        dma_stream_half_done(s, 0);
+
+    if (events & DMA_EVT_TC)
+        dma_stream_half_done(s, 1);
+
+    if ((events & (DMA_EVT_HT | DMA_EVT_TC)) && NULL != s->cb)
+        s->cb(s, s->arg);
+}
+
+int dma_stream_init(dma_stream_t* stream, DMA_Channel_TypeDef* chan,
+                    const char* owner, volatile void* periph, void* buf,
+                    uint32_t items, uint8_t item_size, dma_stream_dir_t dir,
+                    dma_stream_cb_t cb, void* arg)
+{
+    CHECK_PTR(stream, -EINVAL);
+    CHECK_PTR(periph, -EINVAL);
+    CHECK_PTR(buf, -EINVAL);
+    RETURN_IF(0 == items || 0 != (items & 1) || items > 0xFFFF, -EINVAL);
+    RETURN_IF(1 != item_size && 2 != item_size && 4 != item_size, -EINVAL);
+
+    int ret = dma_claim(chan, owner, dma_stream_event, stream);
+    RETURN_IF_NZERO(ret, ret);
+
+    stream->chan = chan;
+    stream->buf = (uint8_t*) buf;
+    stream->half_items = items / 2;
+    stream->item_size = item_size;
+    stream->dir = dir;
+    stream->cb = cb;
+    stream->arg = arg;
+
+    uint32_t size;
+    switch (item_size) {
+        case 1:
+            size = DMA_PeripheralDataSize_Byte | DMA_MemoryDataSize_Byte;
+            break;
+        case 2:
+            size = DMA_PeripheralDataSize_HalfWord |
+                   DMA_MemoryDataSize_HalfWord;
+            break;
+        default:
+            size = DMA_PeripheralDataSize_Word | DMA_MemoryDataSize_Word;
+            break;
+    }
+
+    uint32_t ccr = size | DMA_Mode_Circular | DMA_MemoryInc_Enable |
+                   DMA_Priority_High | DMA_CCR1_HTIE | DMA_CCR1_TCIE |
+                   DMA_CCR1_TEIE;
+    if (DMA_STREAM_TO_PERIPH == dir)
+        ccr |= DMA_DIR_PeripheralDST;
+
+    chan->CPAR = (uint32_t) periph;
+    chan->CMAR = (uint32_t) buf;
+    chan->CNDTR = items;
+    chan->CCR = ccr;
+
+    return 0;
+}
+
+int dma_stream_start(dma_stream_t* stream)
+{
+    CHECK_PTR(stream, -EINVAL);
+    CHECK_PTR(stream->chan, -EINVAL);
+
+    dma_stream_stop(stream);
+
+    stream->chan->CNDTR = stream->half_items * 2;
+    stream->ready = 0;
+    stream->next = 0;
+    stream->produced = 0;
+    stream->overruns = 0;
+    stream->errors = 0;
+
+    stream->chan->CCR |= DMA_CCR1_EN;
+
+    return 0;
+}
+
+int dma_stream_stop(dma_stream_t* stream)
+{
+    CHECK_PTR(stream, -EINVAL);
+    CHECK_PTR(stream->chan, -EINVAL);
+
+    stream->chan->CCR &= ~DMA_CCR1_EN;
+
+    return 0;
+}
+
+int dma_stream_deinit(dma_stream_t* stream)
+{
+    CHECK_PTR(stream, -EINVAL);
+    CHECK_PTR(stream->chan, -EINVAL);
+
+    int ret = dma_release(stream->chan);
+    stream->chan = NULL;
+
+    return ret;
+}
+
+int dma_stream_acquire(dma_stream_t* stream, dma_stream_view_t* view)
+{
+    CHECK_PTR(stream, -EINVAL);
+    CHECK_PTR(view, -EINVAL);
+
+    uint32_t key = kernel_irq_save();
+
+    uint8_t ready = stream->ready;
+
+    // the expected half was dropped by an overrun
+    if (0 == (ready & (1U << stream->next)) && 0 != ready)
+        stream->next ^= 1;
+
+    uint8_t half = stream->next;
+    uint32_t seq = stream->seq[half];
+
+    kernel_irq_restore(key);
+
+    RETURN_IF(0 == (ready & (1U << half)), -EAGAIN);
+
+    view->ptr = stream->buf + half * stream->half_items * stream->item_size;
+    view->len = stream->half_items;
+    view->seq = seq;
+
+    return 0;
+}
+
+int dma_stream_release(dma_stream_t* stream, const dma_stream_view_t* view)
+{
+    CHECK_PTR(stream, -EINVAL);
+    CHECK_PTR(view, -EINVAL);
+
+    uint32_t half_size = stream->half_items * stream->item_size;
+    uint8_t half;
+
+    if (view->ptr == stream->buf)
+        half = 0;
+    else if (view->ptr == stream->buf + half_size)
+        half = 1;
+    else
+        return -EINVAL;
+
+    int ret = 0;
+    uint32_t key = kernel_irq_save();
+
+    // an overrun cleared the bit, or the half was filled again since
+    if ((stream->ready & (1U << half)) && stream->seq[half] == view->seq) {
+        stream->ready &= ~(1U << half);
+        stream->next = half ^ 1;
+    } else {
+        // a refilled half is left ready, acquire picks the newer data
+        ret = -EOVERFLOW;
+    }
+
+    kernel_irq_restore(key);
+
+    return ret;
+}
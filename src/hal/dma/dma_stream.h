@@ -0,0 +1,89 @@
+/*
+@file: dma_stream.h
+@author: ZZH
+@date: 2026-10-19
+@info: ping-pong streaming over a circular DMA buffer
+
+The buffer is split in two halves. The half-transfer and transfer-complete
+interrupts hand the half the DMA has just left to the consumer while the
+DMA works on the other one:
+
+    dma_stream_view_t view;
+    while (0 == dma_stream_acquire(&adc_stream, &view)) {
+        process(view.ptr, view.len);
+        // the DMA overwrote the half while it was processed
+        if (-EOVERFLOW == dma_stream_release(&adc_stream, &view))
+            discard(view.seq);
+    }
+
+For a peripheral to memory stream the view holds fresh data, for memory to
+peripheral it is the half to refill.
+*/
+
+#ifndef __DMA_STREAM_H__
+#define __DMA_STREAM_H__
+
+#include <errno.h>
+#include <stdint.h>
+#include "dma.h"
+
+typedef struct dma_stream dma_stream_t;
+
+// called from the DMA interrupt when a half becomes available
+typedef void (*dma_stream_cb_t)(dma_stream_t* stream, void* arg);
+
+typedef enum {
+    DMA_STREAM_FROM_PERIPH,
+    DMA_STREAM_TO_PERIPH,
+} dma_stream_dir_t;
+
+typedef struct
+{
+    void* ptr;
+    // in items
+    uint32_t len;
+    // number of the half since the stream was started
+    uint32_t seq;
+} dma_stream_view_t;
+
+struct dma_stream
+{
+    DMA_Channel_TypeDef* chan;
+    uint8_t* buf;
+    uint32_t half_items;
+    uint8_t item_size;
+    dma_stream_dir_t dir;
+    dma_stream_cb_t cb;
+    void* arg;
+
+    // bit n set: half n is waiting for or held by the consumer
+    volatile uint8_t ready;
+    uint8_t next;
+    volatile uint32_t produced;
+    uint32_t seq[2];
+    // halves the DMA wrapped into before the consumer released them
+    volatile uint32_t overruns;
+    volatile uint32_t errors;
+};
+
+/*
+ * buf holds items * item_size bytes, items must be even, item_size is 1, 2
+ * or 4 and sets both sides of the transfer. periph is the data register
+ * the channel's request comes from.
+ */
+int dma_stream_init(dma_stream_t* stream, DMA_Channel_TypeDef* chan,
+                    const char* owner, volatile void* periph, void* buf,
+                    uint32_t items, uint8_t item_size, dma_stream_dir_t dir,
+                    dma_stream_cb_t cb, void* arg);
+int dma_stream_start(dma_stream_t* stream);
+int dma_stream_stop(dma_stream_t* stream);
+int dma_stream_deinit(dma_stream_t* stream);
+
+// -EAGAIN when no half is available yet, the view stays valid until
+// dma_stream_release
+int dma_stream_acquire(dma_stream_t* stream, dma_stream_view_t* view);
+// -EOVERFLOW when the DMA moved into the half while it was held, whatever
+// was read from or written to it is not reliable
+int dma_stream_release(dma_stream_t* stream, const dma_stream_view_t* view);
+
+#endif // __DMA_STREAM_H__
@@ -0,0 +1,156 @@
+/*
+@file: i2c_async.c
+@author: ZZH
+@date: 2026-10-19
+@info: the StdLib event flow, with every I2C_CheckEvent poll turned into an
+       await point. the end of a read follows the BTF based sequences of
+       AN2824, a coroutine can resume too late to set NACK and STOP on RXNE
+*/
+
+#include <stddef.h>
+#include "i2c_async.h"
+#include "arg_checkers.h"
+#include "kernel/kernel.h"
+
+#define EVENT_TIMEOUT TIMEBASE_MS_TO_TICKS(CONFIG_I2C_ASYNC_TIMEOUT_MS)
+
+#define WAIT_EVENT(co, op, event) \
+    CO_WAIT_UNTIL_TIMEOUT(co, I2C_CheckEvent((op)->i2cx, event), EVENT_TIMEOUT)
+
+// reads SR1 only, so ADDR stays set until clear_addr
+#define WAIT_FLAG(co, op, flag)                                       \
+    CO_WAIT_UNTIL_TIMEOUT(co, I2C_GetFlagStatus((op)->i2cx, flag), \
+                          EVENT_TIMEOUT)
+
+static void clear_addr(I2C_TypeDef* i2cx)
+{
+    (void) i2cx->SR1;
+    (void) i2cx->SR2;
+}
+
+int i2c_async_init(i2c_async_t* op, I2C_TypeDef* i2cx, uint8_t addr,
+                   const void* wbuf, uint32_t wlen, void* rbuf, uint32_t rlen)
+{
+    CHECK_PTR(op, -EINVAL);
+    CHECK_PTR(i2cx, -EINVAL);
+    RETURN_IF(0 != wlen && NULL == wbuf, -EINVAL);
+    RETURN_IF(0 != rlen && NULL == rbuf, -EINVAL);
+    // there would be a STOP without a START
+    RETURN_IF(0 == wlen && 0 == rlen, -EINVAL);
+
+    co_init(&op->co);
+    op->i2cx = i2cx;
+    op->addr = addr;
+    op->wbuf = (const uint8_t*) wbuf;
+    op->wlen = wlen;
+    op->rbuf = (uint8_t*) rbuf;
+    op->rlen = rlen;
+    op->pos = 0;
+
+    return 0;
+}
+
+static int i2c_transaction(i2c_async_t* op)
+{
+    co_t* co = &op->co;
+    uint32_t key;
+
+    CO_BEGIN(co);
+
+    CO_WAIT_UNTIL_TIMEOUT(co, !I2C_GetFlagStatus(op->i2cx, I2C_FLAG_BUSY),
+                          EVENT_TIMEOUT);
+
+    if (0 != op->wlen) {
+        I2C_GenerateSTART(op->i2cx, ENABLE);
+        WAIT_EVENT(co, op, I2C_EVENT_MASTER_MODE_SELECT);
+
+        I2C_Send7bitAddress(op->i2cx, op->addr << 1, I2C_Direction_Transmitter);
+        WAIT_EVENT(co, op, I2C_EVENT_MASTER_TRANSMITTER_MODE_SELECTED);
+
+        for (op->pos = 0; op->pos < op->wlen; op->pos++) {
+            I2C_SendData(op->i2cx, op->wbuf[op->pos]);
+            WAIT_EVENT(co, op, I2C_EVENT_MASTER_BYTE_TRANSMITTED);
+        }
+    }
+
+    if (0 != op->rlen) {
+        I2C_AcknowledgeConfig(op->i2cx, ENABLE);
+        I2C_GenerateSTART(op->i2cx, ENABLE);
+        WAIT_EVENT(co, op, I2C_EVENT_MASTER_MODE_SELECT);
+
+        if (1 == op->rlen) {
+            // NACKed before ADDR is cleared
+            I2C_AcknowledgeConfig(op->i2cx, DISABLE);
+        } else if (2 == op->rlen) {
+            // POS moves the NACK to the second byte
+            I2C_NACKPositionConfig(op->i2cx, I2C_NACKPosition_Next);
+        }
+
+        I2C_Send7bitAddress(op->i2cx, op->addr << 1, I2C_Direction_Receiver);
+        WAIT_FLAG(co, op, I2C_FLAG_ADDR);
+
+        // nothing may come between clearing ADDR and the first byte's NACK
+        // or STOP, the bus is clocked on as soon as ADDR is cleared
+        key = kernel_irq_save();
+        clear_addr(op->i2cx);
+        if (1 == op->rlen)
+            I2C_GenerateSTOP(op->i2cx, ENABLE);
+        else if (2 == op->rlen)
+            I2C_AcknowledgeConfig(op->i2cx, DISABLE);
+        kernel_irq_restore(key);
+
+        // ACKed one by one while more than 3 bytes are left
+        for (op->pos = 0; op->pos + 3 < op->rlen; op->pos++) {
+            WAIT_FLAG(co, op, I2C_FLAG_RXNE);
+            op->rbuf[op->pos] = I2C_ReceiveData(op->i2cx);
+        }
+
+        if (op->rlen >= 3) {
+            // N-2 in DR and N-1 in the shift register, the clock is held
+            WAIT_FLAG(co, op, I2C_FLAG_BTF);
+            I2C_AcknowledgeConfig(op->i2cx, DISABLE);
+
+            key = kernel_irq_save();
+            op->rbuf[op->pos++] = I2C_ReceiveData(op->i2cx);
+            I2C_GenerateSTOP(op->i2cx, ENABLE);
+            op->rbuf[op->pos++] = I2C_ReceiveData(op->i2cx);
+            kernel_irq_restore(key);
+        } else if (2 == op->rlen) {
+            // both bytes in, the second one already NACKed
+            WAIT_FLAG(co, op, I2C_FLAG_BTF);
+
+            key = kernel_irq_save();
+            I2C_GenerateSTOP(op->i2cx, ENABLE);
+            op->rbuf[op->pos++] = I2C_ReceiveData(op->i2cx);
+            kernel_irq_restore(key);
+        }
+
+        WAIT_FLAG(co, op, I2C_FLAG_RXNE);
+        op->rbuf[op->pos] = I2C_ReceiveData(op->i2cx);
+    } else {
+        I2C_GenerateSTOP(op->i2cx, ENABLE);
+    }
+
+    // the next START is ignored while STOP is still pending
+    CO_WAIT_UNTIL_TIMEOUT(co, 0 == (op->i2cx->CR1 & I2C_CR1_STOP),
+                          EVENT_TIMEOUT);
+
+    I2C_NACKPositionConfig(op->i2cx, I2C_NACKPosition_Current);
+    I2C_AcknowledgeConfig(op->i2cx, ENABLE);
+
+    CO_END(co);
+}
+
+int i2c_async_transfer(i2c_async_t* op)
+{
+    int ret = i2c_transaction(op);
+
+    // release the bus after a timeout
+    if (ret < 0) {
+        I2C_GenerateSTOP(op->i2cx, ENABLE);
+        I2C_NACKPositionConfig(op->i2cx, I2C_NACKPosition_Current);
+        I2C_AcknowledgeConfig(op->i2cx, ENABLE);
+    }
+
+    return ret;
+}
@@ -0,0 +1,39 @@
+/*
+@file: i2c_async.h
+@author: ZZH
+@date: 2026-10-19
+@info: non-blocking i2c master transaction for coroutines
+*/
+
+#ifndef __I2C_ASYNC_H__
+#define __I2C_ASYNC_H__
+
+#include <stdint.h>
+#include "stm32f10x_i2c.h"
+#include "sys/coroutine.h"
+
+// per event timeout, a stuck bus ends the transaction with -ETIMEDOUT
+#ifndef CONFIG_I2C_ASYNC_TIMEOUT_MS
+#define CONFIG_I2C_ASYNC_TIMEOUT_MS 10
+#endif
+
+typedef struct
+{
+    co_t co;
+    I2C_TypeDef* i2cx;
+    // 7-bit address, not shifted
+    uint8_t addr;
+    const uint8_t* wbuf;
+    uint32_t wlen;
+    uint8_t* rbuf;
+    uint32_t rlen;
+    uint32_t pos;
+} i2c_async_t;
+
+// write wlen bytes then read rlen bytes after a repeated start, either
+// part can be empty but not both
+int i2c_async_init(i2c_async_t* op, I2C_TypeDef* i2cx, uint8_t addr,
+                   const void* wbuf, uint32_t wlen, void* rbuf, uint32_t rlen);
+int i2c_async_transfer(i2c_async_t* op);
+
+#endif // __I2C_ASYNC_H__
@@ -0,0 +1,67 @@
+/*
+@file: spi_async.c
+@author: ZZH
+@date: 2026-10-19
+@info: the frames move through spi_dma, the coroutine sleeps on an event
+       set by its completion callback instead of polling TXE and RXNE
+*/
+
+#include <stddef.h>
+#include "spi_async.h"
+#include "arg_checkers.h"
+
+int spi_async_init(spi_async_t* op, SPI_TypeDef* spix, const void* tx,
+                   void* rx, uint32_t len)
+{
+    CHECK_PTR(op, -EINVAL);
+    CHECK_PTR(spix, -EINVAL);
+    RETURN_IF(len > 0xFFFF, -EINVAL);
+
+    int ret = spi_dma_init(spix);
+    RETURN_IF_NZERO(ret, ret);
+
+    co_init(&op->co);
+    op->spix = spix;
+    op->tx = tx;
+    op->rx = rx;
+    op->len = len;
+    co_event_clear(&op->done);
+    op->status = 0;
+
+    return 0;
+}
+
+static void spi_async_done(void* arg, int status)
+{
+    spi_async_t* op = (spi_async_t*) arg;
+
+    op->status = status;
+    co_event_signal(&op->done);
+}
+
+int spi_async_transfer(spi_async_t* op)
+{
+    co_t* co = &op->co;
+    int ret;
+
+    CO_BEGIN(co);
+
+    if (0 == op->len)
+        CO_RETURN(co, CO_DONE);
+
+    co_event_clear(&op->done);
+
+    // another user of the bus may still own the channels
+    CO_WAIT_UNTIL(co, -EBUSY != (ret = spi_dma_transfer(op->spix, op->tx,
+                                                        op->rx, op->len,
+                                                        spi_async_done, op)));
+    if (ret < 0)
+        CO_RETURN(co, ret);
+
+    CO_WAIT_EVENT(co, &op->done);
+
+    if (op->status < 0)
+        CO_RETURN(co, op->status);
+
+    CO_END(co);
+}
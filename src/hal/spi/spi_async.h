@@ -0,0 +1,37 @@
+/*
+@file: spi_async.h
+@author: ZZH
+@date: 2026-10-19
+@info: non-blocking spi transfer for coroutines
+*/
+
+#ifndef __SPI_ASYNC_H__
+#define __SPI_ASYNC_H__
+
+#include <stdint.h>
+#include "stm32f10x_spi.h"
+#include "sys/coroutine.h"
+#include "spi_dma.h"
+
+#define SPI_ASYNC_DUMMY CONFIG_SPI_DMA_DUMMY
+
+typedef struct
+{
+    co_t co;
+    SPI_TypeDef* spix;
+    // uint8_t or uint16_t frames depending on the DFF bit of the bus
+    const void* tx;
+    void* rx;
+    uint32_t len;
+    // set by the DMA completion, status is its result
+    co_event_t done;
+    int status;
+} spi_async_t;
+
+// tx == NULL sends SPI_ASYNC_DUMMY, rx == NULL drops the received frames.
+// claims the DMA channels of the bus, len is at most 0xFFFF frames
+int spi_async_init(spi_async_t* op, SPI_TypeDef* spix, const void* tx,
+                   void* rx, uint32_t len);
+int spi_async_transfer(spi_async_t* op);
+
+#endif // __SPI_ASYNC_H__
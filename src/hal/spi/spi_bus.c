@@ -0,0 +1,195 @@
+/*
+@file: spi_bus.c
+@author: ZZH
+@date: 2026-10-19
+@info: transactions run back to back, the next one is started from the
+       completion interrupt of the previous one
+*/
+
+#include <stddef.h>
+#include "spi_bus.h"
+#include "spi_dma.h"
+#include "arg_checkers.h"
+#include "hal/clock/clock.h"
+#include "kernel/kernel.h"
+
+#define SPI_CR1_MODE_MASK (SPI_CR1_CPOL | SPI_CR1_CPHA)
+
+static void spi_bus_start(spi_bus_t* bus);
+
+static inline void cs_assert(const spi_dev_t* dev)
+{
+    if (NULL != dev->cs_port)
+        dev->cs_port->BRR = dev->cs_pin;
+}
+
+static inline void cs_release(const spi_dev_t* dev)
+{
+    if (NULL != dev->cs_port)
+        dev->cs_port->BSRR = dev->cs_pin;
+}
+
+// a clock change in the middle of a transaction would change SCK under it
+static int spi_bus_clock_notify(sysclk_notifier_t* nb, sysclk_event_t event,
+                                const sysclk_freq_t* from,
+                                const sysclk_freq_t* to)
+{
+    spi_bus_t* bus = (spi_bus_t*) nb->arg;
+
+    (void) from;
+    (void) to;
+
+    if (SYSCLK_PRE_CHANGE == event && NULL != bus->head)
+        return -EBUSY;
+
+    return 0;
+}
+
+int spi_bus_init(spi_bus_t* bus, SPI_TypeDef* spix)
+{
+    CHECK_PTR(bus, -EINVAL);
+    CHECK_PTR(spix, -EINVAL);
+
+    // the spi clock is only held while transactions are queued
+    RETURN_IF_NZERO(spi_dma_init(spix), -ENODEV);
+
+    bus->spix = spix;
+    bus->head = NULL;
+    bus->tail = NULL;
+    bus->active = NULL;
+    bus->in_cmd = 0;
+
+    bus->clock_nb.notify = spi_bus_clock_notify;
+    bus->clock_nb.arg = bus;
+
+    return sysclk_register_notifier(&bus->clock_nb);
+}
+
+int spi_dev_init(spi_dev_t* dev, GPIO_TypeDef* cs_port, uint16_t cs_pin,
+                 uint8_t mode, uint16_t prescaler, int word16)
+{
+    CHECK_PTR(dev, -EINVAL);
+    RETURN_IF(mode > 3, -EINVAL);
+    RETURN_IF(!IS_SPI_BAUDRATE_PRESCALER(prescaler), -EINVAL);
+
+    // CPHA is bit 0 and CPOL bit 1, just like the mode number
+    dev->cr1 = SPI_CR1_MSTR | SPI_CR1_SSM | SPI_CR1_SSI | prescaler |
+               (mode & SPI_CR1_MODE_MASK);
+    if (word16)
+        dev->cr1 |= SPI_CR1_DFF;
+
+    dev->cs_port = cs_port;
+    dev->cs_pin = cs_pin;
+
+    if (NULL != cs_port) {
+        GPIO_InitTypeDef init_param = {
+            .GPIO_Pin = cs_pin,
+            .GPIO_Mode = GPIO_Mode_Out_PP,
+            .GPIO_Speed = GPIO_Speed_50MHz,
+        };
+
+        clock_enable_for(cs_port);
+        cs_release(dev);
+        GPIO_Init(cs_port, &init_param);
+    }
+
+    return 0;
+}
+
+static void spi_bus_finish(spi_bus_t* bus, int status)
+{
+    spi_xfer_t* xfer = bus->head;
+
+    cs_release(xfer->dev);
+
+    bus->head = xfer->next;
+    if (NULL == bus->head) {
+        bus->tail = NULL;
+        // registers keep their contents with the clock gated
+        clock_disable_for(bus->spix);
+    } else {
+        spi_bus_start(bus);
+    }
+
+    // the next transaction is already on the wire
+    xfer->status = status;
+    if (NULL != xfer->cb)
+        xfer->cb(xfer, status);
+}
+
+static void spi_bus_dma_done(void* arg, int status)
+{
+    spi_bus_t* bus = (spi_bus_t*) arg;
+    spi_xfer_t* xfer = bus->head;
+
+    if (0 == status && bus->in_cmd && 0 != xfer->len) {
+        bus->in_cmd = 0;
+        status = spi_dma_transfer(bus->spix, xfer->tx, xfer->rx, xfer->len,
+                                  spi_bus_dma_done, bus);
+        if (0 == status)
+            return;
+    }
+
+    spi_bus_finish(bus, status);
+}
+
+static void spi_bus_apply(spi_bus_t* bus, const spi_dev_t* dev)
+{
+    if (bus->active == dev)
+        return;
+
+    // CPOL/CPHA and BR may only change while the peripheral is disabled,
+    // the bus is idle here so BSY is already clear
+    bus->spix->CR1 = dev->cr1;
+    bus->spix->CR1 = dev->cr1 | SPI_CR1_SPE;
+    bus->active = dev;
+}
+
+// called with the head set and either from the DMA isr or with irqs off
+static void spi_bus_start(spi_bus_t* bus)
+{
+    spi_xfer_t* xfer = bus->head;
+    int ret;
+
+    spi_bus_apply(bus, xfer->dev);
+    cs_assert(xfer->dev);
+
+    bus->in_cmd = 0 != xfer->cmd_len;
+    if (bus->in_cmd)
+        ret = spi_dma_transfer(bus->spix, xfer->cmd, NULL, xfer->cmd_len,
+                               spi_bus_dma_done, bus);
+    else
+        ret = spi_dma_transfer(bus->spix, xfer->tx, xfer->rx, xfer->len,
+                               spi_bus_dma_done, bus);
+
+    if (0 != ret)
+        spi_bus_finish(bus, ret);
+}
+
+int spi_bus_submit(spi_bus_t* bus, spi_xfer_t* xfer)
+{
+    CHECK_PTR(bus, -EINVAL);
+    CHECK_PTR(xfer, -EINVAL);
+    CHECK_PTR(xfer->dev, -EINVAL);
+    RETURN_IF(0 == xfer->cmd_len && 0 == xfer->len, -EINVAL);
+    RETURN_IF(0 != xfer->cmd_len && NULL == xfer->cmd, -EINVAL);
+
+    xfer->next = NULL;
+    xfer->status = -EINPROGRESS;
+
+    uint32_t key = kernel_irq_save();
+
+    if (NULL == bus->head) {
+        bus->head = xfer;
+        bus->tail = xfer;
+        clock_enable_for(bus->spix);
+        spi_bus_start(bus);
+    } else {
+        bus->tail->next = xfer;
+        bus->tail = xfer;
+    }
+
+    kernel_irq_restore(key);
+
+    return 0;
+}
@@ -0,0 +1,78 @@
+/*
+@file: spi_bus.h
+@author: ZZH
+@date: 2026-10-19
+@info: shared spi bus with per-device settings and a transaction queue
+*/
+
+#ifndef __SPI_BUS_H__
+#define __SPI_BUS_H__
+
+#include <errno.h>
+#include <stdint.h>
+#include "stm32f10x_gpio.h"
+#include "stm32f10x_spi.h"
+#include "hal/clock/sysclk.h"
+
+typedef struct
+{
+    // NULL for a device without chip select
+    GPIO_TypeDef* cs_port;
+    uint16_t cs_pin;
+    // CR1 image without SPE, built by spi_dev_init
+    uint16_t cr1;
+} spi_dev_t;
+
+typedef struct spi_xfer spi_xfer_t;
+typedef void (*spi_xfer_cb_t)(spi_xfer_t* xfer, int status);
+
+struct spi_xfer
+{
+    spi_xfer_t* next;
+    const spi_dev_t* dev;
+    // sent first with the received frames dropped, cmd_len can be 0
+    const void* cmd;
+    uint32_t cmd_len;
+    // data phase, same rules as spi_dma_transfer, len can be 0
+    const void* tx;
+    void* rx;
+    uint32_t len;
+    // called from the DMA interrupt, may submit again
+    spi_xfer_cb_t cb;
+    void* arg;
+    // -EINPROGRESS while queued, then 0 or a negative errno
+    volatile int status;
+};
+
+typedef struct
+{
+    SPI_TypeDef* spix;
+    spi_xfer_t* head;
+    spi_xfer_t* tail;
+    const spi_dev_t* active;
+    uint8_t in_cmd;
+    sysclk_notifier_t clock_nb;
+} spi_bus_t;
+
+// the SCK/MISO/MOSI pins are left to the board code
+int spi_bus_init(spi_bus_t* bus, SPI_TypeDef* spix);
+
+/*
+ * mode is 0..3 (CPOL << 1 | CPHA), prescaler is one of
+ * SPI_BaudRatePrescaler_x (relative to PCLK, so the SCK rate follows
+ * sysclk_set) and word16 selects 16-bit frames, the cs pin is configured
+ * as a push-pull output and deasserted
+ */
+int spi_dev_init(spi_dev_t* dev, GPIO_TypeDef* cs_port, uint16_t cs_pin,
+                 uint8_t mode, uint16_t prescaler, int word16);
+
+// fill in xfer, queue it and return at once, the transfer starts when the
+// transactions queued before it are done
+int spi_bus_submit(spi_bus_t* bus, spi_xfer_t* xfer);
+
+static inline int spi_xfer_done(const spi_xfer_t* xfer)
+{
+    return -EINPROGRESS != xfer->status;
+}
+
+#endif // __SPI_BUS_H__
@@ -0,0 +1,221 @@
+/*
+@file: spi_dma.c
+@author: ZZH
+@date: 2026-10-19
+@info: the rx channel always runs, even for tx-only transfers, so that its
+       transfer complete interrupt marks the end of the last frame on the
+       wire and no BSY polling is needed
+*/
+
+#include <stddef.h>
+#include "spi_dma.h"
+#include "arg_checkers.h"
+#include "hal/dma/dma.h"
+#include "kernel/kernel.h"
+
+// ISR/IFCR hold 4 flags per channel: GIF, TCIF, HTIF, TEIF
+#define DMA_FLAG_SHIFT(chan_num) (((chan_num) - 1) * 4)
+#define DMA_FLAGS_ALL            0x0FU
+
+typedef struct
+{
+    SPI_TypeDef* spi;
+    DMA_TypeDef* dma;
+    DMA_Channel_TypeDef* rx_chan;
+    DMA_Channel_TypeDef* tx_chan;
+    const char* name;
+    uint8_t rx_shift;
+    uint8_t tx_shift;
+} spi_dma_dev_t;
+
+typedef struct
+{
+    const spi_dma_dev_t* dev;
+    volatile uint8_t busy;
+    spi_dma_cb_t cb;
+    void* arg;
+    // received frames of a tx-only transfer end up here
+    uint16_t sink;
+} spi_dma_state_t;
+
+enum {
+    SPI_DMA_SPI1,
+    SPI_DMA_SPI2,
+#ifdef DMA_HAS_DMA2
+    SPI_DMA_SPI3,
+#endif
+    SPI_DMA_NUM,
+};
+
+static const spi_dma_dev_t spi_dma_dev[SPI_DMA_NUM] = {
+    [SPI_DMA_SPI1] = {
+        .spi = SPI1,
+        .dma = DMA1,
+        .rx_chan = SPI1_RX_DMA_CHAN,
+        .tx_chan = SPI1_TX_DMA_CHAN,
+        .name = "spi1",
+        .rx_shift = DMA_FLAG_SHIFT(2),
+        .tx_shift = DMA_FLAG_SHIFT(3),
+    },
+    [SPI_DMA_SPI2] = {
+        .spi = SPI2,
+        .dma = DMA1,
+        .rx_chan = SPI2_RX_DMA_CHAN,
+        .tx_chan = SPI2_TX_DMA_CHAN,
+        .name = "spi2",
+        .rx_shift = DMA_FLAG_SHIFT(4),
+        .tx_shift = DMA_FLAG_SHIFT(5),
+    },
+#ifdef DMA_HAS_DMA2
+    [SPI_DMA_SPI3] = {
+        .spi = SPI3,
+        .dma = DMA2,
+        .rx_chan = SPI3_RX_DMA_CHAN,
+        .tx_chan = SPI3_TX_DMA_CHAN,
+        .name = "spi3",
+        .rx_shift = DMA_FLAG_SHIFT(1),
+        .tx_shift = DMA_FLAG_SHIFT(2),
+    },
+#endif
+};
+
+static spi_dma_state_t spi_dma_state[SPI_DMA_NUM];
+
+static const uint16_t spi_dma_dummy = CONFIG_SPI_DMA_DUMMY;
+
+static int spi_dma_index(const SPI_TypeDef* spix)
+{
+    for (int i = 0; i < SPI_DMA_NUM; i++) {
+        if (spi_dma_dev[i].spi == spix)
+            return i;
+    }
+
+    return -ENODEV;
+}
+
+static void spi_dma_rx_event(void* ctx, uint32_t events);
+
+int spi_dma_init(SPI_TypeDef* spix)
+{
+    int idx = spi_dma_index(spix);
+    RETURN_IF(idx < 0, idx);
+
+    const spi_dma_dev_t* dev = &spi_dma_dev[idx];
+    spi_dma_state_t* st = &spi_dma_state[idx];
+
+    // already ours
+    if (dma_owner(dev->rx_chan) == dev->name)
+        return 0;
+
+    st->dev = dev;
+
+    int ret = dma_claim(dev->rx_chan, dev->name, spi_dma_rx_event, st);
+    RETURN_IF_NZERO(ret, ret);
+
+    ret = dma_claim(dev->tx_chan, dev->name, NULL, NULL);
+    if (0 != ret)
+        dma_release(dev->rx_chan);
+
+    return ret;
+}
+
+int spi_dma_transfer(SPI_TypeDef* spix, const void* tx, void* rx,
+                     uint32_t len, spi_dma_cb_t cb, void* arg)
+{
+    int idx = spi_dma_index(spix);
+    RETURN_IF(idx < 0, idx);
+    // CNDTR is 16 bits wide
+    RETURN_IF(0 == len || len > 0xFFFF, -EINVAL);
+
+    const spi_dma_dev_t* dev = &spi_dma_dev[idx];
+    spi_dma_state_t* st = &spi_dma_state[idx];
+
+    uint32_t key = kernel_irq_save();
+    if (st->busy) {
+        kernel_irq_restore(key);
+        return -EBUSY;
+    }
+    st->busy = 1;
+    kernel_irq_restore(key);
+
+    st->cb = cb;
+    st->arg = arg;
+
+    uint32_t size = 0;
+    if (spix->CR1 & SPI_CR1_DFF)
+        size = DMA_PeripheralDataSize_HalfWord | DMA_MemoryDataSize_HalfWord;
+
+    uint32_t rx_ccr = size | DMA_Priority_VeryHigh | DMA_CCR1_TCIE |
+                      DMA_CCR1_TEIE;
+    uint32_t tx_ccr = size | DMA_Priority_High | DMA_DIR_PeripheralDST;
+
+    if (NULL != rx)
+        rx_ccr |= DMA_MemoryInc_Enable;
+    else
+        rx = &st->sink;
+
+    if (NULL != tx)
+        tx_ccr |= DMA_MemoryInc_Enable;
+    else
+        tx = &spi_dma_dummy;
+
+    // a stale frame would be the first thing the rx channel picks up,
+    // reading DR then SR also clears OVR
+    (void) spix->DR;
+    (void) spix->SR;
+
+    dev->rx_chan->CCR = 0;
+    dev->tx_chan->CCR = 0;
+    dev->dma->IFCR = (DMA_FLAGS_ALL << dev->rx_shift) |
+                     (DMA_FLAGS_ALL << dev->tx_shift);
+
+    dev->rx_chan->CPAR = (uint32_t) &spix->DR;
+    dev->rx_chan->CMAR = (uint32_t) rx;
+    dev->rx_chan->CNDTR = len;
+
+    dev->tx_chan->CPAR = (uint32_t) &spix->DR;
+    dev->tx_chan->CMAR = (uint32_t) tx;
+    dev->tx_chan->CNDTR = len;
+
+    // rx must be armed before the first frame is clocked out
+    dev->rx_chan->CCR = rx_ccr | DMA_CCR1_EN;
+    dev->tx_chan->CCR = tx_ccr | DMA_CCR1_EN;
+    spix->CR2 |= SPI_CR2_RXDMAEN | SPI_CR2_TXDMAEN;
+
+    return 0;
+}
+
+int spi_dma_is_busy(SPI_TypeDef* spix)
+{
+    int idx = spi_dma_index(spix);
+    RETURN_IF(idx < 0, idx);
+
+    return spi_dma_state[idx].busy;
+}
+
+static void spi_dma_rx_event(void* ctx, uint32_t events)
+{
+    spi_dma_state_t* st = (spi_dma_state_t*) ctx;
+    const spi_dma_dev_t* dev = st->dev;
+
+    int status;
+    if (events & DMA_EVT_TE)
+        status = -EIO;
+    else if (events & DMA_EVT_TC)
+        status = 0;
+    else
+        return;
+
+    dev->spi->CR2 &= ~(SPI_CR2_RXDMAEN | SPI_CR2_TXDMAEN);
+    dev->rx_chan->CCR = 0;
+    dev->tx_chan->CCR = 0;
+    dev->dma->IFCR = DMA_FLAGS_ALL << dev->tx_shift;
+
+    spi_dma_cb_t cb = st->cb;
+    void* arg = st->arg;
+    st->busy = 0;
+
+    // the callback is free to start the next transfer
+    if (NULL != cb)
+        cb(arg, status);
+}
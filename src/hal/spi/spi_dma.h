@@ -0,0 +1,39 @@
+/*
+@file: spi_dma.h
+@author: ZZH
+@date: 2026-10-19
+@info: DMA backed bulk spi transfers
+*/
+
+#ifndef __SPI_DMA_H__
+#define __SPI_DMA_H__
+
+#include <errno.h>
+#include <stdint.h>
+#include "stm32f10x_spi.h"
+
+// sent for every frame of a rx-only transfer
+#ifndef CONFIG_SPI_DMA_DUMMY
+#define CONFIG_SPI_DMA_DUMMY 0xFFFF
+#endif
+
+// status is 0 on success or -EIO on a DMA transfer error
+typedef void (*spi_dma_cb_t)(void* arg, int status);
+
+// claim the DMA channels of the bus through the DMA manager
+int spi_dma_init(SPI_TypeDef* spix);
+
+/*
+ * start a transfer of len frames (8 or 16 bits, following the DFF bit of
+ * the bus) and return at once, cb runs in interrupt context when the last
+ * frame has been received:
+ *   - tx and rx:   full duplex
+ *   - rx == NULL:  tx only, received frames are discarded
+ *   - tx == NULL:  rx only, CONFIG_SPI_DMA_DUMMY is clocked out
+ * chip select is up to the caller.
+ */
+int spi_dma_transfer(SPI_TypeDef* spix, const void* tx, void* rx,
+                     uint32_t len, spi_dma_cb_t cb, void* arg);
+int spi_dma_is_busy(SPI_TypeDef* spix);
+
+#endif // __SPI_DMA_H__
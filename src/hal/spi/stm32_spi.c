@@ -0,0 +1,48 @@
+/*
+@file: stm32_spi.c
+@author: ZZH
+@date: 2026-10-19
+@info: at most two frames are in flight, one in the shifter and one in the
+       tx buffer, a third one could overrun rx before it is drained
+*/
+
+#include <stddef.h>
+#include "stm32_spi.h"
+
+#define SPI_BURST_BODY(pspi, tx, rx, len, type)                           \
+    do {                                                                  \
+        uint32_t tx_left = len;                                           \
+        uint32_t rx_left = len;                                           \
+                                                                          \
+        /* a stale frame would be taken for the first one */              \
+        (void) pspi->DR;                                                  \
+                                                                          \
+        while (0 != rx_left) {                                            \
+            uint32_t sr = pspi->SR;                                       \
+                                                                          \
+            if (sr & SPI_SR_RXNE) {                                       \
+                type value = (type) pspi->DR;                             \
+                if (NULL != rx)                                           \
+                    *rx++ = value;                                        \
+                rx_left--;                                                \
+            }                                                             \
+                                                                          \
+            if ((sr & SPI_SR_TXE) && 0 != tx_left &&                      \
+                rx_left - tx_left < 2) {                                  \
+                pspi->DR = (NULL != tx) ? *tx++ : (type) SPI_BURST_DUMMY; \
+                tx_left--;                                                \
+            }                                                             \
+        }                                                                 \
+    } while (0)
+
+void spi_burst8(SPI_TypeDef* pspi, const uint8_t* tx, uint8_t* rx,
+                uint32_t len)
+{
+    SPI_BURST_BODY(pspi, tx, rx, len, uint8_t);
+}
+
+void spi_burst16(SPI_TypeDef* pspi, const uint16_t* tx, uint16_t* rx,
+                 uint32_t len)
+{
+    SPI_BURST_BODY(pspi, tx, rx, len, uint16_t);
+}
@@ -3,15 +3,27 @@
 
 #include "stm32f10x_spi.h"
 
+#define SPI_BURST_DUMMY 0xFFFF
+
 static inline uint16_t spi_rw(SPI_TypeDef* pspi, uint16_t value)
 {
     SPI_I2S_SendData(pspi, value);
     while (RESET == SPI_I2S_GetFlagStatus(pspi, SPI_I2S_FLAG_RXNE))
         __asm volatile ("nop");
-    SPI_I2S_ClearFlag(pspi, SPI_I2S_FLAG_RXNE);
 
+    // reading DR clears RXNE
     return SPI_I2S_ReceiveData(pspi);
 }
 
+/*
+ * polled block transfers that keep the next frame in the tx buffer while
+ * the current one is shifted out, so frames go out back to back. tx == NULL
+ * sends SPI_BURST_DUMMY, rx == NULL drops the received frames. the frame
+ * size must match the DFF bit of the bus.
+ */
+void spi_burst8(SPI_TypeDef* pspi, const uint8_t* tx, uint8_t* rx,
+                uint32_t len);
+void spi_burst16(SPI_TypeDef* pspi, const uint16_t* tx, uint16_t* rx,
+                 uint32_t len);
 
 #endif // __STM32_SPI_H__
@@ -0,0 +1,443 @@
+/*
+@file: w25qxx.c
+@author: ZZH
+@date: 2026-10-19
+@info: only the 3-byte address commands are used, so up to 16MiB parts
+*/
+
+#include <stddef.h>
+#include <string.h>
+#include "w25qxx.h"
+#include "arg_checkers.h"
+
+#define CMD_WRITE_ENABLE 0x06
+#define CMD_READ_STATUS1 0x05
+#define CMD_JEDEC_ID     0x9F
+#define CMD_FAST_READ    0x0B
+#define CMD_PAGE_PROGRAM 0x02
+#define CMD_SECTOR_ERASE 0x20
+#define CMD_BLOCK32      0x52
+#define CMD_BLOCK64      0xD8
+
+#define STATUS_BUSY 0x01
+
+// CNDTR limit of a single DMA transfer
+#define MAX_CHUNK 0xFFFF
+
+// queue the transaction and wait for it, cmd must be filled beforehand
+#define NOR_XFER(co, nor, cmd_len, tx, rx, len)                \
+    do {                                                       \
+        {                                                      \
+            int __ret = nor_submit(nor, cmd_len, tx, rx, len); \
+            if (0 != __ret)                                    \
+                CO_RETURN(co, __ret);                          \
+        }                                                      \
+        CO_WAIT_UNTIL(co, spi_xfer_done(&(nor)->xfer));        \
+        if ((nor)->xfer.status < 0)                            \
+            CO_RETURN(co, (nor)->xfer.status);                 \
+    } while (0)
+
+static int nor_submit(w25q_t* nor, uint32_t cmd_len, const void* tx,
+                      void* rx, uint32_t len)
+{
+    spi_xfer_t* xfer = &nor->xfer;
+
+    xfer->dev = nor->dev;
+    xfer->cmd = nor->cmd;
+    xfer->cmd_len = cmd_len;
+    xfer->tx = tx;
+    xfer->rx = rx;
+    xfer->len = len;
+    xfer->cb = NULL;
+    xfer->arg = nor;
+
+    return nor->submit(nor->ctx, xfer);
+}
+
+static void nor_cmd(w25q_t* nor, uint8_t opcode, uint32_t addr)
+{
+    nor->cmd[0] = opcode;
+    nor->cmd[1] = (uint8_t) (addr >> 16);
+    nor->cmd[2] = (uint8_t) (addr >> 8);
+    nor->cmd[3] = (uint8_t) addr;
+    // dummy byte of the fast read
+    nor->cmd[4] = 0xFF;
+}
+
+static inline int nor_expired(uint32_t deadline)
+{
+    return (int32_t) (co_now() - deadline) >= 0;
+}
+
+int w25q_init(w25q_t* nor, w25q_submit_t submit, void* ctx,
+              const spi_dev_t* dev)
+{
+    CHECK_PTR(nor, -EINVAL);
+    CHECK_PTR(submit, -EINVAL);
+
+    memset(nor, 0, sizeof(*nor));
+    nor->submit = submit;
+    nor->ctx = ctx;
+    nor->dev = dev;
+
+    return 0;
+}
+
+void w25q_cache_invalidate(w25q_t* nor)
+{
+    for (int i = 0; i < CONFIG_W25Q_CACHE_LINES; i++)
+        nor->cache[i].valid = 0;
+}
+
+static void cache_invalidate_range(w25q_t* nor, uint32_t addr, uint32_t len)
+{
+    for (int i = 0; i < CONFIG_W25Q_CACHE_LINES; i++) {
+        w25q_cache_line_t* line = &nor->cache[i];
+
+        if (line->tag < addr + len &&
+            addr < line->tag + CONFIG_W25Q_CACHE_LINE_SIZE)
+            line->valid = 0;
+    }
+}
+
+static w25q_cache_line_t* cache_lookup(w25q_t* nor, uint32_t tag)
+{
+    for (int i = 0; i < CONFIG_W25Q_CACHE_LINES; i++) {
+        if (nor->cache[i].valid && nor->cache[i].tag == tag)
+            return &nor->cache[i];
+    }
+
+    return NULL;
+}
+
+// an invalid line if there is one, the least recently used one otherwise
+static w25q_cache_line_t* cache_victim(w25q_t* nor)
+{
+    w25q_cache_line_t* victim = &nor->cache[0];
+
+    for (int i = 0; i < CONFIG_W25Q_CACHE_LINES; i++) {
+        w25q_cache_line_t* line = &nor->cache[i];
+
+        if (!line->valid)
+            return line;
+
+        if ((int32_t) (line->stamp - victim->stamp) < 0)
+            victim = line;
+    }
+
+    return victim;
+}
+
+static int nor_wait_ready(w25q_t* nor)
+{
+    co_t* co = &nor->wait_co;
+
+    CO_BEGIN(co);
+
+    while (1) {
+        nor_cmd(nor, CMD_READ_STATUS1, 0);
+        NOR_XFER(co, nor, 1, NULL, &nor->status, 1);
+        nor->stats.busy_polls++;
+
+        if (0 == (nor->status & STATUS_BUSY))
+            break;
+
+        if (nor_expired(nor->deadline))
+            CO_RETURN(co, -ETIMEDOUT);
+
+        if (0 != nor->poll_ticks)
+            CO_DELAY(co, nor->poll_ticks);
+        else
+            CO_YIELD(co);
+    }
+
+    CO_END(co);
+}
+
+static int nor_write_enable(w25q_t* nor)
+{
+    co_t* co = &nor->wait_co;
+
+    CO_BEGIN(co);
+
+    nor_cmd(nor, CMD_WRITE_ENABLE, 0);
+    NOR_XFER(co, nor, 1, NULL, NULL, 0);
+
+    CO_END(co);
+}
+
+static int nor_probe(w25q_t* nor)
+{
+    co_t* co = &nor->co;
+
+    CO_BEGIN(co);
+
+    nor_cmd(nor, CMD_JEDEC_ID, 0);
+    NOR_XFER(co, nor, 1, NULL, nor->id, sizeof(nor->id));
+
+    nor->jedec_id = ((uint32_t) nor->id[0] << 16) |
+                    ((uint32_t) nor->id[1] << 8) | nor->id[2];
+
+    // a floating or missing chip reads all zeros or all ones, the third
+    // byte is log2 of the size in bytes
+    if (0 == nor->id[0] || 0xFF == nor->id[0] || nor->id[2] < 0x10 ||
+        nor->id[2] > 0x18)
+        CO_RETURN(co, -ENODEV);
+
+    nor->capacity = 1UL << nor->id[2];
+
+    CO_END(co);
+}
+
+static int nor_read(w25q_t* nor)
+{
+    co_t* co = &nor->co;
+    uint32_t tag = nor->addr & ~(CONFIG_W25Q_CACHE_LINE_SIZE - 1);
+
+    CO_BEGIN(co);
+
+    if (nor->addr + nor->len <= tag + CONFIG_W25Q_CACHE_LINE_SIZE) {
+        nor->line = cache_lookup(nor, tag);
+
+        if (NULL != nor->line) {
+            nor->stats.cache_hits++;
+        } else {
+            nor->stats.cache_misses++;
+
+            nor->line = cache_victim(nor);
+            nor->line->valid = 0;
+            nor->line->tag = tag;
+
+            nor_cmd(nor, CMD_FAST_READ, tag);
+            NOR_XFER(co, nor, 5, NULL, nor->line->data,
+                     CONFIG_W25Q_CACHE_LINE_SIZE);
+            nor->line->valid = 1;
+        }
+
+        nor->line->stamp = ++nor->cache_clock;
+        memcpy(nor->rbuf, &nor->line->data[nor->addr - nor->line->tag],
+               nor->len);
+        CO_RETURN(co, CO_DONE);
+    }
+
+    for (nor->pos = 0; nor->pos < nor->len; nor->pos += nor->chunk) {
+        nor->chunk = nor->len - nor->pos;
+        if (nor->chunk > MAX_CHUNK)
+            nor->chunk = MAX_CHUNK;
+
+        nor_cmd(nor, CMD_FAST_READ, nor->addr + nor->pos);
+        NOR_XFER(co, nor, 5, NULL, nor->rbuf + nor->pos, nor->chunk);
+    }
+
+    CO_END(co);
+}
+
+static int nor_program(w25q_t* nor)
+{
+    co_t* co = &nor->co;
+    int ret;
+
+    CO_BEGIN(co);
+
+    for (nor->pos = 0; nor->pos < nor->len; nor->pos += nor->chunk) {
+        // a page program wraps around inside the page
+        nor->chunk = W25Q_PAGE_SIZE - (nor->addr + nor->pos) % W25Q_PAGE_SIZE;
+        if (nor->chunk > nor->len - nor->pos)
+            nor->chunk = nor->len - nor->pos;
+
+        CO_AWAIT(co, ret, nor_write_enable(nor));
+        if (ret < 0)
+            CO_RETURN(co, ret);
+
+        nor_cmd(nor, CMD_PAGE_PROGRAM, nor->addr + nor->pos);
+        NOR_XFER(co, nor, 4, nor->wbuf + nor->pos, NULL, nor->chunk);
+
+        nor->deadline =
+            co_now() + TIMEBASE_MS_TO_TICKS(CONFIG_W25Q_PROGRAM_TIMEOUT_MS);
+        nor->poll_ticks = 0;
+        CO_AWAIT(co, ret, nor_wait_ready(nor));
+        if (ret < 0)
+            CO_RETURN(co, ret);
+    }
+
+    CO_END(co);
+}
+
+static int nor_erase(w25q_t* nor)
+{
+    co_t* co = &nor->co;
+    int ret;
+
+    CO_BEGIN(co);
+
+    CO_AWAIT(co, ret, nor_write_enable(nor));
+    if (ret < 0)
+        CO_RETURN(co, ret);
+
+    nor_cmd(nor, nor->erase_cmd, nor->addr);
+    NOR_XFER(co, nor, 4, NULL, NULL, 0);
+
+    // erases take tens of milliseconds, do not keep the bus busy
+    nor->deadline =
+        co_now() + TIMEBASE_MS_TO_TICKS(CONFIG_W25Q_ERASE_TIMEOUT_MS);
+    nor->poll_ticks = 1;
+    CO_AWAIT(co, ret, nor_wait_ready(nor));
+    if (ret < 0)
+        CO_RETURN(co, ret);
+
+    CO_END(co);
+}
+
+static int nor_begin(w25q_t* nor, w25q_op_t op)
+{
+    RETURN_IF(W25Q_OP_NONE != nor->op, -EBUSY);
+
+    co_init(&nor->co);
+    co_init(&nor->wait_co);
+    nor->op = op;
+    nor->start_us = timebase_get_us();
+
+    return 0;
+}
+
+static int nor_check_range(const w25q_t* nor, uint32_t addr, uint32_t len)
+{
+    RETURN_IF(0 == nor->capacity, -ENODEV);
+    RETURN_IF(0 == len, -EINVAL);
+    RETURN_IF(addr >= nor->capacity || len > nor->capacity - addr, -ERANGE);
+
+    return 0;
+}
+
+int w25q_start_probe(w25q_t* nor)
+{
+    CHECK_PTR(nor, -EINVAL);
+
+    return nor_begin(nor, W25Q_OP_PROBE);
+}
+
+int w25q_start_read(w25q_t* nor, uint32_t addr, void* buf, uint32_t len)
+{
+    CHECK_PTR(nor, -EINVAL);
+    CHECK_PTR(buf, -EINVAL);
+
+    int ret = nor_check_range(nor, addr, len);
+    RETURN_IF_NZERO(ret, ret);
+    ret = nor_begin(nor, W25Q_OP_READ);
+    RETURN_IF_NZERO(ret, ret);
+
+    nor->addr = addr;
+    nor->rbuf = (uint8_t*) buf;
+    nor->len = len;
+
+    return 0;
+}
+
+int w25q_start_program(w25q_t* nor, uint32_t addr, const void* buf,
+                       uint32_t len)
+{
+    CHECK_PTR(nor, -EINVAL);
+    CHECK_PTR(buf, -EINVAL);
+
+    int ret = nor_check_range(nor, addr, len);
+    RETURN_IF_NZERO(ret, ret);
+    ret = nor_begin(nor, W25Q_OP_PROGRAM);
+    RETURN_IF_NZERO(ret, ret);
+
+    nor->addr = addr;
+    nor->wbuf = (const uint8_t*) buf;
+    nor->len = len;
+    cache_invalidate_range(nor, addr, len);
+
+    return 0;
+}
+
+int w25q_start_erase(w25q_t* nor, uint32_t addr, uint32_t size)
+{
+    CHECK_PTR(nor, -EINVAL);
+
+    uint8_t cmd;
+    switch (size) {
+        case W25Q_SECTOR_SIZE: cmd = CMD_SECTOR_ERASE; break;
+        case W25Q_BLOCK32: cmd = CMD_BLOCK32; break;
+        case W25Q_BLOCK64: cmd = CMD_BLOCK64; break;
+        default: return -EINVAL;
+    }
+
+    RETURN_IF(0 != (addr & (size - 1)), -EINVAL);
+
+    int ret = nor_check_range(nor, addr, size);
+    RETURN_IF_NZERO(ret, ret);
+    ret = nor_begin(nor, W25Q_OP_ERASE);
+    RETURN_IF_NZERO(ret, ret);
+
+    nor->addr = addr;
+    nor->len = size;
+    nor->erase_cmd = cmd;
+    cache_invalidate_range(nor, addr, size);
+
+    return 0;
+}
+
+static void nor_account(w25q_t* nor)
+{
+    uint32_t us = (uint32_t) (timebase_get_us() - nor->start_us);
+
+    switch (nor->op) {
+        case W25Q_OP_READ:
+            nor->stats.read_bytes += nor->len;
+            nor->stats.read_us += us;
+            break;
+
+        case W25Q_OP_PROGRAM:
+            nor->stats.program_bytes += nor->len;
+            nor->stats.program_us += us;
+            break;
+
+        case W25Q_OP_ERASE:
+            nor->stats.erase_bytes += nor->len;
+            nor->stats.erase_us += us;
+            break;
+
+        default: break;
+    }
+}
+
+int w25q_poll(w25q_t* nor)
+{
+    CHECK_PTR(nor, -EINVAL);
+
+    int ret;
+    switch (nor->op) {
+        case W25Q_OP_PROBE: ret = nor_probe(nor); break;
+        case W25Q_OP_READ: ret = nor_read(nor); break;
+        case W25Q_OP_PROGRAM: ret = nor_program(nor); break;
+        case W25Q_OP_ERASE: ret = nor_erase(nor); break;
+        default: return -EINVAL;
+    }
+
+    if (CO_WAITING != ret) {
+        if (CO_DONE == ret)
+            nor_account(nor);
+
+        nor->op = W25Q_OP_NONE;
+    }
+
+    return ret;
+}
+
+int w25q_run(w25q_t* nor)
+{
+    int ret;
+
+    do {
+        ret = w25q_poll(nor);
+    } while (CO_WAITING == ret);
+
+    return ret;
+}
+
+const w25q_stats_t* w25q_get_stats(const w25q_t* nor)
+{
+    return NULL == nor ? NULL : &nor->stats;
+}
@@ -0,0 +1,140 @@
+/*
+@file: w25qxx.h
+@author: ZZH
+@date: 2026-10-19
+@info: W25Qxx class spi nor flash driver
+
+Every operation is started with one of the w25q_start_* calls and then
+driven by w25q_poll, which is a coroutine:
+
+    w25q_start_read(&nor, addr, buf, len);
+    CO_AWAIT(co, ret, w25q_poll(&nor));
+
+w25q_run polls until the operation is done for callers outside a
+coroutine. Only one operation can be in progress per chip.
+*/
+
+#ifndef __W25QXX_H__
+#define __W25QXX_H__
+
+#include <errno.h>
+#include <stdint.h>
+#include "hal/spi/spi_bus.h"
+#include "sys/coroutine.h"
+
+#ifndef CONFIG_W25Q_CACHE_LINES
+#define CONFIG_W25Q_CACHE_LINES 4
+#endif
+
+#ifndef CONFIG_W25Q_CACHE_LINE_SIZE
+#define CONFIG_W25Q_CACHE_LINE_SIZE 32
+#endif
+
+#ifndef CONFIG_W25Q_PROGRAM_TIMEOUT_MS
+#define CONFIG_W25Q_PROGRAM_TIMEOUT_MS 5
+#endif
+
+#ifndef CONFIG_W25Q_ERASE_TIMEOUT_MS
+#define CONFIG_W25Q_ERASE_TIMEOUT_MS 2000
+#endif
+
+#define W25Q_PAGE_SIZE   256
+#define W25Q_SECTOR_SIZE 0x1000
+#define W25Q_BLOCK32     0x8000
+#define W25Q_BLOCK64     0x10000
+
+// queue a transaction, the same contract as spi_bus_submit
+typedef int (*w25q_submit_t)(void* ctx, spi_xfer_t* xfer);
+
+typedef enum {
+    W25Q_OP_NONE = 0,
+    W25Q_OP_PROBE,
+    W25Q_OP_READ,
+    W25Q_OP_PROGRAM,
+    W25Q_OP_ERASE,
+} w25q_op_t;
+
+typedef struct
+{
+    uint32_t tag;
+    uint32_t stamp;
+    uint8_t valid;
+    uint8_t data[CONFIG_W25Q_CACHE_LINE_SIZE];
+} w25q_cache_line_t;
+
+typedef struct
+{
+    uint32_t read_bytes;
+    uint32_t read_us;
+    uint32_t program_bytes;
+    uint32_t program_us;
+    uint32_t erase_bytes;
+    uint32_t erase_us;
+    uint32_t busy_polls;
+    uint32_t cache_hits;
+    uint32_t cache_misses;
+} w25q_stats_t;
+
+typedef struct
+{
+    w25q_submit_t submit;
+    void* ctx;
+    const spi_dev_t* dev;
+
+    uint32_t jedec_id;
+    uint32_t capacity;
+
+    // state of the operation in progress
+    co_t co;
+    co_t wait_co;
+    w25q_op_t op;
+    spi_xfer_t xfer;
+    uint8_t cmd[5];
+    uint8_t id[3];
+    uint8_t status;
+    uint8_t erase_cmd;
+    uint32_t addr;
+    const uint8_t* wbuf;
+    uint8_t* rbuf;
+    uint32_t len;
+    uint32_t pos;
+    uint32_t chunk;
+    uint32_t deadline;
+    uint32_t poll_ticks;
+    uint64_t start_us;
+    w25q_cache_line_t* line;
+
+    w25q_cache_line_t cache[CONFIG_W25Q_CACHE_LINES];
+    uint32_t cache_clock;
+
+    w25q_stats_t stats;
+} w25q_t;
+
+static inline int w25q_spi_bus_submit(void* ctx, spi_xfer_t* xfer)
+{
+    return spi_bus_submit((spi_bus_t*) ctx, xfer);
+}
+
+// dev is handed to the transport in every transaction, it can be NULL
+// for a transport that does not need it
+int w25q_init(w25q_t* nor, w25q_submit_t submit, void* ctx,
+              const spi_dev_t* dev);
+
+// read the JEDEC id and derive the capacity from it
+int w25q_start_probe(w25q_t* nor);
+// small reads inside one cache line go through the read cache
+int w25q_start_read(w25q_t* nor, uint32_t addr, void* buf, uint32_t len);
+// split at page boundaries, the range must be erased beforehand
+int w25q_start_program(w25q_t* nor, uint32_t addr, const void* buf,
+                       uint32_t len);
+// size is W25Q_SECTOR_SIZE, W25Q_BLOCK32 or W25Q_BLOCK64, addr is aligned
+// to it
+int w25q_start_erase(w25q_t* nor, uint32_t addr, uint32_t size);
+
+int w25q_poll(w25q_t* nor);
+int w25q_run(w25q_t* nor);
+
+void w25q_cache_invalidate(w25q_t* nor);
+const w25q_stats_t* w25q_get_stats(const w25q_t* nor);
+
+#endif // __W25QXX_H__
@@ -0,0 +1,183 @@
+/*
+@file: w25qxx_check.c
+@author: ZZH
+@date: 2026-10-19
+@info: runs the driver against the simulated chip, no spi hardware needed,
+       so it works on the QEMU image and the host build as well
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "w25qxx.h"
+#include "w25qxx_sim.h"
+#include "tiny_console/tiny_console.h"
+#include "tiny_console/tiny_console_cmd.h"
+
+// a W25Q32 id, the 1 KiB behind it shows up mirrored across the 4 MiB
+#define CHECK_JEDEC_ID 0xEF4016
+#define CHECK_MEM_SIZE 1024
+// 64 bytes across the end of the first page
+#define CHECK_PROG_ADDR (W25Q_PAGE_SIZE - 16)
+#define CHECK_PROG_LEN  64
+
+typedef struct
+{
+    uint32_t total;
+    uint32_t failed;
+} check_ctx_t;
+
+// from the heap while the check runs
+typedef struct
+{
+    w25q_sim_t sim;
+    w25q_t nor;
+    uint8_t mem[CHECK_MEM_SIZE];
+} check_chip_t;
+
+static void check(console_t* this, check_ctx_t* ctx, int ok, const char* what)
+{
+    ctx->total++;
+    if (ok)
+        return;
+
+    ctx->failed++;
+    console_println(this, "w25qcheck: %s wrong", what);
+}
+
+static int check_erased(const uint8_t* mem, uint32_t from, uint32_t to)
+{
+    for (uint32_t i = from; i < to; i++) {
+        if (0xFF != mem[i])
+            return 0;
+    }
+
+    return 1;
+}
+
+static uint8_t prog_byte(uint32_t i)
+{
+    return (uint8_t) (i * 7 + 1);
+}
+
+CONSOLE_CMD_DEF(w25q_check_cmd)
+{
+    CONSOLE_CMD_UNUSE_ARGS;
+
+    check_ctx_t ctx = {0};
+    uint8_t wbuf[CHECK_PROG_LEN];
+    uint8_t rbuf[CHECK_PROG_LEN];
+
+    check_chip_t* chip = malloc(sizeof(check_chip_t));
+    if (NULL == chip) {
+        console_println(this, "w25qcheck: error=%d", -ENOMEM);
+        return -ENOMEM;
+    }
+
+    w25q_sim_t* sim = &chip->sim;
+    w25q_t* nor = &chip->nor;
+    uint8_t* mem = chip->mem;
+
+    for (uint32_t i = 0; i < CHECK_PROG_LEN; i++) wbuf[i] = prog_byte(i);
+
+    check(this, &ctx,
+          0 == w25q_sim_init(sim, mem, CHECK_MEM_SIZE, CHECK_JEDEC_ID),
+          "sim init");
+    check(this, &ctx, 0 == w25q_init(nor, w25q_sim_submit, sim, NULL),
+          "init");
+
+    check(this, &ctx, -ENODEV == w25q_start_read(nor, 0, rbuf, 1),
+          "read before probe");
+
+    check(this, &ctx, 0 == w25q_start_probe(nor) && CO_DONE == w25q_run(nor),
+          "probe");
+    check(this, &ctx,
+          CHECK_JEDEC_ID == nor->jedec_id && 0x400000 == nor->capacity,
+          "jedec id");
+
+    // dirty the chip so the erase has something to do
+    memset(mem, 0, CHECK_MEM_SIZE);
+    check(this, &ctx,
+          0 == w25q_start_erase(nor, 0, W25Q_SECTOR_SIZE) &&
+              CO_DONE == w25q_run(nor),
+          "erase");
+    check(this, &ctx, check_erased(mem, 0, CHECK_MEM_SIZE), "erased data");
+
+    check(this, &ctx,
+          0 == w25q_start_program(nor, CHECK_PROG_ADDR, wbuf, sizeof(wbuf)) &&
+              CO_DONE == w25q_run(nor),
+          "program");
+    check(this, &ctx,
+          0 == memcmp(&mem[CHECK_PROG_ADDR], wbuf, sizeof(wbuf)) &&
+              check_erased(mem, 0, CHECK_PROG_ADDR) &&
+              check_erased(mem, CHECK_PROG_ADDR + CHECK_PROG_LEN,
+                           CHECK_MEM_SIZE),
+          "programmed data");
+
+    // longer than a cache line, read straight from the chip
+    memset(rbuf, 0, sizeof(rbuf));
+    check(this, &ctx,
+          0 == w25q_start_read(nor, CHECK_PROG_ADDR, rbuf, sizeof(rbuf)) &&
+              CO_DONE == w25q_run(nor) &&
+              0 == memcmp(rbuf, wbuf, sizeof(rbuf)),
+          "read back");
+
+    // inside one line, the second read is a hit
+    for (int i = 0; i < 2; i++) {
+        memset(rbuf, 0, sizeof(rbuf));
+        check(this, &ctx,
+              0 == w25q_start_read(nor, W25Q_PAGE_SIZE, rbuf, 8) &&
+                  CO_DONE == w25q_run(nor) &&
+                  0 == memcmp(rbuf, &wbuf[16], 8),
+              "cached read");
+    }
+
+    check(this, &ctx, 0 == sim->bad_bits && 0 == sim->ignored, "clean run");
+
+    // a 1 over a programmed 0 stays 0 and is counted by the chip
+    check(this, &ctx,
+          0 == w25q_start_program(nor, CHECK_PROG_ADDR, "\xFF", 1) &&
+              CO_DONE == w25q_run(nor),
+          "overprogram");
+    check(this, &ctx, 1 == sim->bad_bits && wbuf[0] == mem[CHECK_PROG_ADDR],
+          "bad bits");
+
+    // a page program without write enable is dropped
+    uint8_t cmd[4] = {0x02, 0, 0, 0};
+    spi_xfer_t xfer = {.cmd = cmd, .cmd_len = 4, .tx = "\x00", .len = 1};
+    check(this, &ctx,
+          0 == w25q_sim_submit(sim, &xfer) && 0 == xfer.status &&
+              1 == sim->ignored && 0xFF == mem[0],
+          "write enable latch");
+
+    check(this, &ctx,
+          -ERANGE == w25q_start_program(nor, nor->capacity - 1, wbuf, 2) &&
+              -EINVAL == w25q_start_erase(nor, W25Q_PAGE_SIZE,
+                                          W25Q_SECTOR_SIZE) &&
+              -EINVAL == w25q_start_erase(nor, 0, W25Q_PAGE_SIZE),
+          "range checks");
+
+    // a status read per busy poll and one more that sees the chip ready
+    const w25q_stats_t* stats = w25q_get_stats(nor);
+    uint32_t polls = 3 * (sim->program_polls + 1) + sim->erase_polls + 1;
+
+    check(this, &ctx,
+          CHECK_PROG_LEN + 1 == stats->program_bytes &&
+              W25Q_SECTOR_SIZE == stats->erase_bytes &&
+              CHECK_PROG_LEN + 16 == stats->read_bytes &&
+              polls == stats->busy_polls && 1 == stats->cache_hits &&
+              1 == stats->cache_misses,
+          "stats");
+
+    free(chip);
+
+    console_println(this, "w25qcheck: passed [%lu/%lu]",
+                    ctx.total - ctx.failed, ctx.total);
+    if (ctx.failed)
+        console_println(this, "w25qcheck: failed [%lu/%lu]", ctx.failed,
+                        ctx.total);
+
+    return ctx.failed ? -EIO : 0;
+}
+
+EXPORT_CONSOLE_CMD("w25qcheck", w25q_check_cmd,
+                   "run the w25qxx driver against the simulated chip", NULL);
@@ -0,0 +1,172 @@
+/*
+@file: w25qxx_sim.c
+@author: ZZH
+@date: 2026-10-19
+@info: models the parts of the chip the driver relies on: write enable
+       latch, busy time, page wrap and program only clearing bits
+*/
+
+#include <stddef.h>
+#include <string.h>
+#include "w25qxx_sim.h"
+#include "arg_checkers.h"
+
+#define SR_BUSY 0x01
+#define SR_WEL  0x02
+
+#define SIM_PAGE_SIZE 256
+
+int w25q_sim_init(w25q_sim_t* sim, uint8_t* mem, uint32_t size,
+                  uint32_t jedec_id)
+{
+    CHECK_PTR(sim, -EINVAL);
+    CHECK_PTR(mem, -EINVAL);
+    RETURN_IF(0 == size || 0 != (size & (size - 1)), -EINVAL);
+
+    memset(sim, 0, sizeof(*sim));
+    sim->mem = mem;
+    sim->size = size;
+    sim->jedec_id = jedec_id;
+    sim->program_polls = 2;
+    sim->erase_polls = 8;
+
+    // a new chip comes erased
+    memset(mem, 0xFF, size);
+
+    return 0;
+}
+
+static uint32_t sim_addr(const w25q_sim_t* sim, const uint8_t* cmd)
+{
+    uint32_t addr = ((uint32_t) cmd[1] << 16) | ((uint32_t) cmd[2] << 8) |
+                    cmd[3];
+
+    return addr & (sim->size - 1);
+}
+
+static void sim_read_status(w25q_sim_t* sim, uint8_t* rx, uint32_t len)
+{
+    for (uint32_t i = 0; i < len; i++) {
+        if (NULL != rx)
+            rx[i] = sim->status;
+
+        if (0 != sim->busy_reads && 0 == --sim->busy_reads)
+            sim->status &= ~(SR_BUSY | SR_WEL);
+    }
+}
+
+static void sim_start_busy(w25q_sim_t* sim, uint32_t polls)
+{
+    sim->status |= SR_BUSY;
+    sim->busy_reads = polls;
+}
+
+static void sim_program(w25q_sim_t* sim, uint32_t addr, const uint8_t* tx,
+                        uint32_t len)
+{
+    uint32_t page = addr & ~(SIM_PAGE_SIZE - 1);
+
+    for (uint32_t i = 0; i < len && NULL != tx; i++) {
+        uint8_t* cell = &sim->mem[page + ((addr + i) & (SIM_PAGE_SIZE - 1))];
+
+        if (tx[i] & ~*cell)
+            sim->bad_bits++;
+
+        *cell &= tx[i];
+    }
+
+    sim_start_busy(sim, sim->program_polls);
+}
+
+static void sim_erase(w25q_sim_t* sim, uint32_t addr, uint32_t size)
+{
+    addr &= ~(size - 1);
+    if (size > sim->size)
+        size = sim->size;
+
+    memset(&sim->mem[addr], 0xFF, size);
+    sim_start_busy(sim, sim->erase_polls);
+}
+
+static int sim_execute(w25q_sim_t* sim, const uint8_t* cmd, uint32_t cmd_len,
+                       const uint8_t* tx, uint8_t* rx, uint32_t len)
+{
+    RETURN_IF(0 == cmd_len, -EINVAL);
+
+    uint8_t opcode = cmd[0];
+
+    if (0x05 == opcode) {
+        sim_read_status(sim, rx, len);
+        return 0;
+    }
+
+    if (sim->status & SR_BUSY) {
+        sim->ignored++;
+        return 0;
+    }
+
+    switch (opcode) {
+        case 0x9F:
+            for (uint32_t i = 0; i < len && NULL != rx; i++)
+                rx[i] = i < 3 ? (uint8_t) (sim->jedec_id >> (16 - i * 8)) : 0;
+            break;
+
+        case 0x06: sim->status |= SR_WEL; break;
+
+        case 0x0B: {
+            RETURN_IF(cmd_len < 5, -EINVAL);
+            uint32_t addr = sim_addr(sim, cmd);
+
+            for (uint32_t i = 0; i < len && NULL != rx; i++)
+                rx[i] = sim->mem[(addr + i) & (sim->size - 1)];
+            break;
+        }
+
+        case 0x02:
+        case 0x20:
+        case 0x52:
+        case 0xD8:
+            RETURN_IF(cmd_len < 4, -EINVAL);
+
+            if (0 == (sim->status & SR_WEL)) {
+                sim->ignored++;
+                break;
+            }
+
+            if (0x02 == opcode)
+                sim_program(sim, sim_addr(sim, cmd), tx, len);
+            else if (0x20 == opcode)
+                sim_erase(sim, sim_addr(sim, cmd), 0x1000);
+            else if (0x52 == opcode)
+                sim_erase(sim, sim_addr(sim, cmd), 0x8000);
+            else
+                sim_erase(sim, sim_addr(sim, cmd), 0x10000);
+            break;
+
+        default: sim->ignored++; break;
+    }
+
+    return 0;
+}
+
+int w25q_sim_submit(void* ctx, spi_xfer_t* xfer)
+{
+    w25q_sim_t* sim = (w25q_sim_t*) ctx;
+
+    CHECK_PTR(sim, -EINVAL);
+    CHECK_PTR(xfer, -EINVAL);
+
+    xfer->next = NULL;
+    xfer->status = sim_execute(sim, (const uint8_t*) xfer->cmd,
+                               xfer->cmd_len, (const uint8_t*) xfer->tx,
+                               (uint8_t*) xfer->rx, xfer->len);
+
+    sim->xfers++;
+    sim->wire_bytes += xfer->cmd_len + xfer->len;
+    sim->payload_bytes += xfer->len;
+
+    if (NULL != xfer->cb)
+        xfer->cb(xfer, xfer->status);
+
+    return 0;
+}
@@ -0,0 +1,44 @@
+/*
+@file: w25qxx_sim.h
+@author: ZZH
+@date: 2026-10-19
+@info: simulated W25Qxx chip behind the w25q_submit_t transport, for
+       running the driver on a host
+*/
+
+#ifndef __W25QXX_SIM_H__
+#define __W25QXX_SIM_H__
+
+#include <stdint.h>
+#include "hal/spi/spi_bus.h"
+
+typedef struct
+{
+    uint8_t* mem;
+    uint32_t size;
+    uint32_t jedec_id;
+    uint8_t status;
+    // status reads that still return BUSY
+    uint32_t busy_reads;
+    // how long a program/erase stays busy, in status reads
+    uint32_t program_polls;
+    uint32_t erase_polls;
+
+    uint32_t xfers;
+    // bytes clocked on the bus, command and dummy bytes included
+    uint32_t wire_bytes;
+    uint32_t payload_bytes;
+    // commands dropped because the chip was busy or not write enabled
+    uint32_t ignored;
+    // 0 -> 1 transitions requested by a page program
+    uint32_t bad_bits;
+} w25q_sim_t;
+
+// mem holds size bytes, size must be a power of two matching the capacity
+// byte of jedec_id
+int w25q_sim_init(w25q_sim_t* sim, uint8_t* mem, uint32_t size,
+                  uint32_t jedec_id);
+// completes every transaction before returning
+int w25q_sim_submit(void* ctx, spi_xfer_t* xfer);
+
+#endif // __W25QXX_SIM_H__
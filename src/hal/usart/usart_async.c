@@ -0,0 +1,87 @@
+/*
+@file: usart_async.c
+@author: ZZH
+@date: 2026-10-19
+@info: the bytes go out by DMA, the coroutine sleeps on an event set by the
+       channel interrupt and only waits on TC for the last byte
+*/
+
+#include <stddef.h>
+#include "usart_async.h"
+#include "arg_checkers.h"
+
+int usart_async_write_init(usart_async_t* op, USART_TypeDef* usartx,
+                           DMA_Channel_TypeDef* tx_chan, const void* buf,
+                           uint32_t len)
+{
+    CHECK_PTR(op, -EINVAL);
+    CHECK_PTR(usartx, -EINVAL);
+    CHECK_PTR(tx_chan, -EINVAL);
+    CHECK_PTR(buf, -EINVAL);
+    // CNDTR is 16 bits wide
+    RETURN_IF(len > 0xFFFF, -EINVAL);
+
+    co_init(&op->co);
+    op->usartx = usartx;
+    op->tx_chan = tx_chan;
+    op->buf = (const uint8_t*) buf;
+    op->len = len;
+    co_event_clear(&op->done);
+    op->status = 0;
+
+    return 0;
+}
+
+static void usart_async_event(void* ctx, uint32_t events)
+{
+    usart_async_t* op = (usart_async_t*) ctx;
+
+    if (0 == (events & (DMA_EVT_TC | DMA_EVT_TE)))
+        return;
+
+    op->tx_chan->CCR = 0;
+    op->status = (events & DMA_EVT_TE) ? -EIO : 0;
+    co_event_signal(&op->done);
+}
+
+int usart_async_write(usart_async_t* op)
+{
+    co_t* co = &op->co;
+    int ret;
+
+    CO_BEGIN(co);
+
+    if (0 == op->len)
+        CO_RETURN(co, CO_DONE);
+
+    // -EBUSY while e.g. a usart_stream owns the channel
+    ret = dma_claim(op->tx_chan, "usart_async", usart_async_event, op);
+    if (0 != ret)
+        CO_RETURN(co, ret);
+
+    co_event_clear(&op->done);
+
+    op->tx_chan->CCR = 0;
+    op->tx_chan->CPAR = (uint32_t) &op->usartx->DR;
+    op->tx_chan->CMAR = (uint32_t) op->buf;
+    op->tx_chan->CNDTR = op->len;
+    // TC is cleared by writing 0, so it is set again by the last byte
+    op->usartx->SR = (uint16_t) ~USART_SR_TC;
+    op->usartx->CR3 |= USART_CR3_DMAT;
+    op->tx_chan->CCR = DMA_DIR_PeripheralDST | DMA_MemoryInc_Enable |
+                       DMA_Priority_Low | DMA_CCR1_TCIE | DMA_CCR1_TEIE |
+                       DMA_CCR1_EN;
+
+    CO_WAIT_EVENT(co, &op->done);
+
+    op->usartx->CR3 &= ~USART_CR3_DMAT;
+    dma_release(op->tx_chan);
+
+    if (op->status < 0)
+        CO_RETURN(co, op->status);
+
+    // the DMA is done once the last byte is in DR, two frames at most
+    CO_WAIT_UNTIL(co, op->usartx->SR & USART_SR_TC);
+
+    CO_END(co);
+}
@@ -0,0 +1,36 @@
+/*
+@file: usart_async.h
+@author: ZZH
+@date: 2026-10-19
+@info: non-blocking usart write for coroutines
+*/
+
+#ifndef __USART_ASYNC_H__
+#define __USART_ASYNC_H__
+
+#include <stdint.h>
+#include "stm32f10x_usart.h"
+#include "hal/dma/dma.h"
+#include "sys/coroutine.h"
+
+typedef struct
+{
+    co_t co;
+    USART_TypeDef* usartx;
+    DMA_Channel_TypeDef* tx_chan;
+    const uint8_t* buf;
+    uint32_t len;
+    // set by the DMA completion, status is its result
+    co_event_t done;
+    int status;
+} usart_async_t;
+
+// tx_chan is the channel of the usart's tx request, e.g. USART2_TX_DMA_CHAN,
+// it is claimed only while the write runs. len is at most 0xFFFF
+int usart_async_write_init(usart_async_t* op, USART_TypeDef* usartx,
+                           DMA_Channel_TypeDef* tx_chan, const void* buf,
+                           uint32_t len);
+// resume the transfer, CO_WAITING until every byte left the shifter
+int usart_async_write(usart_async_t* op);
+
+#endif // __USART_ASYNC_H__
@@ -0,0 +1,282 @@
+/*
+@file: usart_stream.c
+@author: ZZH
+@date: 2026-10-19
+@info: the tx DMA sends the longest contiguous run of the ring, its
+       completion interrupt frees that run and starts the next one
+*/
+
+#include <stddef.h>
+#include <string.h>
+#include "usart_stream.h"
+#include "arg_checkers.h"
+#include "hal/dma/dma.h"
+
+static usart_stream_t* stdio_stream;
+
+// called with interrupts off
+static void stream_kick(usart_stream_t* stream)
+{
+    uint16_t head = stream->tx_head;
+    uint16_t tail = stream->tx_tail;
+
+    if (0 != stream->tx_dma || head == tail)
+        return;
+
+    uint16_t len = head > tail ? head - tail : stream->tx_size - tail;
+
+    stream->tx_dma = len;
+    stream->tx_chan->CCR = 0;
+    stream->tx_chan->CMAR = (uint32_t) &stream->tx_buf[tail];
+    stream->tx_chan->CNDTR = len;
+    stream->tx_chan->CCR = DMA_DIR_PeripheralDST | DMA_MemoryInc_Enable |
+                           DMA_Priority_Low | DMA_CCR1_TCIE | DMA_CCR1_TEIE |
+                           DMA_CCR1_EN;
+}
+
+static void stream_tx_event(void* ctx, uint32_t events)
+{
+    usart_stream_t* stream = (usart_stream_t*) ctx;
+
+    if (0 == (events & (DMA_EVT_TC | DMA_EVT_TE)))
+        return;
+
+    // a transfer error loses the run, there is nothing to retry with
+    stream->tx_chan->CCR = 0;
+    stream->tx_tail = (stream->tx_tail + stream->tx_dma) % stream->tx_size;
+    stream->tx_dma = 0;
+
+    stream_kick(stream);
+#if CONFIG_ENABLE_KERNEL == 1
+    ksem_give(&stream->tx_sem);
+#endif
+}
+
+int usart_stream_init(usart_stream_t* stream, USART_TypeDef* usart,
+                      DMA_Channel_TypeDef* tx_chan, void* tx_buf,
+                      uint32_t tx_size, void* rx_buf, uint32_t rx_size)
+{
+    CHECK_PTR(stream, -EINVAL);
+    CHECK_PTR(usart, -EINVAL);
+    CHECK_PTR(tx_buf, -EINVAL);
+    RETURN_IF(tx_size < 2 || tx_size > UINT16_MAX, -EINVAL);
+    RETURN_IF(NULL != rx_buf && (rx_size < 2 || rx_size > UINT16_MAX),
+              -EINVAL);
+
+    memset(stream, 0, sizeof(*stream));
+    stream->usart = usart;
+    stream->tx_chan = tx_chan;
+    stream->tx_buf = (uint8_t*) tx_buf;
+    stream->tx_size = tx_size;
+    stream->rx_buf = (uint8_t*) rx_buf;
+    stream->rx_size = NULL == rx_buf ? 0 : rx_size;
+#if CONFIG_ENABLE_KERNEL == 1
+    ksem_init(&stream->tx_sem, 0, 1);
+    ksem_init(&stream->rx_sem, 0, 1);
+#endif
+
+    int ret = dma_claim(tx_chan, "usart_stream", stream_tx_event, stream);
+    RETURN_IF_NZERO(ret, ret);
+
+    tx_chan->CPAR = (uint32_t) &usart->DR;
+    usart->CR3 |= USART_CR3_DMAT;
+
+    return 0;
+}
+
+static int stream_can_wait(void)
+{
+    uint32_t primask = kernel_irq_save();
+    kernel_irq_restore(primask);
+
+    return !kernel_in_isr() && 0 == (primask & 1);
+}
+
+// returns once the DMA might have freed a run, the caller checks again
+static void stream_tx_idle(usart_stream_t* stream, uint16_t tail)
+{
+#if CONFIG_ENABLE_KERNEL == 1
+    if (kernel_is_running()) {
+        ksem_take(&stream->tx_sem, KERNEL_WAIT_FOREVER);
+        return;
+    }
+#endif
+
+#if CONFIG_HOST_SIM == 1
+    (void) tail;
+    __asm volatile("nop");
+#else
+    // the DMA completion still ends WFI when it comes after the check
+    uint32_t key = kernel_irq_save();
+    if (tail == stream->tx_tail)
+        __WFI();
+    kernel_irq_restore(key);
+#endif
+}
+
+uint32_t usart_stream_write(usart_stream_t* stream, const void* buf,
+                            uint32_t len)
+{
+    const uint8_t* src = (const uint8_t*) buf;
+    uint32_t done = 0;
+
+    if (NULL == stream || NULL == buf)
+        return 0;
+
+    int can_wait = stream_can_wait();
+
+    while (done < len) {
+        uint32_t key = kernel_irq_save();
+
+        uint16_t head = stream->tx_head;
+        uint16_t tail = stream->tx_tail;
+        // one slot stays empty to tell a full ring from an empty one
+        uint32_t room = (tail + stream->tx_size - head - 1) % stream->tx_size;
+        uint32_t run = stream->tx_size - head;
+
+        if (room > len - done)
+            room = len - done;
+        if (run > room)
+            run = room;
+
+        memcpy(&stream->tx_buf[head], src + done, run);
+        memcpy(stream->tx_buf, src + done + run, room - run);
+        stream->tx_head = (head + room) % stream->tx_size;
+        done += room;
+
+        stream_kick(stream);
+        kernel_irq_restore(key);
+
+        if (done < len) {
+            if (!can_wait) {
+                stream->tx_dropped += len - done;
+                break;
+            }
+
+            // wait for the DMA to free a run
+            while (tail == stream->tx_tail)
+                stream_tx_idle(stream, tail);
+        }
+    }
+
+    return done;
+}
+
+void usart_stream_flush(usart_stream_t* stream)
+{
+    if (NULL == stream || !stream_can_wait())
+        return;
+
+    while (stream->tx_head != stream->tx_tail)
+        __asm volatile("nop");
+
+    while (0 == (stream->usart->SR & USART_SR_TC))
+        __asm volatile("nop");
+}
+
+uint32_t usart_stream_read(usart_stream_t* stream, void* buf, uint32_t len)
+{
+    uint8_t* dst = (uint8_t*) buf;
+    uint32_t done = 0;
+
+    if (NULL == stream || NULL == buf || 0 == stream->rx_size)
+        return 0;
+
+    // single consumer, rx_tail is only written here
+    while (done < len && stream->rx_tail != stream->rx_head) {
+        dst[done++] = stream->rx_buf[stream->rx_tail];
+        stream->rx_tail = (stream->rx_tail + 1) % stream->rx_size;
+    }
+
+    return done;
+}
+
+// returns once something might have arrived, the caller checks again
+static void stream_rx_idle(usart_stream_t* stream)
+{
+#if CONFIG_ENABLE_KERNEL == 1
+    if (kernel_is_running()) {
+        ksem_take(&stream->rx_sem, KERNEL_WAIT_FOREVER);
+        return;
+    }
+#endif
+
+#if CONFIG_HOST_SIM == 1
+    // the simulated interrupts arrive as signals
+    __asm volatile("nop");
+#else
+    // PRIMASK only defers the handler, a byte pushed after the check still
+    // ends WFI
+    uint32_t key = kernel_irq_save();
+    if (stream->rx_tail == stream->rx_head)
+        __WFI();
+    kernel_irq_restore(key);
+#endif
+}
+
+int usart_stream_read_wait(usart_stream_t* stream, void* buf, uint32_t len)
+{
+    CHECK_PTR(stream, -EINVAL);
+    CHECK_PTR(buf, -EINVAL);
+    RETURN_IF(0 == stream->rx_size, -EINVAL);
+
+    if (0 == len)
+        return 0;
+
+    uint32_t done = usart_stream_read(stream, buf, len);
+    if (0 != done)
+        return done;
+
+    if (!stream_can_wait())
+        return -EAGAIN;
+
+    uint32_t key = kernel_irq_save();
+    stream->rx_waiting++;
+    kernel_irq_restore(key);
+
+    while (0 == done) {
+        stream_rx_idle(stream);
+        done = usart_stream_read(stream, buf, len);
+    }
+
+    key = kernel_irq_save();
+    stream->rx_waiting--;
+    kernel_irq_restore(key);
+
+    return done;
+}
+
+void usart_stream_rx_push(usart_stream_t* stream, uint8_t ch)
+{
+    if (NULL == stream || 0 == stream->rx_size)
+        return;
+
+    uint16_t next = (stream->rx_head + 1) % stream->rx_size;
+
+    if (next == stream->rx_tail) {
+        stream->rx_dropped++;
+        return;
+    }
+
+    stream->rx_buf[stream->rx_head] = ch;
+    stream->rx_head = next;
+#if CONFIG_ENABLE_KERNEL == 1
+    // already given when the reader has not woken up yet
+    ksem_give(&stream->rx_sem);
+#endif
+}
+
+int usart_stream_rx_waiting(const usart_stream_t* stream)
+{
+    return NULL != stream && 0 != stream->rx_waiting;
+}
+
+void usart_stream_set_stdio(usart_stream_t* stream)
+{
+    stdio_stream = stream;
+}
+
+usart_stream_t* usart_stream_get_stdio(void)
+{
+    return stdio_stream;
+}
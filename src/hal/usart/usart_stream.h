@@ -0,0 +1,81 @@
+/*
+@file: usart_stream.h
+@author: ZZH
+@date: 2026-10-19
+@info: buffered usart output drained by DMA, buffered input fed by the
+       usart rx interrupt
+*/
+
+#ifndef __USART_STREAM_H__
+#define __USART_STREAM_H__
+
+#include <errno.h>
+#include <stdint.h>
+#include "stm32f10x_usart.h"
+#include "stm32f10x_dma.h"
+#include "kernel/kernel.h"
+
+typedef struct
+{
+    USART_TypeDef* usart;
+    DMA_Channel_TypeDef* tx_chan;
+
+    // tx ring, [tx_tail, tx_tail + tx_dma) is on its way out
+    uint8_t* tx_buf;
+    uint16_t tx_size;
+    volatile uint16_t tx_head;
+    volatile uint16_t tx_tail;
+    volatile uint16_t tx_dma;
+#if CONFIG_ENABLE_KERNEL == 1
+    // given by every finished DMA run, a writer on a full ring sleeps on it
+    ksem_t tx_sem;
+#endif
+
+    uint8_t* rx_buf;
+    uint16_t rx_size;
+    volatile uint16_t rx_head;
+    volatile uint16_t rx_tail;
+    // readers inside usart_stream_read_wait
+    volatile uint8_t rx_waiting;
+#if CONFIG_ENABLE_KERNEL == 1
+    // given by every received byte, usart_stream_read_wait sleeps on it
+    ksem_t rx_sem;
+#endif
+
+    uint32_t tx_dropped;
+    uint32_t rx_dropped;
+} usart_stream_t;
+
+// the usart must already be configured, its TX DMA request gets enabled
+int usart_stream_init(usart_stream_t* stream, USART_TypeDef* usart,
+                      DMA_Channel_TypeDef* tx_chan, void* tx_buf,
+                      uint32_t tx_size, void* rx_buf, uint32_t rx_size);
+
+/*
+ * copy into the tx ring and return, the caller only waits while the ring
+ * is full. with interrupts masked or from an isr a full ring drops the rest
+ * instead. returns the number of bytes queued
+ */
+uint32_t usart_stream_write(usart_stream_t* stream, const void* buf,
+                            uint32_t len);
+// wait until the ring is empty and the last byte left the shifter
+void usart_stream_flush(usart_stream_t* stream);
+
+// non-blocking, returns the number of bytes taken from the rx ring
+uint32_t usart_stream_read(usart_stream_t* stream, void* buf, uint32_t len);
+/*
+ * like usart_stream_read but waits until at least one byte has arrived,
+ * -EAGAIN with interrupts masked or from an isr where nothing could arrive
+ */
+int usart_stream_read_wait(usart_stream_t* stream, void* buf, uint32_t len);
+// called by the usart rx interrupt
+void usart_stream_rx_push(usart_stream_t* stream, uint8_t ch);
+// a reader sleeps in usart_stream_read_wait, an rx interrupt that shares
+// its input with someone else can push only then and leave no stale bytes
+int usart_stream_rx_waiting(const usart_stream_t* stream);
+
+// fd 0, 1 and 2 of newlib, NULL until set
+void usart_stream_set_stdio(usart_stream_t* stream);
+usart_stream_t* usart_stream_get_stdio(void);
+
+#endif // __USART_STREAM_H__
@@ -0,0 +1,395 @@
+/*
+@file: kernel.c
+@author: ZZH
+@date: 2026-10-19
+@info: fixed-priority preemptive scheduler, O(1) ready-bitmap lookup
+*/
+
+#include "kernel_internal.h"
+#include "arg_checkers.h"
+#include "gnu_attributes.h"
+#include "stm32f10x.h"
+
+#define STACK_FILL_PATTERN 0xAAAAAAAA
+
+task_t* volatile kernel_current = NULL;
+task_t* volatile kernel_next = NULL;
+
+// bit (31 - prio) is set when ready_list[prio] is not empty, so the highest
+// ready priority is given by a single CLZ instruction
+static uint32_t ready_bitmap;
+static task_list_t ready_list[KERNEL_PRIO_NUM];
+// sorted by wake_tick, the head expires first
+static task_t* delay_list;
+
+static volatile uint32_t tick_count;
+static volatile uint8_t running;
+
+static task_t idle_task;
+KERNEL_STACK_DEF(idle_stack, CONFIG_KERNEL_IDLE_STACK_SIZE);
+
+static inline int tick_before(uint32_t a, uint32_t b)
+{
+    return (int32_t) (a - b) < 0;
+}
+
+static void list_append(task_list_t* list, task_t* task)
+{
+    task->next = NULL;
+
+    if (NULL == list->tail)
+        list->head = task;
+    else
+        list->tail->next = task;
+
+    list->tail = task;
+}
+
+static void list_remove(task_list_t* list, task_t* task)
+{
+    task_t* prev = NULL;
+
+    for (task_t* iter = list->head; NULL != iter; iter = iter->next) {
+        if (iter == task) {
+            if (NULL == prev)
+                list->head = task->next;
+            else
+                prev->next = task->next;
+
+            if (list->tail == task)
+                list->tail = prev;
+
+            task->next = NULL;
+            return;
+        }
+
+        prev = iter;
+    }
+}
+
+// keep the list sorted by priority, FIFO between equal priorities
+static void list_insert_prio(task_list_t* list, task_t* task)
+{
+    task_t* prev = NULL;
+    task_t* iter = list->head;
+
+    while (NULL != iter && iter->prio <= task->prio) {
+        prev = iter;
+        iter = iter->next;
+    }
+
+    task->next = iter;
+
+    if (NULL == prev)
+        list->head = task;
+    else
+        prev->next = task;
+
+    if (NULL == iter)
+        list->tail = task;
+}
+
+static void delay_insert(task_t* task)
+{
+    task_t** link = &delay_list;
+
+    while (NULL != *link && !tick_before(task->wake_tick, (*link)->wake_tick))
+        link = &(*link)->dnext;
+
+    task->dnext = *link;
+    *link = task;
+    task->on_delay = 1;
+}
+
+static void delay_remove(task_t* task)
+{
+    for (task_t** link = &delay_list; NULL != *link; link = &(*link)->dnext) {
+        if (*link == task) {
+            *link = task->dnext;
+            break;
+        }
+    }
+
+    task->dnext = NULL;
+    task->on_delay = 0;
+}
+
+void k_ready_insert(task_t* task)
+{
+    task->state = TASK_READY;
+    list_append(&ready_list[task->prio], task);
+    ready_bitmap |= 0x80000000u >> task->prio;
+}
+
+void k_ready_remove(task_t* task)
+{
+    task_list_t* list = &ready_list[task->prio];
+
+    list_remove(list, task);
+
+    if (k_list_empty(list))
+        ready_bitmap &= ~(0x80000000u >> task->prio);
+}
+
+void k_block_current(task_list_t* wait_list, uint32_t timeout)
+{
+    task_t* self = kernel_current;
+
+    k_ready_remove(self);
+
+    self->state = TASK_BLOCKED;
+    self->timed_out = 0;
+    self->wait_on = wait_list;
+    list_insert_prio(wait_list, self);
+
+    if (KERNEL_WAIT_FOREVER != timeout) {
+        self->wake_tick = tick_count + timeout;
+        delay_insert(self);
+    }
+
+    k_schedule();
+}
+
+task_t* k_wake_one(task_list_t* wait_list)
+{
+    task_t* task = wait_list->head;
+
+    if (NULL == task)
+        return NULL;
+
+    list_remove(wait_list, task);
+    task->wait_on = NULL;
+
+    if (task->on_delay)
+        delay_remove(task);
+
+    k_ready_insert(task);
+
+    return task;
+}
+
+void k_schedule(void)
+{
+    if (0 == running)
+        return;
+
+    // the idle task is always ready, so the bitmap is never empty
+    uint32_t prio = (uint32_t) __builtin_clz(ready_bitmap);
+    task_t* next = ready_list[prio].head;
+
+    kernel_next = next;
+
+    if (next != kernel_current) {
+        SCB->ICSR = SCB_ICSR_PENDSVSET_Msk;
+        __DSB();
+        __ISB();
+    }
+}
+
+GNU_WEAK void kernel_idle_hook(void)
+{
+    __WFI();
+}
+
+static void idle_entry(void* arg)
+{
+    (void) arg;
+
+    while (1) kernel_idle_hook();
+}
+
+int kernel_init(void)
+{
+    ready_bitmap = 0;
+    delay_list = NULL;
+    tick_count = 0;
+    running = 0;
+
+    for (uint32_t i = 0; i < KERNEL_PRIO_NUM; i++)
+        ready_list[i].head = ready_list[i].tail = NULL;
+
+    return task_create(&idle_task, "idle", idle_entry, NULL, KERNEL_PRIO_IDLE,
+                       idle_stack, sizeof(idle_stack));
+}
+
+void kernel_start(void)
+{
+    kernel_irq_save();
+
+    timebase_init();
+
+    running = 1;
+    kernel_current = NULL;
+
+    k_port_start();
+    k_schedule();
+
+    // the pending PendSV switches to the first task and never comes back
+    kernel_irq_restore(0);
+
+    while (1) asm volatile("bkpt");
+}
+
+uint32_t kernel_ticks_to_next_wake(void)
+{
+    uint32_t key = kernel_irq_save();
+    uint32_t ticks = UINT32_MAX;
+
+    if (NULL != delay_list) {
+        ticks = delay_list->wake_tick - tick_count;
+
+        if ((int32_t) ticks < 0)
+            ticks = 0;
+    }
+
+    kernel_irq_restore(key);
+
+    return ticks;
+}
+
+int kernel_is_running(void)
+{
+    return running;
+}
+
+uint32_t kernel_get_ticks(void)
+{
+    return tick_count;
+}
+
+void kernel_tick(void)
+{
+    kernel_tick_step(1);
+}
+
+void kernel_tick_step(uint32_t ticks)
+{
+    uint32_t key = kernel_irq_save();
+
+    tick_count += ticks;
+
+    while (NULL != delay_list && !tick_before(tick_count, delay_list->wake_tick)) {
+        task_t* task = delay_list;
+
+        delay_remove(task);
+
+        if (TASK_BLOCKED == task->state) {
+            list_remove(task->wait_on, task);
+            task->wait_on = NULL;
+            task->timed_out = 1;
+        }
+
+        k_ready_insert(task);
+    }
+
+    // round-robin between tasks sharing the running priority
+    task_t* self = kernel_current;
+
+    if (NULL != self && TASK_READY == self->state && NULL != self->next) {
+        task_list_t* list = &ready_list[self->prio];
+
+        if (list->head == self) {
+            list->head = self->next;
+            list_append(list, self);
+        }
+    }
+
+    k_schedule();
+    kernel_irq_restore(key);
+}
+
+int task_create(task_t* task, const char* name, task_entry_t entry, void* arg,
+                uint8_t prio, void* stack, uint32_t stack_size)
+{
+    CHECK_PTR(task, -EINVAL);
+    CHECK_PTR(entry, -EINVAL);
+    CHECK_PTR(stack, -EINVAL);
+    RETURN_IF(prio >= KERNEL_PRIO_NUM, -EINVAL);
+    RETURN_IF(stack_size < 128, -EINVAL);
+
+    uint32_t* stack_words = (uint32_t*) stack;
+
+    for (uint32_t i = 0; i < stack_size / 4; i++)
+        stack_words[i] = STACK_FILL_PATTERN;
+
+    task->name = name;
+    task->stack_base = stack_words;
+    task->stack_size = stack_size;
+    task->prio = prio;
+    task->next = NULL;
+    task->dnext = NULL;
+    task->wait_on = NULL;
+    task->on_delay = 0;
+    task->timed_out = 0;
+
+    k_port_init_stack(task, entry, arg);
+
+    uint32_t key = kernel_irq_save();
+    k_ready_insert(task);
+    k_schedule();
+    kernel_irq_restore(key);
+
+    return 0;
+}
+
+task_t* task_self(void)
+{
+    return kernel_current;
+}
+
+void task_yield(void)
+{
+    uint32_t key = kernel_irq_save();
+    task_t* self = kernel_current;
+
+    k_ready_remove(self);
+    k_ready_insert(self);
+    k_schedule();
+
+    kernel_irq_restore(key);
+}
+
+void task_delay(uint32_t ticks)
+{
+    if (0 == ticks) {
+        task_yield();
+        return;
+    }
+
+    uint32_t key = kernel_irq_save();
+    task_t* self = kernel_current;
+
+    k_ready_remove(self);
+    self->state = TASK_DELAYED;
+    self->wake_tick = tick_count + ticks;
+    delay_insert(self);
+    k_schedule();
+
+    kernel_irq_restore(key);
+}
+
+void task_exit(void)
+{
+    kernel_irq_save();
+
+    task_t* self = kernel_current;
+
+    k_ready_remove(self);
+    self->state = TASK_DEAD;
+    k_schedule();
+
+    kernel_irq_restore(0);
+
+    while (1) asm volatile("bkpt");
+}
+
+uint32_t task_stack_unused(const task_t* task)
+{
+    uint32_t words = task->stack_size / 4;
+    uint32_t unused = 0;
+
+    while (unused < words && STACK_FILL_PATTERN == task->stack_base[unused])
+        unused++;
+
+    return unused * 4;
+}
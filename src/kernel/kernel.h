@@ -0,0 +1,172 @@
+/*
+@file: kernel.h
+@author: ZZH
+@date: 2026-10-19
+@info: minimal fixed-priority preemptive kernel
+*/
+
+#ifndef __KERNEL_H__
+#define __KERNEL_H__
+
+#include <errno.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "sys/timebase.h"
+
+#ifndef CONFIG_KERNEL_IDLE_STACK_SIZE
+#define CONFIG_KERNEL_IDLE_STACK_SIZE 256
+#endif
+
+// priority 0 is the highest, KERNEL_PRIO_IDLE is reserved for the idle task
+#define KERNEL_PRIO_NUM     32
+#define KERNEL_PRIO_IDLE    (KERNEL_PRIO_NUM - 1)
+
+#define KERNEL_NO_WAIT      0
+#define KERNEL_WAIT_FOREVER UINT32_MAX
+
+// the kernel ticks with the system time base
+#define KERNEL_MS_TO_TICKS(ms) TIMEBASE_MS_TO_TICKS(ms)
+
+// declare a task stack with the alignment required by the AAPCS
+#define KERNEL_STACK_DEF(name, size) \
+    static uint64_t name[((size) + 7) / 8]
+
+typedef void (*task_entry_t)(void* arg);
+
+typedef enum {
+    TASK_READY = 0,
+    TASK_BLOCKED,
+    TASK_DELAYED,
+    TASK_DEAD,
+} task_state_t;
+
+typedef struct task task_t;
+
+typedef struct
+{
+    task_t* head;
+    task_t* tail;
+} task_list_t;
+
+struct task
+{
+    // saved process stack pointer, must be the first member (used by PendSV)
+    uint32_t* sp;
+
+    // ready list or wait list link
+    task_t* next;
+    // delay list link
+    task_t* dnext;
+    task_list_t* wait_on;
+
+    const char* name;
+    uint32_t* stack_base;
+    uint32_t stack_size;
+    uint32_t wake_tick;
+    uint8_t prio;
+    uint8_t state;
+    // non-zero while the task is linked into the delay list
+    uint8_t on_delay;
+    // non-zero if the task was woken by a timeout instead of an event
+    uint8_t timed_out;
+};
+
+typedef struct
+{
+    uint32_t count;
+    uint32_t max_count;
+    task_list_t waiters;
+} ksem_t;
+
+typedef struct
+{
+    uint8_t* buf;
+    uint32_t item_size;
+    uint32_t capacity;
+    uint32_t count;
+    uint32_t head;
+    uint32_t tail;
+    task_list_t send_waiters;
+    task_list_t recv_waiters;
+} kqueue_t;
+
+int kernel_init(void);
+void kernel_start(void) __attribute__((__noreturn__));
+int kernel_is_running(void);
+void kernel_tick(void);
+// account for several ticks at once, used when ticks were suppressed
+void kernel_tick_step(uint32_t ticks);
+uint32_t kernel_ticks_to_next_wake(void);
+uint32_t kernel_get_ticks(void);
+
+// called from the idle task forever, default implementation sleeps in WFI
+void kernel_idle_hook(void);
+
+int task_create(task_t* task, const char* name, task_entry_t entry, void* arg,
+                uint8_t prio, void* stack, uint32_t stack_size);
+task_t* task_self(void);
+void task_yield(void);
+void task_delay(uint32_t ticks);
+void task_exit(void) __attribute__((__noreturn__));
+uint32_t task_stack_unused(const task_t* task);
+
+int ksem_init(ksem_t* sem, uint32_t init_count, uint32_t max_count);
+int ksem_take(ksem_t* sem, uint32_t timeout);
+// safe from interrupt context
+int ksem_give(ksem_t* sem);
+
+int kqueue_init(kqueue_t* queue, void* buf, uint32_t item_size,
+                uint32_t capacity);
+// timeout must be KERNEL_NO_WAIT when called from interrupt context
+int kqueue_send(kqueue_t* queue, const void* item, uint32_t timeout);
+int kqueue_recv(kqueue_t* queue, void* item, uint32_t timeout);
+
+static inline uint32_t kqueue_count(const kqueue_t* queue)
+{
+    return queue->count;
+}
+
+#if CONFIG_HOST_SIM == 1
+#include "sim/sim_cpu.h"
+
+// the host build masks the simulated interrupts instead of PRIMASK
+static inline uint32_t kernel_irq_save(void)
+{
+    return sim_irq_save();
+}
+
+static inline void kernel_irq_restore(uint32_t primask)
+{
+    sim_irq_restore(primask);
+}
+
+static inline int kernel_in_isr(void)
+{
+    return 0 != sim_in_isr;
+}
+#else
+static inline uint32_t kernel_irq_save(void)
+{
+    uint32_t primask;
+
+    __asm volatile("mrs %0, primask\n\tcpsid i" : "=r"(primask)::"memory");
+
+    return primask;
+}
+
+static inline void kernel_irq_restore(uint32_t primask)
+{
+    __asm volatile("msr primask, %0" ::"r"(primask) : "memory");
+}
+
+static inline int kernel_in_isr(void)
+{
+    uint32_t ipsr;
+
+    __asm volatile("mrs %0, ipsr" : "=r"(ipsr));
+
+    return 0 != ipsr;
+}
+#endif
+
+#endif // __KERNEL_H__
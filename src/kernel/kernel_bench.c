@@ -0,0 +1,143 @@
+/*
+@file: kernel_bench.c
+@author: ZZH
+@date: 2026-10-19
+@info: context switch benchmarks, timed by the SysTick based time base so
+       they also run on QEMU's Cortex-M3 machines (no DWT cycle counter)
+*/
+
+#include "kernel.h"
+#include "stm32f10x.h"
+#include "tiny_console/tiny_console.h"
+#include "tiny_console/tiny_console_cmd.h"
+
+#if CONFIG_ENABLE_KERNEL == 1
+
+#define BENCH_ROUNDS     1000
+#define BENCH_STACK_SIZE 512
+// both bench tasks must preempt the console task that starts them
+#define BENCH_PRIO_HIGH  2
+#define BENCH_PRIO_LOW   3
+
+typedef struct
+{
+    ksem_t ping;
+    ksem_t done;
+    kqueue_t queue;
+    uint32_t queue_buf[4];
+    uint32_t start;
+    uint32_t cycles;
+} bench_ctx_t;
+
+static bench_ctx_t ctx;
+static task_t bench_task[2];
+KERNEL_STACK_DEF(bench_stack0, BENCH_STACK_SIZE);
+KERNEL_STACK_DEF(bench_stack1, BENCH_STACK_SIZE);
+
+static inline uint32_t bench_cycles(void)
+{
+    return (uint32_t) timebase_get_cycles();
+}
+
+static void sem_waiter(void* arg)
+{
+    (void) arg;
+
+    for (int i = 0; i < BENCH_ROUNDS; i++)
+        ksem_take(&ctx.ping, KERNEL_WAIT_FOREVER);
+}
+
+// every give wakes the higher priority waiter: one switch to it, one back
+static void sem_giver(void* arg)
+{
+    (void) arg;
+
+    ctx.start = bench_cycles();
+
+    for (int i = 0; i < BENCH_ROUNDS; i++) ksem_give(&ctx.ping);
+
+    ctx.cycles = bench_cycles() - ctx.start;
+    ksem_give(&ctx.done);
+}
+
+static void yielder(void* arg)
+{
+    for (int i = 0; i < BENCH_ROUNDS; i++) task_yield();
+
+    if (NULL != arg) {
+        ctx.cycles = bench_cycles() - ctx.start;
+        ksem_give(&ctx.done);
+    }
+}
+
+static void queue_reader(void* arg)
+{
+    (void) arg;
+    uint32_t value;
+
+    for (int i = 0; i < BENCH_ROUNDS; i++)
+        kqueue_recv(&ctx.queue, &value, KERNEL_WAIT_FOREVER);
+}
+
+static void queue_writer(void* arg)
+{
+    (void) arg;
+
+    ctx.start = bench_cycles();
+
+    for (uint32_t i = 0; i < BENCH_ROUNDS; i++)
+        kqueue_send(&ctx.queue, &i, KERNEL_WAIT_FOREVER);
+
+    ctx.cycles = bench_cycles() - ctx.start;
+    ksem_give(&ctx.done);
+}
+
+static uint32_t bench_run(task_entry_t high, task_entry_t low, uint8_t prio_high,
+                          uint8_t prio_low)
+{
+    ksem_init(&ctx.ping, 0, BENCH_ROUNDS);
+    ksem_init(&ctx.done, 0, 1);
+    kqueue_init(&ctx.queue, ctx.queue_buf, sizeof(uint32_t),
+                sizeof(ctx.queue_buf) / sizeof(uint32_t));
+
+    // hold the switch until both tasks exist
+    uint32_t key = kernel_irq_save();
+
+    ctx.start = bench_cycles();
+    task_create(&bench_task[0], "bench0", high, NULL, prio_high, bench_stack0,
+                sizeof(bench_stack0));
+    task_create(&bench_task[1], "bench1", low, &ctx, prio_low, bench_stack1,
+                sizeof(bench_stack1));
+
+    kernel_irq_restore(key);
+
+    ksem_take(&ctx.done, KERNEL_WAIT_FOREVER);
+
+    // two context switches per round
+    return ctx.cycles / (BENCH_ROUNDS * 2);
+}
+
+CONSOLE_CMD_DEF(kernel_bench)
+{
+    CONSOLE_CMD_UNUSE_ARGS;
+
+    uint32_t sem = bench_run(sem_waiter, sem_giver, BENCH_PRIO_HIGH,
+                             BENCH_PRIO_LOW);
+    uint32_t yield = bench_run(yielder, yielder, BENCH_PRIO_HIGH,
+                               BENCH_PRIO_HIGH);
+    uint32_t queue = bench_run(queue_reader, queue_writer, BENCH_PRIO_HIGH,
+                               BENCH_PRIO_LOW);
+
+    console_println(this, "core clock: %lu Hz, %d rounds", SystemCoreClock,
+                    BENCH_ROUNDS);
+    console_println(this, "sem give/take switch: %lu cycles", sem);
+    console_println(this, "yield switch: %lu cycles", yield);
+    console_println(this, "queue send/recv switch: %lu cycles", queue);
+
+    return 0;
+}
+
+EXPORT_CONSOLE_CMD("kbench", kernel_bench, "kernel context switch benchmark",
+                   NULL);
+
+#endif
@@ -0,0 +1,36 @@
+/*
+@file: kernel_internal.h
+@author: ZZH
+@date: 2026-10-19
+@info: scheduler internals shared by the kernel objects, all functions here
+       must be called with interrupts disabled
+*/
+
+#ifndef __KERNEL_INTERNAL_H__
+#define __KERNEL_INTERNAL_H__
+
+#include "kernel.h"
+
+extern task_t* volatile kernel_current;
+extern task_t* volatile kernel_next;
+
+void k_ready_insert(task_t* task);
+void k_ready_remove(task_t* task);
+
+// block the running task on wait_list, KERNEL_WAIT_FOREVER disables timeout
+void k_block_current(task_list_t* wait_list, uint32_t timeout);
+// wake up the highest priority waiter, return NULL if nobody is waiting
+task_t* k_wake_one(task_list_t* wait_list);
+
+// pick the highest priority ready task and pend a PendSV if it changed
+void k_schedule(void);
+
+void k_port_init_stack(task_t* task, task_entry_t entry, void* arg);
+void k_port_start(void);
+
+static inline int k_list_empty(const task_list_t* list)
+{
+    return NULL == list->head;
+}
+
+#endif // __KERNEL_INTERNAL_H__
@@ -0,0 +1,67 @@
+/*
+@file: kernel_port.c
+@author: ZZH
+@date: 2026-10-19
+@info: Cortex-M3 port, PendSV context switch
+*/
+
+#include "kernel_internal.h"
+#include "stm32f10x.h"
+
+#define INITIAL_XPSR 0x01000000
+
+void k_port_init_stack(task_t* task, task_entry_t entry, void* arg)
+{
+    uint32_t top = (uint32_t) task->stack_base + task->stack_size;
+    // AAPCS requires the stack to be 8 bytes aligned at public interfaces
+    uint32_t* sp = (uint32_t*) (top & ~0x7u);
+
+    // hardware frame, unstacked by the exception return
+    *--sp = INITIAL_XPSR;
+    *--sp = (uint32_t) entry & ~0x1u; // pc
+    *--sp = (uint32_t) task_exit;     // lr
+    *--sp = 0;                        // r12
+    *--sp = 0;                        // r3
+    *--sp = 0;                        // r2
+    *--sp = 0;                        // r1
+    *--sp = (uint32_t) arg;           // r0
+
+    // software frame, r4 - r11
+    for (int i = 0; i < 8; i++) *--sp = 0;
+
+    task->sp = sp;
+}
+
+void k_port_start(void)
+{
+    // lowest priority, so a context switch never preempts another handler
+    NVIC_SetPriority(PendSV_IRQn, (1 << __NVIC_PRIO_BITS) - 1);
+}
+
+/*
+ * save r4-r11 of the current task on its PSP, switch kernel_current to
+ * kernel_next and restore the new task's context. kernel_current is NULL
+ * for the very first switch, which is issued while still running on MSP.
+ */
+__attribute__((__naked__)) void PendSV_Handler(void)
+{
+    __asm volatile(
+        "cpsid i                    \n"
+        "ldr r3, =kernel_current    \n"
+        "ldr r2, [r3]               \n"
+        "cbz r2, 1f                 \n"
+        "mrs r0, psp                \n"
+        "stmdb r0!, {r4-r11}        \n"
+        "str r0, [r2]               \n"
+        "1:                         \n"
+        "ldr r1, =kernel_next       \n"
+        "ldr r2, [r1]               \n"
+        "str r2, [r3]               \n"
+        "ldr r0, [r2]               \n"
+        "ldmia r0!, {r4-r11}        \n"
+        "msr psp, r0                \n"
+        "ldr lr, =0xFFFFFFFD        \n" // EXC_RETURN: thread mode, PSP
+        "cpsie i                    \n"
+        "bx lr                      \n"
+        ".ltorg                     \n");
+}
@@ -0,0 +1,131 @@
+/*
+@file: kqueue.c
+@author: ZZH
+@date: 2026-10-19
+@info: fixed item size message queue
+*/
+
+#include <string.h>
+#include "kernel_internal.h"
+#include "arg_checkers.h"
+
+typedef enum {
+    QUEUE_SEND,
+    QUEUE_RECV,
+} queue_op_t;
+
+int kqueue_init(kqueue_t* queue, void* buf, uint32_t item_size,
+                uint32_t capacity)
+{
+    CHECK_PTR(queue, -EINVAL);
+    CHECK_PTR(buf, -EINVAL);
+    RETURN_IF(0 == item_size || 0 == capacity, -EINVAL);
+
+    queue->buf = (uint8_t*) buf;
+    queue->item_size = item_size;
+    queue->capacity = capacity;
+    queue->count = 0;
+    queue->head = 0;
+    queue->tail = 0;
+    queue->send_waiters.head = queue->send_waiters.tail = NULL;
+    queue->recv_waiters.head = queue->recv_waiters.tail = NULL;
+
+    return 0;
+}
+
+static void queue_push(kqueue_t* queue, const void* item)
+{
+    memcpy(queue->buf + queue->tail * queue->item_size, item,
+           queue->item_size);
+
+    if (++queue->tail == queue->capacity)
+        queue->tail = 0;
+
+    queue->count++;
+}
+
+static void queue_pop(kqueue_t* queue, void* item)
+{
+    memcpy(item, queue->buf + queue->head * queue->item_size,
+           queue->item_size);
+
+    if (++queue->head == queue->capacity)
+        queue->head = 0;
+
+    queue->count--;
+}
+
+static int queue_transfer(kqueue_t* queue, void* item, uint32_t timeout,
+                          queue_op_t op)
+{
+    CHECK_PTR(queue, -EINVAL);
+    CHECK_PTR(item, -EINVAL);
+
+    uint32_t deadline = kernel_get_ticks() + timeout;
+
+    while (1) {
+        uint32_t key = kernel_irq_save();
+
+        if (QUEUE_SEND == op && queue->count < queue->capacity) {
+            queue_push(queue, item);
+
+            if (NULL != k_wake_one(&queue->recv_waiters))
+                k_schedule();
+
+            kernel_irq_restore(key);
+            return 0;
+        }
+
+        if (QUEUE_RECV == op && queue->count > 0) {
+            queue_pop(queue, item);
+
+            if (NULL != k_wake_one(&queue->send_waiters))
+                k_schedule();
+
+            kernel_irq_restore(key);
+            return 0;
+        }
+
+        if (KERNEL_NO_WAIT == timeout) {
+            kernel_irq_restore(key);
+            return -EAGAIN;
+        }
+
+        if (!kernel_is_running() || kernel_in_isr()) {
+            kernel_irq_restore(key);
+            return -EPERM;
+        }
+
+        uint32_t wait = timeout;
+
+        if (KERNEL_WAIT_FOREVER != timeout) {
+            wait = deadline - kernel_get_ticks();
+
+            if ((int32_t) wait <= 0) {
+                kernel_irq_restore(key);
+                return -ETIMEDOUT;
+            }
+        }
+
+        k_block_current(QUEUE_SEND == op ? &queue->send_waiters
+                                         : &queue->recv_waiters,
+                        wait);
+        kernel_irq_restore(key);
+
+        if (kernel_current->timed_out)
+            return -ETIMEDOUT;
+
+        // woken up by the other side, the slot may be taken again by a
+        // higher priority task before we run, so retry
+    }
+}
+
+int kqueue_send(kqueue_t* queue, const void* item, uint32_t timeout)
+{
+    return queue_transfer(queue, (void*) item, timeout, QUEUE_SEND);
+}
+
+int kqueue_recv(kqueue_t* queue, void* item, uint32_t timeout)
+{
+    return queue_transfer(queue, item, timeout, QUEUE_RECV);
+}
@@ -0,0 +1,70 @@
+/*
+@file: ksem.c
+@author: ZZH
+@date: 2026-10-19
+@info: counting semaphore
+*/
+
+#include "kernel_internal.h"
+#include "arg_checkers.h"
+
+int ksem_init(ksem_t* sem, uint32_t init_count, uint32_t max_count)
+{
+    CHECK_PTR(sem, -EINVAL);
+    RETURN_IF(0 == max_count || init_count > max_count, -EINVAL);
+
+    sem->count = init_count;
+    sem->max_count = max_count;
+    sem->waiters.head = sem->waiters.tail = NULL;
+
+    return 0;
+}
+
+int ksem_take(ksem_t* sem, uint32_t timeout)
+{
+    CHECK_PTR(sem, -EINVAL);
+
+    uint32_t key = kernel_irq_save();
+
+    if (sem->count > 0) {
+        sem->count--;
+        kernel_irq_restore(key);
+        return 0;
+    }
+
+    if (KERNEL_NO_WAIT == timeout) {
+        kernel_irq_restore(key);
+        return -EAGAIN;
+    }
+
+    if (!kernel_is_running() || kernel_in_isr()) {
+        kernel_irq_restore(key);
+        return -EPERM;
+    }
+
+    k_block_current(&sem->waiters, timeout);
+    // the context switch happens as soon as interrupts are enabled again
+    kernel_irq_restore(key);
+
+    // a giver hands the count over directly, nothing left to decrement
+    return kernel_current->timed_out ? -ETIMEDOUT : 0;
+}
+
+int ksem_give(ksem_t* sem)
+{
+    CHECK_PTR(sem, -EINVAL);
+
+    int ret = 0;
+    uint32_t key = kernel_irq_save();
+
+    if (NULL != k_wake_one(&sem->waiters))
+        k_schedule();
+    else if (sem->count < sem->max_count)
+        sem->count++;
+    else
+        ret = -EOVERFLOW;
+
+    kernel_irq_restore(key);
+
+    return ret;
+}
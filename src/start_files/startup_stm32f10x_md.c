@@ -134,7 +134,7 @@ __attribute__((__weak__, __noreturn__)) void Reset_Handler(void)
     volatile uint32_t* sbss = __sbss;
     volatile uint32_t* ebss = __ebss;
 
-    // clear .bss section
+    // clear .bss section, .noinit lies behind it and keeps its contents
     for (; sbss < ebss; sbss++) *sbss = 0;
 
     SystemInit();
@@ -2,6 +2,11 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <sys/types.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "linker_tools.h"
+#include "hal/usart/usart_stream.h"
+#include "sys/semihost.h"
 
 #define UNUSED_PARAM \
     (void) fd;       \
@@ -20,15 +25,103 @@ int sys_io_handler(int fd, char *buffer, int size)
 
 IO_IMP(_open);
 IO_IMP(_close);
-IO_IMP(_write);
-IO_IMP(_read);
 
+#if CONFIG_SEMIHOSTING != 1
 IO_IMP(_exit);
+#endif
 IO_IMP(_getpid);
-IO_IMP(_sbrk);
 IO_IMP(_kill);
 
-IO_IMP(_isatty);
-IO_IMP(_fstat);
 IO_IMP(_lseek);
 
+LINKER_SYMBOL8(__sheap);
+LINKER_SYMBOL8(__eheap);
+
+// the heap region is laid out by the linker script, it never meets the
+// stack which sits at the bottom of RAM
+void* _sbrk(ptrdiff_t incr)
+{
+    static uint8_t* brk = __sheap;
+    uint8_t* prev = brk;
+
+    if (incr > __eheap - brk || incr < __sheap - brk) {
+        errno = ENOMEM;
+        return (void*) -1;
+    }
+
+    brk += incr;
+
+    return prev;
+}
+
+// fd 0, 1 and 2 all go to the console stream
+static usart_stream_t* stdio_for(int fd)
+{
+    return fd >= 0 && fd <= 2 ? usart_stream_get_stdio() : NULL;
+}
+
+int _write(int fd, char *buffer, int size)
+{
+    usart_stream_t* stream = stdio_for(fd);
+
+    if (NULL == stream || 0 == fd) {
+        errno = EBADF;
+        return -1;
+    }
+
+#if CONFIG_SEMIHOSTING == 1
+    // the QEMU image prints to the stdout of the host
+    return semihost_write(buffer, size);
+#else
+    return usart_stream_write(stream, buffer, size);
+#endif
+}
+
+// waits for at least one byte, newlib takes 0 for the end of the file
+int _read(int fd, char *buffer, int size)
+{
+    usart_stream_t* stream = stdio_for(fd);
+
+    if (NULL == stream || 0 != fd) {
+        errno = EBADF;
+        return -1;
+    }
+
+    int ret = usart_stream_read_wait(stream, buffer, size);
+    if (ret < 0) {
+        errno = -ret;
+        return -1;
+    }
+
+    return ret;
+}
+
+int _isatty(int fd)
+{
+    if (NULL == stdio_for(fd)) {
+        errno = EBADF;
+        return 0;
+    }
+
+    return 1;
+}
+
+// a character device makes newlib line buffer stdout
+int _fstat(int fd, struct stat *st)
+{
+    if (NULL == stdio_for(fd)) {
+        errno = EBADF;
+        return -1;
+    }
+
+    st->st_mode = S_IFCHR;
+
+    return 0;
+}
+
+#if CONFIG_SEMIHOSTING == 1
+void _exit(int status)
+{
+    semihost_exit(status);
+}
+#endif
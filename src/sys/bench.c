@@ -0,0 +1,202 @@
+/*
+@file: bench.c
+@author: ZZH
+@date: 2026-10-19
+@info: runner of the .bench.* cases, QEMU reads the DWT as zero and the host
+       build has no DWT at all, both fall back to the SysTick time base
+*/
+
+#include <stddef.h>
+#include <string.h>
+#include "bench.h"
+#include "stm32f10x.h"
+#include "linker_tools.h"
+#include "sys/timebase.h"
+#include "kernel/kernel.h"
+#include "tiny_console/tiny_console.h"
+#include "tiny_console/tiny_console_cmd.h"
+
+// CMSIS 1.30 has no DWT description
+#define DWT_CTRL             (*(volatile uint32_t*) 0xE0001000)
+#define DWT_CYCCNT           (*(volatile uint32_t*) 0xE0001004)
+#define DWT_CTRL_CYCCNTENA   0x1U
+
+LINKER_SYMBOL32(__sbench);
+LINKER_SYMBOL32(__ebench);
+
+static uint8_t counter_ready;
+static uint8_t use_dwt;
+static uint32_t overhead;
+static uint32_t samples[CONFIG_BENCH_MAX_REPS];
+
+int bench_counter_init(void)
+{
+    if (counter_ready)
+        return use_dwt;
+
+#if CONFIG_HOST_SIM != 1
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT_CYCCNT = 0;
+    DWT_CTRL |= DWT_CTRL_CYCCNTENA;
+
+    uint32_t first = DWT_CYCCNT;
+    __NOP();
+    __NOP();
+    __NOP();
+    __NOP();
+    use_dwt = DWT_CYCCNT != first;
+#endif
+
+    timebase_init();
+    counter_ready = 1;
+
+    return use_dwt;
+}
+
+uint32_t bench_counter_read(void)
+{
+#if CONFIG_HOST_SIM != 1
+    if (use_dwt)
+        return DWT_CYCCNT;
+#endif
+
+    return (uint32_t) timebase_get_cycles();
+}
+
+static void bench_empty(const void* arg)
+{
+    (void) arg;
+}
+
+static uint32_t bench_sample(const bench_case_t* bc)
+{
+    uint32_t key = 0;
+
+    if (bc->flags & BENCH_IRQ_OFF)
+        key = kernel_irq_save();
+
+    uint32_t start = bench_counter_read();
+    bc->run(bc->arg);
+    uint32_t cycles = bench_counter_read() - start;
+
+    if (bc->flags & BENCH_IRQ_OFF)
+        kernel_irq_restore(key);
+
+    return cycles;
+}
+
+uint32_t bench_overhead(void)
+{
+    static const bench_case_t empty = {
+        .name = "empty",
+        .run = bench_empty,
+        .flags = BENCH_IRQ_OFF,
+    };
+
+    if (0 != overhead)
+        return overhead;
+
+    bench_counter_init();
+
+    // the smallest sample, an interrupt only ever adds to it
+    uint32_t min = UINT32_MAX;
+    for (uint32_t i = 0; i < CONFIG_BENCH_MAX_REPS; i++) {
+        uint32_t cycles = bench_sample(&empty);
+
+        if (cycles < min)
+            min = cycles;
+    }
+
+    overhead = min;
+
+    return overhead;
+}
+
+static void bench_sort(uint32_t* buf, uint32_t num)
+{
+    for (uint32_t i = 1; i < num; i++) {
+        uint32_t val = buf[i];
+        uint32_t j = i;
+
+        for (; j > 0 && buf[j - 1] > val; j--) buf[j] = buf[j - 1];
+        buf[j] = val;
+    }
+}
+
+int bench_case_run(const bench_case_t* bc, bench_res_t* res)
+{
+    if (NULL == bc || NULL == bc->run || NULL == res)
+        return -EINVAL;
+
+    uint32_t reps = 0 == bc->reps ? CONFIG_BENCH_DEFAULT_REPS : bc->reps;
+    if (reps > CONFIG_BENCH_MAX_REPS)
+        reps = CONFIG_BENCH_MAX_REPS;
+
+    uint32_t empty = bench_overhead();
+
+    if (NULL != bc->setup) {
+        int ret = bc->setup(bc->arg);
+        if (ret < 0 || BENCH_SKIP == ret)
+            return ret;
+    }
+
+    // fills the flash prefetch buffer and runs lazy initialization
+    for (uint32_t i = 0; i < bc->warmup || 0 == i; i++) bc->run(bc->arg);
+
+    for (uint32_t i = 0; i < reps; i++) {
+        uint32_t cycles = bench_sample(bc);
+
+        samples[i] = cycles > empty ? cycles - empty : 0;
+    }
+
+    if (NULL != bc->teardown)
+        bc->teardown(bc->arg);
+
+    bench_sort(samples, reps);
+
+    res->reps = reps;
+    res->min = samples[0];
+    res->med = samples[reps / 2];
+    res->max = samples[reps - 1];
+
+    return 0;
+}
+
+// one key=value record per line, read back by tools/qemu_run.py
+CONSOLE_CMD_DEF(bench_cmd)
+{
+    const char* filter = argc > 0 ? argv[0].str : NULL;
+    const bench_case_t* start = (const bench_case_t*) __sbench;
+    const bench_case_t* end = (const bench_case_t*) __ebench;
+    int dwt = bench_counter_init();
+
+    console_println(this, "bench: counter=%s hz=%lu overhead=%lu",
+                    dwt ? "dwt" : "systick", SystemCoreClock,
+                    bench_overhead());
+
+    for (const bench_case_t* bc = start; bc < end; bc++) {
+        bench_res_t res;
+
+        if (NULL != filter && NULL == strstr(bc->name, filter))
+            continue;
+
+        int ret = bench_case_run(bc, &res);
+        if (BENCH_SKIP == ret) {
+            console_println(this, "bench: name=%s skipped=1", bc->name);
+            continue;
+        }
+
+        if (0 != ret) {
+            console_println(this, "bench: name=%s error=%d", bc->name, ret);
+            continue;
+        }
+
+        console_println(this, "bench: name=%s reps=%lu min=%lu med=%lu max=%lu",
+                        bc->name, res.reps, res.min, res.med, res.max);
+    }
+
+    return 0;
+}
+
+EXPORT_CONSOLE_CMD("bench", bench_cmd, "run the microbenchmarks [filter]",
+                   "[s]");
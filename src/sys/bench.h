@@ -0,0 +1,81 @@
+/*
+@file: bench.h
+@author: ZZH
+@date: 2026-10-19
+@info: microbenchmarks collected from the .bench.* sections
+
+    static void crc_run(const void* arg) { ... }
+
+    BENCH_DEF(crc_1k, .run = crc_run, .flags = BENCH_IRQ_OFF);
+
+Every repetition of a case is timed on its own by the DWT cycle counter,
+the 'bench' console command reports min, median and max per case.
+*/
+
+#ifndef __BENCH_H__
+#define __BENCH_H__
+
+#include <errno.h>
+#include <stdint.h>
+#include "gnu_attributes.h"
+
+#ifndef CONFIG_BENCH_MAX_REPS
+#define CONFIG_BENCH_MAX_REPS 32
+#endif
+
+#ifndef CONFIG_BENCH_DEFAULT_REPS
+#define CONFIG_BENCH_DEFAULT_REPS 16
+#endif
+
+// every repetition runs with the interrupts masked
+#define BENCH_IRQ_OFF 0x1U
+
+// from setup when the image lacks what the case needs, e.g. the heap of the
+// 8K QEMU image, the case is reported as skipped rather than failed
+#define BENCH_SKIP 1
+
+typedef struct
+{
+    const char* name;
+    // handed to setup, run and teardown
+    const void* arg;
+    // optional, once before the warm-up, a negative errno fails the case
+    // and BENCH_SKIP skips it
+    int (*setup)(const void* arg);
+    void (*run)(const void* arg);
+    // optional, once after the last repetition
+    void (*teardown)(const void* arg);
+    // 0 takes CONFIG_BENCH_DEFAULT_REPS
+    uint16_t reps;
+    // untimed runs before the first sample, at least one
+    uint8_t warmup;
+    uint8_t flags;
+} bench_case_t;
+
+typedef struct
+{
+    uint32_t reps;
+    uint32_t min;
+    uint32_t med;
+    uint32_t max;
+} bench_res_t;
+
+// the section suffix keeps the cases sorted by name, the explicit alignment
+// stops the compiler from padding the table (x86-64 aligns big objects)
+#define BENCH_DEF(case_name, ...)                                        \
+    GNU_USED GNU_SECTION(.bench.case_name) GNU_ALIGN(sizeof(void*))      \
+        static const bench_case_t bench_##case_name = {.name = #case_name, \
+                                                       __VA_ARGS__}
+
+// 1 if the DWT cycle counter runs, 0 if the time base stands in for it, a
+// repetition with the interrupts masked must then stay below one tick
+int bench_counter_init(void);
+uint32_t bench_counter_read(void);
+
+// cycles of an empty case, already taken off every sample
+uint32_t bench_overhead(void);
+
+// results are core clock cycles, BENCH_SKIP if setup skipped the case
+int bench_case_run(const bench_case_t* bc, bench_res_t* res);
+
+#endif // __BENCH_H__
@@ -0,0 +1,158 @@
+/*
+@file: bench_cases.c
+@author: ZZH
+@date: 2026-10-19
+@info: microbenchmarks of the building blocks the rest of the firmware leans
+       on, run them with the 'bench' console command
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bench.h"
+#include "block_pool.h"
+#include "stm32f10x.h"
+#include "hal/clock/clock.h"
+#include "hal/usart/usart_stream.h"
+
+#define BENCH_BUF_SIZE  1024
+#define BENCH_RING_SIZE 128
+#define BENCH_RING_MSG  64
+
+// from the heap while a case runs, the QEMU image only has 8K of RAM
+static uint32_t* src_buf;
+static uint32_t* dst_buf;
+
+// static, so the formatting has a visible result
+static char fmt_line[64];
+
+static void fmt_run(const void* arg)
+{
+    (void) arg;
+
+    snprintf(fmt_line, sizeof(fmt_line), "%s: %lu %d 0x%08lx", "fmt",
+             4000000000UL, -12345, 0xdeadbeefUL);
+}
+
+BENCH_DEF(fmt_snprintf, .run = fmt_run);
+
+static int buf_setup(const void* arg)
+{
+    (void) arg;
+
+    src_buf = malloc(BENCH_BUF_SIZE * 2);
+    if (NULL == src_buf)
+        return BENCH_SKIP;
+
+    dst_buf = src_buf + BENCH_BUF_SIZE / 4;
+    for (uint32_t i = 0; i < BENCH_BUF_SIZE / 4; i++)
+        src_buf[i] = i * 0x01010101U;
+
+    return 0;
+}
+
+static void buf_teardown(const void* arg)
+{
+    (void) arg;
+
+    free(src_buf);
+    src_buf = NULL;
+    dst_buf = NULL;
+}
+
+static int crc_setup(const void* arg)
+{
+    int ret = buf_setup(arg);
+    if (0 != ret)
+        return ret;
+
+    ret = clock_enable_for(CRC);
+    if (0 != ret)
+        buf_teardown(arg);
+
+    return ret;
+}
+
+// one word per bus write, the CRC unit keeps up with the core
+static void crc_run(const void* arg)
+{
+    (void) arg;
+
+    CRC->CR = CRC_CR_RESET;
+    for (uint32_t i = 0; i < BENCH_BUF_SIZE / 4; i++) CRC->DR = src_buf[i];
+    (void) CRC->DR;
+}
+
+static void crc_teardown(const void* arg)
+{
+    clock_disable_for(CRC);
+    buf_teardown(arg);
+}
+
+BENCH_DEF(crc_1k, .setup = crc_setup, .run = crc_run,
+          .teardown = crc_teardown, .flags = BENCH_IRQ_OFF);
+
+static void memcpy_run(const void* arg)
+{
+    (void) arg;
+
+    memcpy(dst_buf, src_buf, BENCH_BUF_SIZE);
+}
+
+BENCH_DEF(memcpy_1k, .setup = buf_setup, .run = memcpy_run,
+          .teardown = buf_teardown, .flags = BENCH_IRQ_OFF);
+
+static void memset_run(const void* arg)
+{
+    (void) arg;
+
+    memset(dst_buf, 0x5a, BENCH_BUF_SIZE);
+}
+
+BENCH_DEF(memset_1k, .setup = buf_setup, .run = memset_run,
+          .teardown = buf_teardown, .flags = BENCH_IRQ_OFF);
+
+// only the rx ring of the stream, no usart behind it
+static usart_stream_t ring_stream;
+static uint8_t ring_buf[BENCH_RING_SIZE];
+
+static int ring_setup(const void* arg)
+{
+    (void) arg;
+
+    memset(&ring_stream, 0, sizeof(ring_stream));
+    ring_stream.rx_buf = ring_buf;
+    ring_stream.rx_size = sizeof(ring_buf);
+
+    return 0;
+}
+
+// what the usart interrupt and the console task do per message
+static void ring_run(const void* arg)
+{
+    uint8_t msg[BENCH_RING_MSG];
+
+    (void) arg;
+
+    for (uint32_t i = 0; i < BENCH_RING_MSG; i++)
+        usart_stream_rx_push(&ring_stream, (uint8_t) i);
+
+    usart_stream_read(&ring_stream, msg, sizeof(msg));
+}
+
+BENCH_DEF(ring_64, .setup = ring_setup, .run = ring_run,
+          .flags = BENCH_IRQ_OFF);
+
+BLOCK_POOL_DEF(bench_pool, 32, 8);
+
+static void pool_run(const void* arg)
+{
+    void* block[8];
+
+    (void) arg;
+
+    for (uint32_t i = 0; i < 8; i++) block[i] = block_pool_alloc(&bench_pool);
+    for (uint32_t i = 0; i < 8; i++) block_pool_free(&bench_pool, block[i]);
+}
+
+BENCH_DEF(pool_8, .run = pool_run);
@@ -0,0 +1,110 @@
+/*
+@file: block_pool.c
+@author: ZZH
+@date: 2026-10-19
+@info: blocks are handed out in address order until the pool has been
+       used up once, afterwards they come from the free list, so a pool
+       needs no initialization at boot
+*/
+
+#include <stddef.h>
+#include "block_pool.h"
+#include "linker_tools.h"
+#include "kernel/kernel.h"
+#include "tiny_console/tiny_console.h"
+#include "tiny_console/tiny_console_cmd.h"
+
+LINKER_SYMBOL32(__sblock_pool);
+LINKER_SYMBOL32(__eblock_pool);
+
+void* block_pool_alloc_locked(block_pool_t* pool)
+{
+    void* block = pool->free;
+
+    if (NULL != block) {
+        pool->free = *(void**) block;
+    } else if (pool->fresh < pool->num) {
+        block = pool->mem + (uint32_t) pool->fresh * pool->block_size;
+        pool->fresh++;
+    } else {
+        pool->fails++;
+        return NULL;
+    }
+
+    pool->used++;
+    if (pool->used > pool->high_water)
+        pool->high_water = pool->used;
+
+    return block;
+}
+
+int block_pool_free_locked(block_pool_t* pool, void* ptr)
+{
+    uint32_t offset = (uint8_t*) ptr - pool->mem;
+
+    if ((uint8_t*) ptr < pool->mem ||
+        offset >= (uint32_t) pool->fresh * pool->block_size ||
+        0 != offset % pool->block_size)
+        return -EINVAL;
+
+    // nothing is out, so this is a block freed twice
+    if (0 == pool->used)
+        return -EINVAL;
+
+#ifdef __DEBUG
+    // a double free while other blocks are out, O(n) so debug builds only
+    for (void* block = pool->free; NULL != block; block = *(void**) block) {
+        if (block == ptr)
+            return -EINVAL;
+    }
+#endif
+
+    *(void**) ptr = pool->free;
+    pool->free = ptr;
+    pool->used--;
+
+    return 0;
+}
+
+void* block_pool_alloc(block_pool_t* pool)
+{
+    if (NULL == pool)
+        return NULL;
+
+    uint32_t key = kernel_irq_save();
+    void* block = block_pool_alloc_locked(pool);
+    kernel_irq_restore(key);
+
+    return block;
+}
+
+int block_pool_free(block_pool_t* pool, void* ptr)
+{
+    if (NULL == pool || NULL == ptr)
+        return -EINVAL;
+
+    uint32_t key = kernel_irq_save();
+    int ret = block_pool_free_locked(pool, ptr);
+    kernel_irq_restore(key);
+
+    return ret;
+}
+
+CONSOLE_CMD_DEF(pools_cmd)
+{
+    CONSOLE_CMD_UNUSE_ARGS;
+
+    const block_pool_t* start = (const block_pool_t*) __sblock_pool;
+    const block_pool_t* end = (const block_pool_t*) __eblock_pool;
+
+    console_println(this, "name             size  used  peak   num  fails");
+
+    for (const block_pool_t* pool = start; pool < end; pool++)
+        console_println(this, "%-16s %4u  %4u  %4u  %4u  %5lu", pool->name,
+                        pool->block_size, pool->used, pool->high_water,
+                        pool->num, pool->fails);
+
+    return 0;
+}
+
+EXPORT_CONSOLE_CMD("pools", pools_cmd, "show the fixed block pools", NULL);
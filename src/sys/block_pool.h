@@ -0,0 +1,70 @@
+/*
+@file: block_pool.h
+@author: ZZH
+@date: 2026-10-19
+@info: statically sized pools of fixed size blocks
+
+    BLOCK_POOL_DEF(msg_pool, sizeof(msg_t), 8);
+
+    msg_t* msg = block_pool_alloc(&msg_pool);
+    block_pool_free(&msg_pool, msg);
+
+The descriptors are collected in the .block_pool section so the 'pools'
+console command finds every pool in the image.
+*/
+
+#ifndef __BLOCK_POOL_H__
+#define __BLOCK_POOL_H__
+
+#include <errno.h>
+#include <stdint.h>
+#include "gnu_attributes.h"
+
+typedef struct
+{
+    const char* name;
+    uint8_t* mem;
+    uint16_t block_size;
+    uint16_t num;
+
+    // freed blocks, linked through their first word
+    void* free;
+    // blocks from this index on were never handed out
+    uint16_t fresh;
+    uint16_t used;
+    uint16_t high_water;
+    uint32_t fails;
+} block_pool_t;
+
+// blocks hold at least the free list link and keep pointer alignment
+#define BLOCK_POOL_WORDS(size) \
+    (((size) + sizeof(void*) - 1) / sizeof(void*) + ((size) == 0))
+
+#define BLOCK_POOL_DEF(pool_name, size, count)                      \
+    static void* pool_name##_mem[BLOCK_POOL_WORDS(size) * (count)]; \
+    GNU_USED GNU_SECTION(.block_pool) block_pool_t pool_name = {    \
+        .name = #pool_name,                                         \
+        .mem = (uint8_t*) pool_name##_mem,                          \
+        .block_size = BLOCK_POOL_WORDS(size) * sizeof(void*),       \
+        .num = (count),                                             \
+    }
+
+#define BLOCK_POOL_DECLARE(pool_name) extern block_pool_t pool_name
+
+// O(1), safe from tasks and interrupts alike, NULL once the pool is empty
+void* block_pool_alloc(block_pool_t* pool);
+// -EINVAL for a pointer that is not a block of this pool or a block freed
+// twice, the latter is only caught in every case by __DEBUG builds
+int block_pool_free(block_pool_t* pool, void* ptr);
+
+// for callers already inside kernel_irq_save, e.g. to take several blocks
+// in one critical section
+void* block_pool_alloc_locked(block_pool_t* pool);
+int block_pool_free_locked(block_pool_t* pool, void* ptr);
+
+static inline uint32_t block_pool_available(const block_pool_t* pool)
+{
+    return pool->num - pool->used;
+}
+
+#endif // __BLOCK_POOL_H__
@@ -0,0 +1,130 @@
+/*
+@file: block_pool_check.c
+@author: ZZH
+@date: 2026-10-19
+@info: correctness of the block pools, bench_cases.c only times them. the
+       pool lives on the stack, so it starts fresh on every run and stays out
+       of the 'pools' listing
+*/
+
+#include <stddef.h>
+#include "block_pool.h"
+#include "tiny_console/tiny_console.h"
+#include "tiny_console/tiny_console_cmd.h"
+
+#define CHECK_BLOCK_SIZE 12
+#define CHECK_BLOCKS     4
+
+typedef struct
+{
+    uint32_t total;
+    uint32_t failed;
+} check_ctx_t;
+
+static void* check_mem[BLOCK_POOL_WORDS(CHECK_BLOCK_SIZE) * CHECK_BLOCKS];
+
+static void check(console_t* this, check_ctx_t* ctx, int ok, const char* what)
+{
+    ctx->total++;
+    if (ok)
+        return;
+
+    ctx->failed++;
+    console_println(this, "poolcheck: %s wrong", what);
+}
+
+CONSOLE_CMD_DEF(pool_check_cmd)
+{
+    CONSOLE_CMD_UNUSE_ARGS;
+
+    check_ctx_t ctx = {0};
+    block_pool_t pool = {
+        .name = "check",
+        .mem = (uint8_t*) check_mem,
+        .block_size = BLOCK_POOL_WORDS(CHECK_BLOCK_SIZE) * sizeof(void*),
+        .num = CHECK_BLOCKS,
+    };
+    uint8_t* block[CHECK_BLOCKS];
+    int in_order = 1;
+
+    check(this, &ctx, 0 == pool.block_size % sizeof(void*) &&
+                          pool.block_size >= CHECK_BLOCK_SIZE,
+          "block size");
+
+    // a fresh pool hands its blocks out in address order
+    for (uint32_t i = 0; i < CHECK_BLOCKS; i++) {
+        block[i] = block_pool_alloc(&pool);
+        if (block[i] != pool.mem + i * pool.block_size)
+            in_order = 0;
+    }
+
+    check(this, &ctx, in_order, "first use order");
+    check(this, &ctx,
+          CHECK_BLOCKS == pool.used && CHECK_BLOCKS == pool.high_water &&
+              0 == block_pool_available(&pool),
+          "used");
+
+    check(this, &ctx, NULL == block_pool_alloc(&pool) && 1 == pool.fails,
+          "empty pool");
+
+    // freed blocks come back last in, first out
+    check(this, &ctx,
+          0 == block_pool_free(&pool, block[1]) &&
+              0 == block_pool_free(&pool, block[3]) && 2 == pool.used,
+          "free");
+    check(this, &ctx,
+          block[3] == block_pool_alloc(&pool) &&
+              block[1] == block_pool_alloc(&pool),
+          "free list reuse");
+    check(this, &ctx, NULL == block_pool_alloc(&pool) && 2 == pool.fails,
+          "empty after reuse");
+
+    check(this, &ctx,
+          -EINVAL == block_pool_free(&pool, NULL) &&
+              -EINVAL == block_pool_free(NULL, block[0]) &&
+              -EINVAL == block_pool_free(&pool, block[0] + 1) &&
+              -EINVAL == block_pool_free(&pool, &ctx) &&
+              -EINVAL == block_pool_free(
+                             &pool, pool.mem + CHECK_BLOCKS * pool.block_size),
+          "foreign pointers");
+    check(this, &ctx, CHECK_BLOCKS == pool.used, "used after bad frees");
+
+#ifdef __DEBUG
+    // caught by the free list walk while other blocks are still out
+    check(this, &ctx,
+          0 == block_pool_free(&pool, block[2]) &&
+              -EINVAL == block_pool_free(&pool, block[2]) &&
+              block[2] == block_pool_alloc(&pool),
+          "double free");
+#endif
+
+    for (uint32_t i = 0; i < CHECK_BLOCKS; i++)
+        block_pool_free(&pool, block[i]);
+
+    check(this, &ctx,
+          0 == pool.used && CHECK_BLOCKS == pool.high_water &&
+              CHECK_BLOCKS == block_pool_available(&pool),
+          "all freed");
+    check(this, &ctx, -EINVAL == block_pool_free(&pool, block[0]),
+          "free of an empty pool");
+
+    // blocks past the fresh index were never handed out
+    block_pool_t part = pool;
+    part.free = NULL;
+    part.fresh = 0;
+    check(this, &ctx,
+          pool.mem == block_pool_alloc(&part) &&
+              -EINVAL == block_pool_free(&part, pool.mem + pool.block_size),
+          "block never handed out");
+
+    console_println(this, "poolcheck: passed [%lu/%lu]",
+                    ctx.total - ctx.failed, ctx.total);
+    if (ctx.failed)
+        console_println(this, "poolcheck: failed [%lu/%lu]", ctx.failed,
+                        ctx.total);
+
+    return ctx.failed ? -EIO : 0;
+}
+
+EXPORT_CONSOLE_CMD("poolcheck", pool_check_cmd, "check the block pools",
+                   NULL);
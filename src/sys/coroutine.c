@@ -0,0 +1,57 @@
+/*
+@file: coroutine.c
+@author: ZZH
+@date: 2026-10-19
+@info: round-robin runner for stackless coroutines
+*/
+
+#include <stddef.h>
+#include "coroutine.h"
+#include "arg_checkers.h"
+
+int co_sched_init(co_sched_t* sched)
+{
+    CHECK_PTR(sched, -EINVAL);
+
+    sched->head = NULL;
+
+    return 0;
+}
+
+int co_spawn(co_sched_t* sched, co_task_t* task, co_fn_t fn, void* arg)
+{
+    CHECK_PTR(sched, -EINVAL);
+    CHECK_PTR(task, -EINVAL);
+    CHECK_PTR(fn, -EINVAL);
+
+    co_init(&task->co);
+    task->fn = fn;
+    task->arg = arg;
+    task->result = CO_WAITING;
+    task->next = sched->head;
+    sched->head = task;
+
+    return 0;
+}
+
+uint32_t co_sched_poll(co_sched_t* sched)
+{
+    uint32_t alive = 0;
+    co_task_t** link = &sched->head;
+
+    while (NULL != *link) {
+        co_task_t* task = *link;
+
+        task->result = task->fn(&task->co, task->arg);
+
+        if (CO_WAITING == task->result) {
+            alive++;
+            link = &task->next;
+        } else {
+            *link = task->next;
+            task->next = NULL;
+        }
+    }
+
+    return alive;
+}
@@ -0,0 +1,174 @@
+/*
+@file: coroutine.h
+@author: ZZH
+@date: 2026-10-19
+@info: stackless (protothread style) coroutines
+
+A coroutine is a function that is called over and over again, it resumes
+at the last await point through a switch on co_t.lc, so:
+  - locals do not survive an await, keep state in a context struct
+  - do not put an await point inside a switch statement of your own
+
+    int blink(co_t* co, void* arg)
+    {
+        CO_BEGIN(co);
+
+        while (1) {
+            GPIO_SetBits(GPIOC, GPIO_Pin_13);
+            CO_DELAY(co, 100);
+            GPIO_ResetBits(GPIOC, GPIO_Pin_13);
+            CO_DELAY(co, 100);
+        }
+
+        CO_END(co);
+    }
+*/
+
+#ifndef __COROUTINE_H__
+#define __COROUTINE_H__
+
+#include <errno.h>
+#include <stdint.h>
+#include "sys/timebase.h"
+
+// still running, call again later
+#define CO_WAITING 0
+// finished successfully, errors are reported as negative errno
+#define CO_DONE    1
+
+typedef struct
+{
+    uint32_t lc;
+    uint32_t wake;
+} co_t;
+
+typedef int (*co_fn_t)(co_t* co, void* arg);
+
+// completion flag, usually set from an interrupt handler
+typedef volatile uint8_t co_event_t;
+
+static inline void co_init(co_t* co)
+{
+    co->lc = 0;
+    co->wake = 0;
+}
+
+static inline uint32_t co_now(void)
+{
+    return (uint32_t) timebase_get_ticks();
+}
+
+static inline int co_expired(const co_t* co)
+{
+    return (int32_t) (co_now() - co->wake) >= 0;
+}
+
+static inline void co_event_signal(co_event_t* event)
+{
+    *event = 1;
+}
+
+static inline void co_event_clear(co_event_t* event)
+{
+    *event = 0;
+}
+
+#define CO_FALLTHROUGH __attribute__((__fallthrough__))
+
+#define CO_BEGIN(co)    \
+    switch ((co)->lc) { \
+        case 0:
+
+#define CO_END(co) \
+    }              \
+    (co)->lc = 0;  \
+    return CO_DONE
+
+#define CO_RETURN(co, value) \
+    do {                     \
+        (co)->lc = 0;        \
+        return (value);      \
+    } while (0)
+
+#define CO_WAIT_UNTIL(co, cond)    \
+    do {                           \
+        (co)->lc = __LINE__;       \
+        CO_FALLTHROUGH;            \
+        case __LINE__:             \
+            if (!(cond))           \
+                return CO_WAITING; \
+    } while (0)
+
+#define CO_WAIT_WHILE(co, cond) CO_WAIT_UNTIL(co, !(cond))
+
+// give the other coroutines a turn
+#define CO_YIELD(co)               \
+    do {                           \
+        (co)->wake = 1;            \
+        (co)->lc = __LINE__;       \
+        CO_FALLTHROUGH;            \
+        case __LINE__:             \
+            if (0 != (co)->wake) { \
+                (co)->wake = 0;    \
+                return CO_WAITING; \
+            }                      \
+    } while (0)
+
+#define CO_DELAY(co, ticks)                         \
+    do {                                            \
+        (co)->wake = co_now() + (uint32_t) (ticks); \
+        CO_WAIT_UNTIL(co, co_expired(co));          \
+    } while (0)
+
+// cond is evaluated once per resume, so it may have side effects
+#define CO_WAIT_UNTIL_TIMEOUT(co, cond, ticks)      \
+    do {                                            \
+        (co)->wake = co_now() + (uint32_t) (ticks); \
+        (co)->lc = __LINE__;                        \
+        CO_FALLTHROUGH;                             \
+        case __LINE__:                              \
+            if (!(cond)) {                          \
+                if (co_expired(co))                 \
+                    CO_RETURN(co, -ETIMEDOUT);      \
+                return CO_WAITING;                  \
+            }                                       \
+    } while (0)
+
+#define CO_WAIT_EVENT(co, event)          \
+    do {                                  \
+        CO_WAIT_UNTIL(co, 0 != *(event)); \
+        co_event_clear(event);            \
+    } while (0)
+
+// run a child coroutine (e.g. an async driver call) to completion, its
+// result is stored into ret
+#define CO_AWAIT(co, ret, call)                            \
+    do {                                                   \
+        CO_WAIT_UNTIL(co, CO_WAITING != ((ret) = (call))); \
+    } while (0)
+
+typedef struct co_task co_task_t;
+
+struct co_task
+{
+    co_t co;
+    co_fn_t fn;
+    void* arg;
+    // last return value of fn
+    int result;
+    co_task_t* next;
+};
+
+// interleave several coroutines on the caller's stack
+typedef struct
+{
+    co_task_t* head;
+} co_sched_t;
+
+int co_sched_init(co_sched_t* sched);
+int co_spawn(co_sched_t* sched, co_task_t* task, co_fn_t fn, void* arg);
+// resume every coroutine once, finished ones are removed, return the
+// number of coroutines still alive
+uint32_t co_sched_poll(co_sched_t* sched);
+
+#endif // __COROUTINE_H__
@@ -0,0 +1,137 @@
+/*
+@file: heap.c
+@author: ZZH
+@date: 2026-10-19
+@info: replaces the newlib allocator, both the plain and the reentrant
+       entry points are defined so no newlib malloc object gets linked in,
+       every call runs with interrupts off, which is bounded since TLSF is
+       O(1)
+*/
+
+#include <stdint.h>
+#include <string.h>
+#include "heap.h"
+#include "linker_tools.h"
+#include "kernel/kernel.h"
+#include "tiny_console/tiny_console.h"
+#include "tiny_console/tiny_console_cmd.h"
+
+LINKER_SYMBOL8(__eheap);
+
+extern void* _sbrk(ptrdiff_t incr);
+
+struct _reent;
+
+static tlsf_t heap;
+static uint8_t heap_ready;
+
+// called with interrupts off
+static tlsf_t* heap_get(void)
+{
+    if (heap_ready)
+        return &heap;
+
+    uint8_t* base = _sbrk(0);
+    ptrdiff_t size = __eheap - base;
+
+    if ((void*) -1 == _sbrk(size) || 0 != tlsf_init(&heap, base, size))
+        return NULL;
+
+    heap_ready = 1;
+
+    return &heap;
+}
+
+void* malloc(size_t size)
+{
+    uint32_t key = kernel_irq_save();
+    void* ptr = tlsf_malloc(heap_get(), size);
+    kernel_irq_restore(key);
+
+    return ptr;
+}
+
+void free(void* ptr)
+{
+    if (NULL == ptr)
+        return;
+
+    uint32_t key = kernel_irq_save();
+    tlsf_free(heap_get(), ptr);
+    kernel_irq_restore(key);
+}
+
+void* realloc(void* ptr, size_t size)
+{
+    uint32_t key = kernel_irq_save();
+    void* res = tlsf_realloc(heap_get(), ptr, size);
+    kernel_irq_restore(key);
+
+    return res;
+}
+
+void* calloc(size_t num, size_t size)
+{
+    size_t total;
+
+    if (__builtin_mul_overflow(num, size, &total))
+        return NULL;
+
+    void* ptr = malloc(total);
+    if (NULL != ptr)
+        memset(ptr, 0, total);
+
+    return ptr;
+}
+
+void* _malloc_r(struct _reent* r, size_t size)
+{
+    (void) r;
+    return malloc(size);
+}
+
+void _free_r(struct _reent* r, void* ptr)
+{
+    (void) r;
+    free(ptr);
+}
+
+void* _realloc_r(struct _reent* r, void* ptr, size_t size)
+{
+    (void) r;
+    return realloc(ptr, size);
+}
+
+void* _calloc_r(struct _reent* r, size_t num, size_t size)
+{
+    (void) r;
+    return calloc(num, size);
+}
+
+void heap_get_stats(tlsf_stats_t* stats)
+{
+    memset(stats, 0, sizeof(*stats));
+
+    uint32_t key = kernel_irq_save();
+    tlsf_get_stats(heap_get(), stats);
+    kernel_irq_restore(key);
+}
+
+CONSOLE_CMD_DEF(heap_cmd)
+{
+    CONSOLE_CMD_UNUSE_ARGS;
+
+    tlsf_stats_t stats;
+    heap_get_stats(&stats);
+
+    console_println(this, "total %lu, used %lu, peak %lu", stats.total,
+                    stats.used, stats.peak);
+    console_println(this, "free blocks %lu, largest %lu, frag %lu.%lu%%",
+                    stats.free_blocks, stats.largest_free,
+                    stats.frag_permille / 10, stats.frag_permille % 10);
+    console_println(this, "allocs %lu, fails %lu", stats.allocs, stats.fails);
+
+    return 0;
+}
+
+EXPORT_CONSOLE_CMD("heap", heap_cmd, "show heap usage", NULL);
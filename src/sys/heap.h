@@ -0,0 +1,16 @@
+/*
+@file: heap.h
+@author: ZZH
+@date: 2026-10-19
+@info: malloc and friends on top of a TLSF pool covering the linker heap
+*/
+
+#ifndef __HEAP_H__
+#define __HEAP_H__
+
+#include "tlsf.h"
+
+// the pool takes the whole _sbrk region on the first allocation
+void heap_get_stats(tlsf_stats_t* stats);
+
+#endif // __HEAP_H__
@@ -0,0 +1,152 @@
+/*
+@file: heap_bench.c
+@author: ZZH
+@date: 2026-10-19
+@info: random malloc/free stress on a private TLSF pool carved out of the
+       heap, every block is filled with a pattern that is checked before it
+       is freed, the worst case times show the allocator stays O(1)
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "tlsf.h"
+#include "sys/timebase.h"
+#include "tiny_console/tiny_console.h"
+#include "tiny_console/tiny_console_cmd.h"
+
+#define BENCH_POOL_SIZE 4096
+#define BENCH_SLOTS     32
+#define BENCH_MAX_ALLOC 256
+#define BENCH_ROUNDS    2000
+
+typedef struct
+{
+    uint32_t malloc_sum;
+    uint32_t malloc_max;
+    uint32_t free_sum;
+    uint32_t free_max;
+    uint32_t mallocs;
+    uint32_t frees;
+    uint32_t corrupt;
+} bench_res_t;
+
+static uint32_t bench_seed;
+
+static uint32_t bench_rand(void)
+{
+    bench_seed = bench_seed * 1664525 + 1013904223;
+    return bench_seed >> 8;
+}
+
+static inline uint32_t bench_cycles(void)
+{
+    return (uint32_t) timebase_get_cycles();
+}
+
+static int bench_check(const uint8_t* ptr, uint32_t len, uint8_t pattern)
+{
+    for (uint32_t i = 0; i < len; i++) {
+        if (ptr[i] != pattern)
+            return 0;
+    }
+
+    return 1;
+}
+
+static void bench_release(tlsf_t* pool, bench_res_t* res, uint8_t* ptr,
+                          uint32_t len, uint8_t pattern)
+{
+    if (!bench_check(ptr, len, pattern))
+        res->corrupt++;
+
+    uint32_t start = bench_cycles();
+    tlsf_free(pool, ptr);
+    uint32_t cycles = bench_cycles() - start;
+
+    res->free_sum += cycles;
+    if (cycles > res->free_max)
+        res->free_max = cycles;
+    res->frees++;
+}
+
+static void bench_run(tlsf_t* pool, bench_res_t* res)
+{
+    uint8_t* slot[BENCH_SLOTS] = {NULL};
+    uint16_t slot_len[BENCH_SLOTS];
+
+    for (uint32_t round = 0; round < BENCH_ROUNDS; round++) {
+        uint32_t idx = bench_rand() % BENCH_SLOTS;
+
+        if (NULL != slot[idx]) {
+            bench_release(pool, res, slot[idx], slot_len[idx], idx);
+            slot[idx] = NULL;
+            continue;
+        }
+
+        uint32_t len = bench_rand() % BENCH_MAX_ALLOC + 1;
+
+        uint32_t start = bench_cycles();
+        uint8_t* ptr = tlsf_malloc(pool, len);
+        uint32_t cycles = bench_cycles() - start;
+
+        // an exhausted pool is part of the test
+        if (NULL == ptr)
+            continue;
+
+        res->malloc_sum += cycles;
+        if (cycles > res->malloc_max)
+            res->malloc_max = cycles;
+        res->mallocs++;
+
+        memset(ptr, idx, len);
+        slot[idx] = ptr;
+        slot_len[idx] = len;
+    }
+
+    for (uint32_t i = 0; i < BENCH_SLOTS; i++) {
+        if (NULL != slot[i])
+            bench_release(pool, res, slot[i], slot_len[i], i);
+    }
+}
+
+CONSOLE_CMD_DEF(heap_bench)
+{
+    bench_seed = argc > 0 ? argv[0].unum : 1;
+
+    void* mem = malloc(BENCH_POOL_SIZE);
+    if (NULL == mem) {
+        console_println(this, "no room for a %d byte pool", BENCH_POOL_SIZE);
+        return -ENOMEM;
+    }
+
+    tlsf_t pool;
+    bench_res_t res = {0};
+    tlsf_stats_t stats;
+
+    tlsf_init(&pool, mem, BENCH_POOL_SIZE);
+    bench_run(&pool, &res);
+    tlsf_get_stats(&pool, &stats);
+
+    free(mem);
+
+    console_println(this, "malloc: %lu calls, avg %lu, max %lu cycles",
+                    res.mallocs, res.malloc_sum / (res.mallocs + !res.mallocs),
+                    res.malloc_max);
+    console_println(this, "free:   %lu calls, avg %lu, max %lu cycles",
+                    res.frees, res.free_sum / (res.frees + !res.frees),
+                    res.free_max);
+    console_println(this, "peak %lu of %lu, fails %lu, corrupt %lu",
+                    stats.peak, stats.total, stats.fails, res.corrupt);
+
+    // everything was freed, so the pool must be one block again
+    if (0 != res.corrupt || 1 != stats.free_blocks) {
+        console_println(this, "FAILED: %lu free blocks left",
+                        stats.free_blocks);
+        return -EFAULT;
+    }
+
+    return 0;
+}
+
+EXPORT_CONSOLE_CMD("heapbench", heap_bench, "TLSF stress test and timing",
+                   "[u]");
@@ -0,0 +1,188 @@
+/*
+@file: retained.c
+@author: ZZH
+@date: 2026-10-19
+@info: the CRC covers size and version along with the data and is worked
+       out by the CRC unit, a word at a time
+*/
+
+#include <stddef.h>
+#include <string.h>
+#include "retained.h"
+#include "stm32f10x.h"
+#include "hal/clock/clock.h"
+#include "kernel/kernel.h"
+#include "tiny_console/tiny_console.h"
+#include "tiny_console/tiny_console_cmd.h"
+
+typedef void (*init_func_t)(void);
+
+typedef struct
+{
+    const char* name;
+    retained_hdr_t* hdr;
+    const void* data;
+    uint8_t restored;
+} retained_entry_t;
+
+typedef struct
+{
+    uint32_t boots;
+    uint32_t warm_boots;
+    uint32_t last_flags;
+} retained_boot_t;
+
+static retained_entry_t retained_list[CONFIG_RETAINED_MAX];
+static uint32_t retained_num;
+static uint32_t reset_flags;
+
+RETAINED_DEF(boot_info, retained_boot_t);
+
+static uint32_t retained_crc(const retained_hdr_t* hdr, const void* ptr)
+{
+    const uint8_t* data = ptr;
+    uint32_t words = hdr->size / 4;
+    uint32_t tail = 0;
+
+    clock_enable_for(CRC);
+    CRC->CR = CRC_CR_RESET;
+
+    CRC->DR = ((uint32_t) hdr->version << 16) | hdr->size;
+    for (uint32_t i = 0; i < words; i++) {
+        uint32_t word;
+
+        memcpy(&word, &data[i * 4], 4);
+        CRC->DR = word;
+    }
+
+    if (hdr->size % 4) {
+        memcpy(&tail, &data[words * 4], hdr->size % 4);
+        CRC->DR = tail;
+    }
+
+    uint32_t crc = CRC->DR;
+    clock_disable_for(CRC);
+
+    return crc;
+}
+
+static retained_entry_t* retained_find(const retained_hdr_t* hdr)
+{
+    for (uint32_t i = 0; i < retained_num; i++) {
+        if (hdr == retained_list[i].hdr)
+            return &retained_list[i];
+    }
+
+    return NULL;
+}
+
+int retained_register(const char* name, retained_hdr_t* hdr, void* data,
+                      uint32_t size, uint16_t version)
+{
+    if (NULL == hdr || NULL == data || size > UINT16_MAX)
+        return -EINVAL;
+
+    uint32_t key = kernel_irq_save();
+
+    if (retained_num >= CONFIG_RETAINED_MAX) {
+        kernel_irq_restore(key);
+        return -ENOMEM;
+    }
+
+    retained_entry_t* entry = &retained_list[retained_num++];
+
+    int restored = RETAINED_MAGIC == hdr->magic && size == hdr->size &&
+                   version == hdr->version &&
+                   retained_crc(hdr, data) == hdr->crc;
+
+    if (!restored) {
+        memset(data, 0, size);
+        hdr->magic = RETAINED_MAGIC;
+        hdr->size = size;
+        hdr->version = version;
+        hdr->crc = retained_crc(hdr, data);
+    }
+
+    entry->name = name;
+    entry->hdr = hdr;
+    entry->data = data;
+    entry->restored = restored;
+
+    kernel_irq_restore(key);
+
+    return restored;
+}
+
+static void retained_seal(const retained_entry_t* entry)
+{
+    if (RETAINED_MAGIC != entry->hdr->magic)
+        return;
+
+    uint32_t key = kernel_irq_save();
+    entry->hdr->crc = retained_crc(entry->hdr, entry->data);
+    kernel_irq_restore(key);
+}
+
+void retained_commit(retained_hdr_t* hdr)
+{
+    const retained_entry_t* entry = retained_find(hdr);
+
+    if (NULL != entry)
+        retained_seal(entry);
+}
+
+void retained_commit_all(void)
+{
+    for (uint32_t i = 0; i < retained_num; i++)
+        retained_seal(&retained_list[i]);
+}
+
+void retained_invalidate_all(void)
+{
+    for (uint32_t i = 0; i < retained_num; i++)
+        retained_list[i].hdr->magic = 0;
+}
+
+uint32_t retained_reset_flags(void)
+{
+    return reset_flags;
+}
+
+// runs from do_init_calls, before main can touch the reset flags
+static void retained_init(void)
+{
+    reset_flags = RCC->CSR & (RCC_CSR_PINRSTF | RCC_CSR_PORRSTF |
+                              RCC_CSR_SFTRSTF | RCC_CSR_IWDGRSTF |
+                              RCC_CSR_WWDGRSTF | RCC_CSR_LPWRRSTF);
+    RCC->CSR |= RCC_CSR_RMVF;
+
+    if (1 == RETAINED_REGISTER(boot_info, 1))
+        boot_info.data.warm_boots++;
+
+    boot_info.data.boots++;
+    boot_info.data.last_flags = reset_flags;
+    retained_commit(&boot_info.hdr);
+}
+
+GNU_USED GNU_SECTION(.init_func.0) static const init_func_t
+    retained_init_call = retained_init;
+
+CONSOLE_CMD_DEF(retained_cmd)
+{
+    CONSOLE_CMD_UNUSE_ARGS;
+
+    console_println(this, "reset flags 0x%08lx, boots %lu, warm %lu",
+                    reset_flags, boot_info.data.boots,
+                    boot_info.data.warm_boots);
+
+    for (uint32_t i = 0; i < retained_num; i++)
+        console_println(this, "%-16s %5u bytes v%u %s", retained_list[i].name,
+                        retained_list[i].hdr->size,
+                        retained_list[i].hdr->version,
+                        retained_list[i].restored ? "restored" : "cold");
+
+    return 0;
+}
+
+EXPORT_CONSOLE_CMD("retained", retained_cmd, "show the retained RAM state",
+                   NULL);
@@ -0,0 +1,70 @@
+/*
+@file: retained.h
+@author: ZZH
+@date: 2026-10-19
+@info: structures kept in .noinit across resets that do not cut the power
+
+    typedef struct { uint32_t calib[4]; uint32_t counter; } app_state_t;
+    RETAINED_DEF(app_state, app_state_t);
+
+    if (!RETAINED_REGISTER(app_state, 1))
+        rebuild(&app_state.data);          // cold boot, data was zeroed
+    ...
+    app_state.data.counter++;
+    retained_commit(&app_state.hdr);
+
+A structure is only restored when its magic word, size, version and CRC
+all match, so a layout change needs a new version number.
+*/
+
+#ifndef __RETAINED_H__
+#define __RETAINED_H__
+
+#include <errno.h>
+#include <stdint.h>
+#include "gnu_attributes.h"
+
+#ifndef CONFIG_RETAINED_MAX
+#define CONFIG_RETAINED_MAX 8
+#endif
+
+#define RETAINED_MAGIC 0x52544E44U
+
+typedef struct
+{
+    uint32_t magic;
+    uint16_t size;
+    uint16_t version;
+    uint32_t crc;
+} retained_hdr_t;
+
+#define RETAINED_DEF(name, type)               \
+    GNU_SECTION(.noinit) GNU_ALIGN(4) struct { \
+        retained_hdr_t hdr;                    \
+        type data;                             \
+    } name
+
+/*
+ * 1: the contents survived and are kept, 0: they were invalid and have
+ * been zeroed, negative errno when the registry is full
+ */
+int retained_register(const char* name, retained_hdr_t* hdr, void* data,
+                      uint32_t size, uint16_t version);
+
+// data is passed on its own, a type with a stricter alignment than the
+// header leaves padding behind it
+#define RETAINED_REGISTER(name, version)                         \
+    retained_register(#name, &(name).hdr, &(name).data,          \
+                      sizeof((name).data), version)
+
+// seal the current contents, call after every update that must survive,
+// hdr has to be registered
+void retained_commit(retained_hdr_t* hdr);
+void retained_commit_all(void);
+// the next boot starts cold
+void retained_invalidate_all(void);
+
+// RCC_CSR reset flags of this boot
+uint32_t retained_reset_flags(void);
+
+#endif // __RETAINED_H__
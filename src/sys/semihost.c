@@ -0,0 +1,86 @@
+/*
+@file: semihost.c
+@author: ZZH
+@date: 2026-10-19
+@info: the calls trap with BKPT 0xAB, r0 holds the operation and r1 points
+       to its parameter block
+*/
+
+#include <errno.h>
+#include "semihost.h"
+
+#if CONFIG_SEMIHOSTING == 1
+
+#define SYS_OPEN          0x01
+#define SYS_WRITE         0x05
+#define SYS_GET_CMDLINE   0x15
+#define SYS_EXIT          0x18
+#define SYS_EXIT_EXTENDED 0x20
+
+// open mode "w" of fopen, ":tt" in that mode is the stdout of the host
+#define OPEN_MODE_W 4
+// ADP_Stopped_ApplicationExit
+#define EXIT_REASON 0x20026
+
+static int stdout_handle = -1;
+
+static int semihost_call(uint32_t op, void* arg)
+{
+    register uint32_t r0 asm("r0") = op;
+    register void* r1 asm("r1") = arg;
+
+    asm volatile("bkpt 0xAB" : "+r"(r0) : "r"(r1) : "memory");
+
+    return (int) r0;
+}
+
+static int semihost_stdout(void)
+{
+    if (stdout_handle < 0) {
+        uint32_t args[3] = {(uint32_t) ":tt", OPEN_MODE_W, 3};
+        stdout_handle = semihost_call(SYS_OPEN, args);
+    }
+
+    return stdout_handle;
+}
+
+int semihost_write(const void* buf, uint32_t len)
+{
+    int fd = semihost_stdout();
+
+    if (fd < 0)
+        return -EIO;
+
+    uint32_t args[3] = {(uint32_t) fd, (uint32_t) buf, len};
+
+    // the call returns the number of bytes it did not write
+    return (int) (len - (uint32_t) semihost_call(SYS_WRITE, args));
+}
+
+int semihost_get_cmdline(char* buf, uint32_t size)
+{
+    uint32_t args[2] = {(uint32_t) buf, size};
+
+    if (0 == size)
+        return -EINVAL;
+
+    if (0 != semihost_call(SYS_GET_CMDLINE, args))
+        return -EIO;
+
+    // the host stores the length it wrote back in the block
+    return (int) args[1];
+}
+
+void semihost_exit(int status)
+{
+    uint32_t args[2] = {EXIT_REASON, (uint32_t) status};
+
+    // the extended call carries the status, the plain one only pass/fail
+    semihost_call(SYS_EXIT_EXTENDED, args);
+    semihost_call(SYS_EXIT, (void*) EXIT_REASON);
+
+    while (1) {
+    }
+}
+
+#endif
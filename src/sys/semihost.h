@@ -0,0 +1,26 @@
+/*
+@file: semihost.h
+@author: ZZH
+@date: 2026-10-19
+@info: ARM semihosting, the I/O of the QEMU image (CONFIG_SEMIHOSTING=1),
+       a board without a debugger attached faults on the first call
+*/
+
+#ifndef __SEMIHOST_H__
+#define __SEMIHOST_H__
+
+#include <stdint.h>
+
+#ifndef CONFIG_SEMIHOST_CMDLINE_SIZE
+#define CONFIG_SEMIHOST_CMDLINE_SIZE 256
+#endif
+
+// to the stdout of the host, returns the number of bytes written
+int semihost_write(const void* buf, uint32_t len);
+// the path of the image, a space and the -append string of QEMU, returns
+// the length or a negative errno
+int semihost_get_cmdline(char* buf, uint32_t size);
+// ends the session, the host process exits with status
+void semihost_exit(int status) __attribute__((__noreturn__));
+
+#endif // __SEMIHOST_H__
@@ -0,0 +1,309 @@
+/*
+@file: soft_timer.c
+@author: ZZH
+@date: 2026-10-19
+@info: 4 level x 64 slot timer wheel, the tick handler only moves timers
+       between lists, callbacks are deferred to soft_timer_run()
+*/
+
+#include <stddef.h>
+#include "soft_timer.h"
+#include "arg_checkers.h"
+#include "kernel/kernel.h"
+
+#define WHEEL_BITS   6
+#define WHEEL_SIZE   (1u << WHEEL_BITS)
+#define WHEEL_MASK   (WHEEL_SIZE - 1)
+#define WHEEL_LEVELS 4
+
+// the largest delta the wheel can hold, farther timers are parked at the
+// end of the top level and re-inserted when that slot cascades
+#define WHEEL_MAX_DELTA ((1ull << (WHEEL_BITS * WHEEL_LEVELS)) - 1)
+
+#define LEVEL_SHIFT(level) ((level) * WHEEL_BITS)
+
+static soft_timer_t* wheel[WHEEL_LEVELS][WHEEL_SIZE];
+// last tick processed by the wheel
+static uint64_t wheel_now;
+
+// expired timers waiting for their callback, FIFO
+static soft_timer_t* expired_head;
+static soft_timer_t** expired_tail = &expired_head;
+
+#if CONFIG_ENABLE_KERNEL == 1
+static ksem_t service_sem;
+static task_t service_task;
+KERNEL_STACK_DEF(service_stack, CONFIG_SOFT_TIMER_STACK_SIZE);
+#endif
+
+static inline void list_add(soft_timer_t** head, soft_timer_t* timer)
+{
+    timer->next = *head;
+
+    if (NULL != timer->next)
+        timer->next->pprev = &timer->next;
+
+    *head = timer;
+    timer->pprev = head;
+}
+
+static inline void list_del(soft_timer_t* timer)
+{
+    *timer->pprev = timer->next;
+
+    if (NULL != timer->next)
+        timer->next->pprev = timer->pprev;
+
+    timer->next = NULL;
+    timer->pprev = NULL;
+}
+
+static void expired_append(soft_timer_t* timer)
+{
+    timer->next = NULL;
+    timer->pprev = expired_tail;
+    *expired_tail = timer;
+    expired_tail = &timer->next;
+    timer->state = SOFT_TIMER_EXPIRED;
+}
+
+static void expired_del(soft_timer_t* timer)
+{
+    if (NULL == timer->next)
+        expired_tail = timer->pprev;
+
+    list_del(timer);
+}
+
+static void wheel_insert(soft_timer_t* timer)
+{
+    uint64_t delta = timer->expire - wheel_now;
+    uint64_t slot_time = timer->expire;
+    uint32_t level;
+
+    if (delta > WHEEL_MAX_DELTA) {
+        delta = WHEEL_MAX_DELTA;
+        slot_time = wheel_now + WHEEL_MAX_DELTA;
+    }
+
+    // constant number of compares, no loop over the timers
+    if (delta < (1ull << LEVEL_SHIFT(1)))
+        level = 0;
+    else if (delta < (1ull << LEVEL_SHIFT(2)))
+        level = 1;
+    else if (delta < (1ull << LEVEL_SHIFT(3)))
+        level = 2;
+    else
+        level = 3;
+
+    uint32_t slot = (uint32_t) (slot_time >> LEVEL_SHIFT(level)) & WHEEL_MASK;
+
+    list_add(&wheel[level][slot], timer);
+    timer->state = SOFT_TIMER_ARMED;
+}
+
+static void wheel_cascade(uint32_t level)
+{
+    uint32_t slot = (uint32_t) (wheel_now >> LEVEL_SHIFT(level)) & WHEEL_MASK;
+    soft_timer_t* timer = wheel[level][slot];
+
+    wheel[level][slot] = NULL;
+
+    while (NULL != timer) {
+        soft_timer_t* next = timer->next;
+
+        if (timer->expire <= wheel_now)
+            expired_append(timer);
+        else
+            wheel_insert(timer);
+
+        timer = next;
+    }
+}
+
+int soft_timer_init(soft_timer_t* timer, soft_timer_cb_t cb, void* arg)
+{
+    CHECK_PTR(timer, -EINVAL);
+    CHECK_PTR(cb, -EINVAL);
+
+    timer->next = NULL;
+    timer->pprev = NULL;
+    timer->expire = 0;
+    timer->period = 0;
+    timer->cb = cb;
+    timer->arg = arg;
+    timer->state = SOFT_TIMER_IDLE;
+
+    return 0;
+}
+
+static void timer_detach(soft_timer_t* timer)
+{
+    if (SOFT_TIMER_ARMED == timer->state)
+        list_del(timer);
+    else if (SOFT_TIMER_EXPIRED == timer->state)
+        expired_del(timer);
+}
+
+int soft_timer_start(soft_timer_t* timer, uint32_t ticks, uint32_t period)
+{
+    CHECK_PTR(timer, -EINVAL);
+    CHECK_PTR(timer->cb, -EINVAL);
+
+    uint32_t key = kernel_irq_save();
+
+    timer_detach(timer);
+
+    timer->expire = wheel_now + (0 == ticks ? 1 : ticks);
+    timer->period = period;
+    wheel_insert(timer);
+
+    kernel_irq_restore(key);
+
+    return 0;
+}
+
+int soft_timer_cancel(soft_timer_t* timer)
+{
+    CHECK_PTR(timer, -EINVAL);
+
+    uint32_t key = kernel_irq_save();
+
+    timer_detach(timer);
+    timer->state = SOFT_TIMER_IDLE;
+
+    kernel_irq_restore(key);
+
+    return 0;
+}
+
+void soft_timer_tick(uint64_t now)
+{
+    uint32_t key = kernel_irq_save();
+    soft_timer_t** expired_before = expired_tail;
+
+    while (wheel_now < now) {
+        wheel_now++;
+
+        // top down, so a cascaded timer can land in a slot cascaded next
+        for (uint32_t level = WHEEL_LEVELS - 1; level > 0; level--) {
+            uint64_t mask = (1ull << LEVEL_SHIFT(level)) - 1;
+
+            if (0 == (wheel_now & mask))
+                wheel_cascade(level);
+        }
+
+        wheel_cascade(0);
+    }
+
+    kernel_irq_restore(key);
+
+#if CONFIG_ENABLE_KERNEL == 1
+    if (expired_before != expired_tail && kernel_is_running())
+        ksem_give(&service_sem);
+#else
+    (void) expired_before;
+#endif
+}
+
+uint32_t soft_timer_ticks_to_next(void)
+{
+    uint32_t key = kernel_irq_save();
+    uint64_t best = UINT64_MAX;
+
+    if (NULL != expired_head)
+        best = 0;
+
+    // the first non-empty slot of each level is the earliest moment that
+    // level needs the tick, either to fire (level 0) or to cascade
+    for (uint32_t level = 0; level < WHEEL_LEVELS && 0 != best; level++) {
+        uint32_t shift = LEVEL_SHIFT(level);
+        uint64_t index = wheel_now >> shift;
+
+        for (uint32_t k = 1; k <= WHEEL_SIZE; k++) {
+            if (NULL != wheel[level][(index + k) & WHEEL_MASK]) {
+                uint64_t delta = ((index + k) << shift) - wheel_now;
+
+                if (delta < best)
+                    best = delta;
+
+                break;
+            }
+        }
+    }
+
+    kernel_irq_restore(key);
+
+    return best > UINT32_MAX ? UINT32_MAX : (uint32_t) best;
+}
+
+uint32_t soft_timer_run(void)
+{
+    uint32_t count = 0;
+
+    while (1) {
+        uint32_t key = kernel_irq_save();
+        soft_timer_t* timer = expired_head;
+
+        if (NULL == timer) {
+            kernel_irq_restore(key);
+            break;
+        }
+
+        expired_del(timer);
+        timer->state = SOFT_TIMER_RUNNING;
+
+        kernel_irq_restore(key);
+
+        timer->cb(timer, timer->arg);
+        count++;
+
+        key = kernel_irq_save();
+
+        // the callback may have restarted or cancelled the timer itself
+        if (SOFT_TIMER_RUNNING == timer->state) {
+            if (0 != timer->period) {
+                timer->expire += timer->period;
+
+                // drop the periods missed while the callbacks were late
+                if (timer->expire <= wheel_now)
+                    timer->expire = wheel_now + 1;
+
+                wheel_insert(timer);
+            } else {
+                timer->state = SOFT_TIMER_IDLE;
+            }
+        }
+
+        kernel_irq_restore(key);
+    }
+
+    return count;
+}
+
+#if CONFIG_ENABLE_KERNEL == 1
+static void service_entry(void* arg)
+{
+    (void) arg;
+
+    while (1) {
+        ksem_take(&service_sem, KERNEL_WAIT_FOREVER);
+        soft_timer_run();
+    }
+}
+
+int soft_timer_service_start(void)
+{
+    int ret = ksem_init(&service_sem, 0, 1);
+    RETURN_IF_NZERO(ret, ret);
+
+    return task_create(&service_task, "timer", service_entry, NULL,
+                       CONFIG_SOFT_TIMER_TASK_PRIO, service_stack,
+                       sizeof(service_stack));
+}
+#else
+int soft_timer_service_start(void)
+{
+    return -ENOSYS;
+}
+#endif
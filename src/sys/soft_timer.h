@@ -0,0 +1,64 @@
+/*
+@file: soft_timer.h
+@author: ZZH
+@date: 2026-10-19
+@info: software timers on a hierarchical timer wheel, O(1) start/cancel,
+       callbacks run in a deferred (thread) context
+*/
+
+#ifndef __SOFT_TIMER_H__
+#define __SOFT_TIMER_H__
+
+#include <errno.h>
+#include <stdint.h>
+
+#ifndef CONFIG_SOFT_TIMER_TASK_PRIO
+#define CONFIG_SOFT_TIMER_TASK_PRIO 1
+#endif
+
+#ifndef CONFIG_SOFT_TIMER_STACK_SIZE
+#define CONFIG_SOFT_TIMER_STACK_SIZE 512
+#endif
+
+typedef struct soft_timer soft_timer_t;
+typedef void (*soft_timer_cb_t)(soft_timer_t* timer, void* arg);
+
+typedef enum {
+    SOFT_TIMER_IDLE = 0,
+    SOFT_TIMER_ARMED,
+    SOFT_TIMER_EXPIRED,
+    SOFT_TIMER_RUNNING,
+} soft_timer_state_t;
+
+struct soft_timer
+{
+    soft_timer_t* next;
+    soft_timer_t** pprev;
+
+    uint64_t expire;
+    uint32_t period;
+    soft_timer_cb_t cb;
+    void* arg;
+    volatile uint8_t state;
+};
+
+int soft_timer_init(soft_timer_t* timer, soft_timer_cb_t cb, void* arg);
+// fire after ticks (at least 1), then every period ticks if period is not 0
+int soft_timer_start(soft_timer_t* timer, uint32_t ticks, uint32_t period);
+int soft_timer_cancel(soft_timer_t* timer);
+
+static inline int soft_timer_is_active(const soft_timer_t* timer)
+{
+    return SOFT_TIMER_IDLE != timer->state;
+}
+
+// advance the wheel, called from the SysTick handler with the new tick
+void soft_timer_tick(uint64_t now);
+// ticks until the wheel needs the next tick, UINT32_MAX if it is empty
+uint32_t soft_timer_ticks_to_next(void);
+// run the callbacks of expired timers, return the number of callbacks run
+uint32_t soft_timer_run(void);
+// with the kernel enabled, run the callbacks in a dedicated task
+int soft_timer_service_start(void);
+
+#endif // __SOFT_TIMER_H__
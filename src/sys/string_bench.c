@@ -0,0 +1,342 @@
+/*
+@file: string_bench.c
+@author: ZZH
+@date: 2026-10-19
+@info: checks string_thumb.s against plain byte loops and times it for 1 B to
+       4 KiB, word aligned and misaligned
+*/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bench.h"
+#include "tiny_console/tiny_console.h"
+#include "tiny_console/tiny_console_cmd.h"
+
+// the 4 KiB cases need 8 KiB of heap, more than the QEMU image has
+#ifndef CONFIG_STR_BENCH_4K
+#define CONFIG_STR_BENCH_4K 1
+#endif
+
+// lengths 0 to CHECK_SHORT, then a few that run through the block loops
+#define CHECK_SHORT 67
+#define CHECK_MAX   260
+#define CHECK_ARENA (CHECK_MAX * 2 + 16)
+
+typedef struct
+{
+    uint8_t* mem;
+    uint8_t* ref;
+    uint32_t seed;
+    uint32_t total;
+    uint32_t failed;
+} check_ctx_t;
+
+static const uint16_t check_long[] = {127, 128, 129, 255, 256, CHECK_MAX};
+
+// volatile keeps the compiler from turning the loops into calls of the
+// functions under test once builtins are on
+static void ref_move(uint8_t* dst, const uint8_t* src, uint32_t n)
+{
+    volatile uint8_t* d = dst;
+    const volatile uint8_t* s = src;
+
+    if (d < s) {
+        for (uint32_t i = 0; i < n; i++) d[i] = s[i];
+    } else {
+        for (uint32_t i = n; i > 0; i--) d[i - 1] = s[i - 1];
+    }
+}
+
+static void ref_set(uint8_t* dst, int c, uint32_t n)
+{
+    volatile uint8_t* d = dst;
+
+    for (uint32_t i = 0; i < n; i++) d[i] = (uint8_t) c;
+}
+
+static int ref_cmp(const uint8_t* a, const uint8_t* b, uint32_t n)
+{
+    const volatile uint8_t* x = a;
+    const volatile uint8_t* y = b;
+
+    for (uint32_t i = 0; i < n; i++) {
+        if (x[i] != y[i])
+            return x[i] - y[i];
+    }
+
+    return 0;
+}
+
+static int same_sign(int a, int b)
+{
+    return (a > 0) == (b > 0) && (a < 0) == (b < 0);
+}
+
+static void check_fill(check_ctx_t* ctx)
+{
+    for (uint32_t i = 0; i < CHECK_ARENA; i++) {
+        ctx->seed = ctx->seed * 1664525 + 1013904223;
+        ctx->mem[i] = ctx->ref[i] = ctx->seed >> 24;
+    }
+}
+
+// the whole arena, so a write outside [dst, dst + n) shows up too
+static int check_arena(const check_ctx_t* ctx)
+{
+    return 0 == ref_cmp(ctx->mem, ctx->ref, CHECK_ARENA);
+}
+
+static void check_result(console_t* this, check_ctx_t* ctx, int ok,
+                         const char* func, uint32_t n, uint32_t doff,
+                         uint32_t soff)
+{
+    ctx->total++;
+    if (ok)
+        return;
+
+    // only the first few, a broken routine fails almost every case
+    if (ctx->failed++ < 8)
+        console_println(this, "strcheck: %s n=%lu dst+%lu src+%lu wrong",
+                        func, n, doff, soff);
+}
+
+static void check_len(console_t* this, check_ctx_t* ctx, uint32_t n)
+{
+    for (uint32_t doff = 0; doff < 4; doff++) {
+        for (uint32_t soff = 0; soff < 4; soff++) {
+            uint8_t* dst = ctx->mem + CHECK_MAX + 8 + doff;
+            uint8_t* src = ctx->mem + soff;
+            uint32_t dpos = dst - ctx->mem;
+
+            check_fill(ctx);
+            void* ret = memcpy(dst, src, n);
+            ref_move(ctx->ref + dpos, ctx->ref + soff, n);
+            check_result(this, ctx, ret == dst && check_arena(ctx), "memcpy",
+                         n, doff, soff);
+
+            // overlapping both ways
+            for (int dir = 0; dir < 2; dir++) {
+                uint32_t from = dir ? 8 + soff : 8 + doff + soff + 1;
+                uint32_t to = dir ? 8 + doff + soff + 1 : 8 + soff;
+
+                check_fill(ctx);
+                ret = memmove(ctx->mem + to, ctx->mem + from, n);
+                ref_move(ctx->ref + to, ctx->ref + from, n);
+                check_result(this, ctx,
+                             ret == ctx->mem + to && check_arena(ctx),
+                             "memmove", n, to, from);
+            }
+
+            check_fill(ctx);
+            ref_move(dst, src, n);
+            ref_move(ctx->ref + dpos, ctx->ref + soff, n);
+            int res = memcmp(dst, src, n);
+            check_result(this, ctx, 0 == res, "memcmp", n, doff, soff);
+
+            if (n > 0) {
+                uint32_t pos = ctx->seed % n;
+
+                // a later difference in the same word must not decide
+                dst[pos] ^= 1U << (ctx->seed >> 29);
+                if (pos + 1 < n)
+                    dst[pos + 1] = ~src[pos + 1];
+                res = memcmp(dst, src, n);
+                check_result(this, ctx,
+                             0 != res && same_sign(res, ref_cmp(dst, src, n)),
+                             "memcmp", n, doff, soff);
+            }
+        }
+
+        uint8_t* dst = ctx->mem + doff;
+
+        check_fill(ctx);
+        void* ret = memset(dst, 0x1a5, n);
+        ref_set(ctx->ref + doff, 0x1a5, n);
+        check_result(this, ctx, ret == dst && check_arena(ctx), "memset", n,
+                     doff, 0);
+
+        check_fill(ctx);
+        ref_set(dst, 0x80, n);
+        dst[n] = 0;
+        check_result(this, ctx, strlen((const char*) dst) == n, "strlen", n,
+                     doff, 0);
+    }
+}
+
+CONSOLE_CMD_DEF(strcheck_cmd)
+{
+    CONSOLE_CMD_UNUSE_ARGS;
+
+    check_ctx_t ctx = {.seed = 1};
+
+    ctx.mem = malloc(CHECK_ARENA * 2);
+    if (NULL == ctx.mem) {
+        console_println(this, "strcheck: error=%d", -ENOMEM);
+        return -ENOMEM;
+    }
+    ctx.ref = ctx.mem + CHECK_ARENA;
+
+    for (uint32_t n = 0; n <= CHECK_SHORT; n++) check_len(this, &ctx, n);
+    for (uint32_t i = 0; i < sizeof(check_long) / sizeof(check_long[0]); i++)
+        check_len(this, &ctx, check_long[i]);
+
+    free(ctx.mem);
+
+    // the format of the test cases, tools/qemu_run.py counts both lines
+    console_println(this, "strcheck: passed [%lu/%lu]",
+                    ctx.total - ctx.failed, ctx.total);
+    if (ctx.failed)
+        console_println(this, "strcheck: failed [%lu/%lu]", ctx.failed,
+                        ctx.total);
+
+    return ctx.failed ? -EIO : 0;
+}
+
+EXPORT_CONSOLE_CMD("strcheck", strcheck_cmd,
+                   "check memcpy/memmove/memset/memcmp/strlen", NULL);
+
+typedef struct
+{
+    uint16_t len;
+    uint8_t dst_off;
+    uint8_t src_off;
+} str_bench_arg_t;
+
+static uint8_t* bench_mem;
+// results of memcmp and strlen, the calls are not dead code
+static volatile uint32_t bench_sink;
+
+static inline uint8_t* bench_src(const str_bench_arg_t* sa)
+{
+    return bench_mem + sa->src_off;
+}
+
+static inline uint8_t* bench_dst(const str_bench_arg_t* sa)
+{
+    return bench_mem + sa->len + 4 + sa->dst_off;
+}
+
+static int str_setup(const void* arg)
+{
+    const str_bench_arg_t* sa = arg;
+
+    // src and a copy of it at dst, 4 bytes of room for the offsets and the
+    // terminator of src
+    bench_mem = malloc(sa->len * 2 + 8);
+    if (NULL == bench_mem)
+        return BENCH_SKIP;
+
+    for (uint32_t i = 0; i < sa->len + 4U; i++)
+        bench_mem[i] = (uint8_t) (i % 255 + 1);
+    bench_src(sa)[sa->len] = 0;
+    ref_move(bench_dst(sa), bench_src(sa), sa->len);
+
+    return 0;
+}
+
+static void str_teardown(const void* arg)
+{
+    (void) arg;
+
+    free(bench_mem);
+    bench_mem = NULL;
+}
+
+static void memcpy_run(const void* arg)
+{
+    const str_bench_arg_t* sa = arg;
+
+    memcpy(bench_dst(sa), bench_src(sa), sa->len);
+}
+
+// dst above src and overlapping, the top down path
+static void memmove_run(const void* arg)
+{
+    const str_bench_arg_t* sa = arg;
+
+    memmove(bench_src(sa) + 4 + sa->dst_off, bench_src(sa), sa->len);
+}
+
+static void memset_run(const void* arg)
+{
+    const str_bench_arg_t* sa = arg;
+
+    memset(bench_dst(sa), 0, sa->len);
+}
+
+// equal buffers, so the whole length is compared
+static void memcmp_run(const void* arg)
+{
+    const str_bench_arg_t* sa = arg;
+
+    bench_sink = memcmp(bench_dst(sa), bench_src(sa), sa->len);
+}
+
+static void strlen_run(const void* arg)
+{
+    const str_bench_arg_t* sa = arg;
+
+    bench_sink = strlen((const char*) bench_src(sa));
+}
+
+// 'a' cases are word aligned, 'u' ones have dst + 1 and src + 3
+#define STR_OFF_a 0, 0
+#define STR_OFF_u 1, 3
+#define STR_ARG(len, off) {len, STR_OFF_##off}
+
+#define STR_BENCH(func, len, off)                                          \
+    static const str_bench_arg_t func##_##len##_##off##_arg =              \
+        STR_ARG(len, off);                                                 \
+    BENCH_DEF(func##_##len##_##off, .arg = &func##_##len##_##off##_arg,    \
+              .setup = str_setup, .run = func##_run,                       \
+              .teardown = str_teardown, .flags = BENCH_IRQ_OFF)
+
+STR_BENCH(memcpy, 1, a);
+STR_BENCH(memcpy, 16, a);
+STR_BENCH(memcpy, 64, a);
+STR_BENCH(memcpy, 256, a);
+STR_BENCH(memcpy, 1024, a);
+#if CONFIG_STR_BENCH_4K == 1
+STR_BENCH(memcpy, 4096, a);
+#endif
+STR_BENCH(memcpy, 1, u);
+STR_BENCH(memcpy, 16, u);
+STR_BENCH(memcpy, 64, u);
+STR_BENCH(memcpy, 256, u);
+STR_BENCH(memcpy, 1024, u);
+#if CONFIG_STR_BENCH_4K == 1
+STR_BENCH(memcpy, 4096, u);
+#endif
+
+STR_BENCH(memset, 1, a);
+STR_BENCH(memset, 16, a);
+STR_BENCH(memset, 64, a);
+STR_BENCH(memset, 256, a);
+STR_BENCH(memset, 1024, a);
+#if CONFIG_STR_BENCH_4K == 1
+STR_BENCH(memset, 4096, a);
+#endif
+STR_BENCH(memset, 1, u);
+STR_BENCH(memset, 16, u);
+STR_BENCH(memset, 64, u);
+STR_BENCH(memset, 256, u);
+STR_BENCH(memset, 1024, u);
+#if CONFIG_STR_BENCH_4K == 1
+STR_BENCH(memset, 4096, u);
+#endif
+
+STR_BENCH(memmove, 64, a);
+STR_BENCH(memmove, 1024, a);
+STR_BENCH(memmove, 64, u);
+STR_BENCH(memmove, 1024, u);
+
+STR_BENCH(memcmp, 64, a);
+STR_BENCH(memcmp, 1024, a);
+STR_BENCH(memcmp, 64, u);
+STR_BENCH(memcmp, 1024, u);
+
+STR_BENCH(strlen, 16, a);
+STR_BENCH(strlen, 256, a);
+STR_BENCH(strlen, 16, u);
+STR_BENCH(strlen, 256, u);
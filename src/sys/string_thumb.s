@@ -0,0 +1,274 @@
+/*
+@file: string_thumb.s
+@author: ZZH
+@date: 2026-10-19
+@info: memcpy, memmove, memset, memcmp and strlen for the Cortex-M3, they
+       replace the byte loops of newlib-nano. the M3 does unaligned single
+       word LDR/STR in hardware, LDM/STM need word aligned addresses
+*/
+
+    .syntax unified
+    .thumb
+
+/* void* memcpy(void* dst, const void* src, size_t n) */
+    .section .text.memcpy, "ax", %progbits
+    .p2align 2
+    .global memcpy
+    .type memcpy, %function
+    .thumb_func
+memcpy:
+    push    {r0, lr}
+    cmp     r2, #8
+    blo     .Lcpy_tail
+
+    @ byte copies until dst is word aligned, at most 3 of the 8 bytes
+.Lcpy_align:
+    tst     r0, #3
+    beq     .Lcpy_dst_aligned
+    ldrb    r3, [r1], #1
+    strb    r3, [r0], #1
+    subs    r2, r2, #1
+    b       .Lcpy_align
+
+.Lcpy_dst_aligned:
+    tst     r1, #3
+    bne     .Lcpy_unaligned
+
+    @ both aligned, 32 bytes per LDM/STM pair
+    subs    r2, r2, #32
+    blo     .Lcpy_words_pre
+    push    {r4-r9}
+.Lcpy_block:
+    ldmia   r1!, {r3-r9, r12}
+    stmia   r0!, {r3-r9, r12}
+    subs    r2, r2, #32
+    bhs     .Lcpy_block
+    pop     {r4-r9}
+.Lcpy_words_pre:
+    adds    r2, r2, #32
+    b       .Lcpy_words
+
+    @ src is off by 1 to 3 bytes, unaligned loads and aligned STM
+.Lcpy_unaligned:
+    subs    r2, r2, #8
+    blo     .Lcpy_unaligned_done
+.Lcpy_unaligned_block:
+    ldr     r3, [r1], #4
+    ldr     r12, [r1], #4
+    stmia   r0!, {r3, r12}
+    subs    r2, r2, #8
+    bhs     .Lcpy_unaligned_block
+.Lcpy_unaligned_done:
+    adds    r2, r2, #8
+
+    @ r2 < 32 bytes left, words first
+.Lcpy_words:
+    subs    r2, r2, #4
+    blo     .Lcpy_words_done
+.Lcpy_word:
+    ldr     r3, [r1], #4
+    str     r3, [r0], #4
+    subs    r2, r2, #4
+    bhs     .Lcpy_word
+.Lcpy_words_done:
+    adds    r2, r2, #4
+
+.Lcpy_tail:
+    cbz     r2, .Lcpy_done
+.Lcpy_byte:
+    ldrb    r3, [r1], #1
+    strb    r3, [r0], #1
+    subs    r2, r2, #1
+    bne     .Lcpy_byte
+.Lcpy_done:
+    pop     {r0, pc}
+    .size memcpy, . - memcpy
+
+/* void* memmove(void* dst, const void* src, size_t n) */
+    .section .text.memmove, "ax", %progbits
+    .p2align 2
+    .global memmove
+    .type memmove, %function
+    .thumb_func
+memmove:
+    @ dst - src >= n (unsigned) when dst is below src or past its end
+    subs    r3, r0, r1
+    cmp     r3, r2
+    bhs     memcpy
+
+    @ dst overlaps the end of src, copy from the top down
+    push    {r0, lr}
+    add     r0, r0, r2
+    add     r1, r1, r2
+    cmp     r2, #8
+    blo     .Lmove_tail
+
+.Lmove_align:
+    tst     r0, #3
+    beq     .Lmove_aligned
+    ldrb    r3, [r1, #-1]!
+    strb    r3, [r0, #-1]!
+    subs    r2, r2, #1
+    b       .Lmove_align
+
+    @ both words are loaded before the first store, dst is above src
+.Lmove_aligned:
+    subs    r2, r2, #8
+    blo     .Lmove_words_done
+.Lmove_block:
+    ldr     r12, [r1, #-4]!
+    ldr     r3, [r1, #-4]!
+    stmdb   r0!, {r3, r12}
+    subs    r2, r2, #8
+    bhs     .Lmove_block
+.Lmove_words_done:
+    adds    r2, r2, #8
+
+.Lmove_tail:
+    cbz     r2, .Lmove_done
+.Lmove_byte:
+    ldrb    r3, [r1, #-1]!
+    strb    r3, [r0, #-1]!
+    subs    r2, r2, #1
+    bne     .Lmove_byte
+.Lmove_done:
+    pop     {r0, pc}
+    .size memmove, . - memmove
+
+/* void* memset(void* dst, int c, size_t n) */
+    .section .text.memset, "ax", %progbits
+    .p2align 2
+    .global memset
+    .type memset, %function
+    .thumb_func
+memset:
+    mov     r3, r0
+    and     r1, r1, #0xff
+    cmp     r2, #8
+    blo     .Lset_tail
+    orr     r1, r1, r1, lsl #8
+    orr     r1, r1, r1, lsl #16
+
+.Lset_align:
+    tst     r3, #3
+    beq     .Lset_aligned
+    strb    r1, [r3], #1
+    subs    r2, r2, #1
+    b       .Lset_align
+
+.Lset_aligned:
+    mov     r12, r1
+    subs    r2, r2, #32
+    blo     .Lset_words_pre
+    push    {r4, lr}
+    mov     r4, r1
+    mov     lr, r1
+.Lset_block:
+    stmia   r3!, {r1, r4, r12, lr}
+    stmia   r3!, {r1, r4, r12, lr}
+    subs    r2, r2, #32
+    bhs     .Lset_block
+    pop     {r4, lr}
+.Lset_words_pre:
+    adds    r2, r2, #32
+
+.Lset_word:
+    cmp     r2, #4
+    blo     .Lset_tail
+    str     r1, [r3], #4
+    subs    r2, r2, #4
+    b       .Lset_word
+
+.Lset_tail:
+    cbz     r2, .Lset_done
+.Lset_byte:
+    strb    r1, [r3], #1
+    subs    r2, r2, #1
+    bne     .Lset_byte
+.Lset_done:
+    bx      lr
+    .size memset, . - memset
+
+/* int memcmp(const void* a, const void* b, size_t n) */
+    .section .text.memcmp, "ax", %progbits
+    .p2align 2
+    .global memcmp
+    .type memcmp, %function
+    .thumb_func
+memcmp:
+    subs    r2, r2, #4
+    blo     .Lcmp_words_done
+.Lcmp_word:
+    ldr     r3, [r0], #4
+    ldr     r12, [r1], #4
+    cmp     r3, r12
+    bne     .Lcmp_word_diff
+    subs    r2, r2, #4
+    bhs     .Lcmp_word
+.Lcmp_words_done:
+    adds    r2, r2, #4
+
+    cbz     r2, .Lcmp_equal
+.Lcmp_byte:
+    ldrb    r3, [r0], #1
+    ldrb    r12, [r1], #1
+    subs    r3, r3, r12
+    bne     .Lcmp_byte_diff
+    subs    r2, r2, #1
+    bne     .Lcmp_byte
+.Lcmp_equal:
+    movs    r0, #0
+    bx      lr
+.Lcmp_byte_diff:
+    mov     r0, r3
+    bx      lr
+
+    @ the lowest differing byte comes first in memory, REV moves it to
+    @ the top so an unsigned compare of the words decides
+.Lcmp_word_diff:
+    rev     r3, r3
+    rev     r12, r12
+    cmp     r3, r12
+    ite     hi
+    movhi   r0, #1
+    mvnls   r0, #0
+    bx      lr
+    .size memcmp, . - memcmp
+
+/* size_t strlen(const char* s) */
+    .section .text.strlen, "ax", %progbits
+    .p2align 2
+    .global strlen
+    .type strlen, %function
+    .thumb_func
+strlen:
+    mov     r1, r0
+.Lstrlen_align:
+    tst     r0, #3
+    beq     .Lstrlen_aligned
+    ldrb    r2, [r0], #1
+    cmp     r2, #0
+    bne     .Lstrlen_align
+    subs    r0, r0, r1
+    subs    r0, r0, #1
+    bx      lr
+
+    @ (w - 0x01010101) & ~w & 0x80808080 flags the first zero byte, an
+    @ aligned load never crosses into the next memory region
+.Lstrlen_aligned:
+    mov     r12, #0x01010101
+.Lstrlen_word:
+    ldr     r2, [r0], #4
+    sub     r3, r2, r12
+    bic     r3, r3, r2
+    ands    r3, r3, #0x80808080
+    beq     .Lstrlen_word
+
+    @ the lowest flag is the terminator, count the bytes before it
+    rbit    r3, r3
+    clz     r3, r3
+    subs    r0, r0, #4
+    add     r0, r0, r3, lsr #3
+    subs    r0, r0, r1
+    bx      lr
+    .size strlen, . - strlen
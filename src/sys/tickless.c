@@ -0,0 +1,153 @@
+/*
+@file: tickless.c
+@author: ZZH
+@date: 2026-10-19
+@info: stop the periodic tick while idle, SysTick is reprogrammed as a long
+       one-shot and the time base is corrected from the elapsed count
+*/
+
+#include "tickless.h"
+#include "timebase.h"
+#include "soft_timer.h"
+#include "stm32f10x.h"
+#include "kernel/kernel.h"
+#include "tiny_console/tiny_console.h"
+#include "tiny_console/tiny_console_cmd.h"
+
+static tickless_stats_t stats;
+
+static uint32_t ticks_to_next_deadline(void)
+{
+    uint32_t timer = soft_timer_ticks_to_next();
+    uint32_t task = kernel_is_running() ? kernel_ticks_to_next_wake()
+                                        : UINT32_MAX;
+
+    return timer < task ? timer : task;
+}
+
+void tickless_idle(void)
+{
+    // PRIMASK only defers the handlers, a pending interrupt still ends WFI
+    uint32_t key = kernel_irq_save();
+    uint32_t cpt = timebase_cycles_per_tick();
+    uint32_t expected = ticks_to_next_deadline();
+    uint32_t max_ticks = SysTick_LOAD_RELOAD_Msk / cpt;
+
+    if (expected > max_ticks)
+        expected = max_ticks;
+
+    if (!timebase_is_running() || expected < CONFIG_TICKLESS_MIN_TICKS) {
+        __DSB();
+        __WFI();
+        kernel_irq_restore(key);
+        return;
+    }
+
+    SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+
+    // the current tick ended while we were deciding, let it be handled
+    if (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) {
+        SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+        kernel_irq_restore(key);
+        return;
+    }
+
+    // wake at the tick boundary just before the deadline tick, VAL holds
+    // what is left of the current tick
+    uint32_t reload = SysTick->VAL + (expected - 1) * cpt;
+
+    SysTick->LOAD = reload;
+    SysTick->VAL = 0;
+    SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+
+    __DSB();
+    __WFI();
+    __ISB();
+
+    // reading CTRL also clears COUNTFLAG
+    uint32_t ctrl = SysTick->CTRL;
+    SysTick->CTRL = ctrl & ~SysTick_CTRL_ENABLE_Msk;
+
+    uint32_t done;
+
+    if (ctrl & SysTick_CTRL_COUNTFLAG_Msk) {
+        // slept up to the deadline, its tick interrupt is pending and will
+        // account for the last tick, resume in phase with the old ticks
+        uint32_t load = (cpt - 1) - (reload - SysTick->VAL);
+
+        if (load > cpt - 1)
+            load = cpt - 1;
+
+        SysTick->LOAD = load;
+        done = expected - 1;
+    } else {
+        // woken up by another interrupt, count whole ticks and keep the
+        // partial one running
+        uint32_t elapsed = expected * cpt - SysTick->VAL;
+
+        done = elapsed / cpt;
+
+        uint32_t remaining = (done + 1) * cpt - elapsed;
+        SysTick->LOAD = remaining > 1 ? remaining - 1 : 1;
+        stats.early_wakeups++;
+    }
+
+    SysTick->VAL = 0;
+    SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+    // takes effect on the next reload, after the partial tick above
+    SysTick->LOAD = cpt - 1;
+
+    timebase_step(done);
+
+    stats.sleeps++;
+    stats.suppressed_ticks += done;
+
+    kernel_irq_restore(key);
+}
+
+void tickless_get_stats(tickless_stats_t* out)
+{
+    uint32_t key = kernel_irq_save();
+    *out = stats;
+    kernel_irq_restore(key);
+}
+
+#if CONFIG_TICKLESS_IDLE == 1
+void kernel_idle_hook(void)
+{
+    tickless_idle();
+}
+#endif
+
+CONSOLE_CMD_DEF(tickless_info)
+{
+    CONSOLE_CMD_UNUSE_ARGS;
+
+    static uint64_t last_ticks, last_suppressed;
+
+    tickless_stats_t now;
+    uint64_t ticks = timebase_get_ticks();
+
+    tickless_get_stats(&now);
+
+    uint64_t window = ticks - last_ticks;
+    uint64_t avoided = now.suppressed_ticks - last_suppressed;
+
+    console_println(this, "sleeps: %lu, early wakeups: %lu", now.sleeps,
+                    now.early_wakeups);
+    console_println(this, "suppressed ticks: %lu of %lu",
+                    (uint32_t) now.suppressed_ticks, (uint32_t) ticks);
+
+    // wakeups avoided per second since the previous call of this command
+    if (0 != window)
+        console_println(this, "avoided wakeups: %lu/s",
+                        (uint32_t) (avoided * CONFIG_SYS_TICK_HZ / window));
+
+    last_ticks = ticks;
+    last_suppressed = now.suppressed_ticks;
+
+    return 0;
+}
+
+EXPORT_CONSOLE_CMD("tickless", tickless_info, "tickless idle statistics",
+                   NULL);
@@ -0,0 +1,33 @@
+/*
+@file: tickless.h
+@author: ZZH
+@date: 2026-10-19
+@info: tickless idle, suppress the SysTick interrupts until the next
+       software timer or kernel deadline
+*/
+
+#ifndef __TICKLESS_H__
+#define __TICKLESS_H__
+
+#include <stdint.h>
+
+// below this many idle ticks a plain WFI is cheaper than reprogramming
+#ifndef CONFIG_TICKLESS_MIN_TICKS
+#define CONFIG_TICKLESS_MIN_TICKS 2
+#endif
+
+typedef struct
+{
+    // number of times the core went to sleep through tickless_idle()
+    uint32_t sleeps;
+    // sleeps cut short by an interrupt before the programmed deadline
+    uint32_t early_wakeups;
+    // tick interrupts that did not happen
+    uint64_t suppressed_ticks;
+} tickless_stats_t;
+
+// sleep until the next deadline or any interrupt, call from the idle path
+void tickless_idle(void);
+void tickless_get_stats(tickless_stats_t* stats);
+
+#endif // __TICKLESS_H__
@@ -0,0 +1,157 @@
+/*
+@file: timebase.c
+@author: ZZH
+@date: 2026-10-19
+@info: SysTick owns the tick, the SysTick down counter (one count per core
+       clock) provides the sub-tick part
+*/
+
+#include "timebase.h"
+#include "soft_timer.h"
+#include "arm_isr_attr.h"
+#include "stm32f10x.h"
+#include "kernel/kernel.h"
+#include "hal/clock/sysclk.h"
+
+static volatile uint64_t tick_count;
+static volatile uint8_t running;
+static uint32_t cycles_per_tick;
+// the part of a tick that had elapsed when the clock changed, in cycles of
+// the new clock, below cycles_per_tick
+static uint32_t tick_carry;
+
+static void timebase_advance(uint32_t ticks);
+
+// the tick keeps its length across a system clock change, the cycle count
+// returned by timebase_get_cycles does not
+static int timebase_clock_notify(sysclk_notifier_t* nb, sysclk_event_t event,
+                                 const sysclk_freq_t* from,
+                                 const sysclk_freq_t* to)
+{
+    (void) nb;
+    (void) from;
+
+    if (SYSCLK_POST_CHANGE != event)
+        return 0;
+
+    uint32_t key = kernel_irq_save();
+
+    // writing VAL clears it, keep the elapsed part of the current tick.
+    // VAL ran at the new clock since the switch, so this is a close
+    // estimate rather than exact
+    uint32_t old_cycles = cycles_per_tick;
+    uint32_t elapsed = tick_carry + (old_cycles - 1) - SysTick->VAL;
+
+    cycles_per_tick = to->hclk / CONFIG_SYS_TICK_HZ;
+    uint64_t carry = (uint64_t) elapsed * cycles_per_tick / old_cycles;
+
+    if (carry >= cycles_per_tick)
+        timebase_advance(carry / cycles_per_tick);
+    tick_carry = carry % cycles_per_tick;
+
+    SysTick->LOAD = cycles_per_tick - 1;
+    SysTick->VAL = 0;
+
+    kernel_irq_restore(key);
+
+    return 0;
+}
+
+static sysclk_notifier_t timebase_clock_nb = {
+    .notify = timebase_clock_notify,
+};
+
+int timebase_init(void)
+{
+    if (running)
+        return 0;
+
+    SystemCoreClockUpdate();
+
+    cycles_per_tick = SystemCoreClock / CONFIG_SYS_TICK_HZ;
+
+    if (0 != SysTick_Config(cycles_per_tick))
+        return -EINVAL;
+
+    sysclk_register_notifier(&timebase_clock_nb);
+    running = 1;
+
+    return 0;
+}
+
+int timebase_is_running(void)
+{
+    return running;
+}
+
+uint64_t timebase_get_ticks(void)
+{
+    uint64_t ticks;
+
+    // the 64-bit counter is written by the SysTick handler in two halves
+    do {
+        ticks = tick_count;
+    } while (ticks != tick_count);
+
+    return ticks;
+}
+
+// LOAD is reprogrammed while the tick is suppressed, keep our own copy
+uint32_t timebase_cycles_per_tick(void)
+{
+    return cycles_per_tick;
+}
+
+uint64_t timebase_get_cycles(void)
+{
+    uint64_t ticks;
+    uint32_t val, pending, carry;
+
+    do {
+        ticks = timebase_get_ticks();
+        carry = tick_carry;
+        val = SysTick->VAL;
+        pending = SCB->ICSR & SCB_ICSR_PENDSTSET_Msk;
+    } while (ticks != timebase_get_ticks());
+
+    // the counter reloaded but the handler could not run yet (masked or
+    // nested), a large value means VAL was sampled after the reload.
+    // not LOAD: tickless reprograms it, but always so that VAL reaches 0
+    // on a tick boundary
+    uint32_t top = cycles_per_tick - 1;
+    if (pending && val > top / 2)
+        ticks++;
+
+    return ticks * cycles_per_tick + carry + (top - val);
+}
+
+uint64_t timebase_get_us(void)
+{
+    return timebase_get_cycles() / (SystemCoreClock / 1000000);
+}
+
+static void timebase_advance(uint32_t ticks)
+{
+    uint64_t now = tick_count + ticks;
+
+    tick_count = now;
+    soft_timer_tick(now);
+
+    if (kernel_is_running())
+        kernel_tick_step(ticks);
+}
+
+void timebase_step(uint32_t ticks)
+{
+    uint32_t key = kernel_irq_save();
+
+    if (0 != ticks)
+        timebase_advance(ticks);
+
+    kernel_irq_restore(key);
+}
+
+void ARM_IRQ SysTick_Handler(void)
+{
+    timebase_advance(1);
+}
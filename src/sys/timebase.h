@@ -0,0 +1,35 @@
+/*
+@file: timebase.h
+@author: ZZH
+@date: 2026-10-19
+@info: 64-bit monotonic time base driven by SysTick
+*/
+
+#ifndef __TIMEBASE_H__
+#define __TIMEBASE_H__
+
+#include <errno.h>
+#include <stdint.h>
+
+#ifndef CONFIG_SYS_TICK_HZ
+#define CONFIG_SYS_TICK_HZ 1000
+#endif
+
+#define TIMEBASE_MS_TO_TICKS(ms) \
+    ((uint32_t) (((uint64_t) (ms) * CONFIG_SYS_TICK_HZ + 999) / 1000))
+
+// start SysTick at CONFIG_SYS_TICK_HZ, calling it again is harmless
+int timebase_init(void);
+int timebase_is_running(void);
+
+uint64_t timebase_get_ticks(void);
+// core clock cycles since the time base started, sub-tick resolution
+uint64_t timebase_get_cycles(void);
+uint64_t timebase_get_us(void);
+
+uint32_t timebase_cycles_per_tick(void);
+
+// account for ticks whose interrupts were suppressed (tickless idle)
+void timebase_step(uint32_t ticks);
+
+#endif // __TIMEBASE_H__
@@ -0,0 +1,362 @@
+/*
+@file: tlsf.c
+@author: ZZH
+@date: 2026-10-19
+@info: every block starts with a two word header, the free list links live
+       in the payload of free blocks, a zero sized used block at the end of
+       the pool stops the merging
+*/
+
+#include <string.h>
+#include "tlsf.h"
+#include "arg_checkers.h"
+
+#define BLOCK_FREE      0x1U
+#define BLOCK_PREV_FREE 0x2U
+#define BLOCK_FLAGS     (BLOCK_FREE | BLOCK_PREV_FREE)
+
+#define BLOCK_HDR_SIZE ((uint32_t) offsetof(tlsf_block_t, next_free))
+// room for the free list links
+#define BLOCK_MIN_SIZE ((uint32_t) sizeof(tlsf_block_t) - BLOCK_HDR_SIZE)
+#define BLOCK_MAX_SIZE (1UL << CONFIG_TLSF_FL_MAX)
+#define SMALL_SIZE     (1U << TLSF_FL_SHIFT)
+
+struct tlsf_block
+{
+    // only valid while the previous block is free
+    tlsf_block_t* prev_phys;
+    // payload size, the low bits hold the flags
+    uint32_t size;
+    // payload of a free block
+    tlsf_block_t* next_free;
+    tlsf_block_t* prev_free;
+};
+
+_Static_assert(0 == offsetof(tlsf_block_t, next_free) % TLSF_ALIGN,
+               "payloads would lose their alignment");
+
+static inline uint32_t fls32(uint32_t x)
+{
+    return 31 - __builtin_clz(x);
+}
+
+static inline uint32_t block_size(const tlsf_block_t* b)
+{
+    return b->size & ~BLOCK_FLAGS;
+}
+
+static inline void* block_payload(const tlsf_block_t* b)
+{
+    return (char*) b + BLOCK_HDR_SIZE;
+}
+
+static inline tlsf_block_t* block_from_payload(const void* ptr)
+{
+    return (tlsf_block_t*) ((char*) ptr - BLOCK_HDR_SIZE);
+}
+
+static inline tlsf_block_t* block_next(const tlsf_block_t* b)
+{
+    return (tlsf_block_t*) ((char*) block_payload(b) + block_size(b));
+}
+
+static inline void mapping(uint32_t size, uint32_t* fl, uint32_t* sl)
+{
+    if (size < SMALL_SIZE) {
+        *fl = 0;
+        *sl = size / (SMALL_SIZE / TLSF_SL_COUNT);
+    } else {
+        uint32_t top = fls32(size);
+
+        *sl = (size >> (top - CONFIG_TLSF_SL_LOG2)) ^ TLSF_SL_COUNT;
+        *fl = top - TLSF_FL_SHIFT + 1;
+    }
+}
+
+// round up to the next list so any block found there is large enough
+static inline void mapping_search(uint32_t size, uint32_t* fl, uint32_t* sl)
+{
+    if (size >= SMALL_SIZE)
+        size += (1U << (fls32(size) - CONFIG_TLSF_SL_LOG2)) - 1;
+
+    mapping(size, fl, sl);
+}
+
+static void free_insert(tlsf_t* tlsf, tlsf_block_t* b)
+{
+    uint32_t fl, sl;
+    mapping(block_size(b), &fl, &sl);
+
+    tlsf_block_t* head = tlsf->free[fl][sl];
+
+    b->next_free = head;
+    b->prev_free = NULL;
+    if (NULL != head)
+        head->prev_free = b;
+
+    tlsf->free[fl][sl] = b;
+    tlsf->fl_bitmap |= 1U << fl;
+    tlsf->sl_bitmap[fl] |= 1U << sl;
+}
+
+static void free_remove(tlsf_t* tlsf, tlsf_block_t* b)
+{
+    uint32_t fl, sl;
+    mapping(block_size(b), &fl, &sl);
+
+    if (NULL != b->next_free)
+        b->next_free->prev_free = b->prev_free;
+
+    if (NULL != b->prev_free) {
+        b->prev_free->next_free = b->next_free;
+        return;
+    }
+
+    tlsf->free[fl][sl] = b->next_free;
+    if (NULL == b->next_free) {
+        tlsf->sl_bitmap[fl] &= ~(1U << sl);
+        if (0 == tlsf->sl_bitmap[fl])
+            tlsf->fl_bitmap &= ~(1U << fl);
+    }
+}
+
+static tlsf_block_t* free_find(tlsf_t* tlsf, uint32_t size)
+{
+    uint32_t fl, sl;
+    mapping_search(size, &fl, &sl);
+
+    if (fl >= TLSF_FL_COUNT)
+        return NULL;
+
+    uint32_t sl_map = tlsf->sl_bitmap[fl] & (~0U << sl);
+
+    if (0 == sl_map) {
+        uint32_t fl_map = tlsf->fl_bitmap & (~0U << (fl + 1));
+        if (0 == fl_map)
+            return NULL;
+
+        fl = __builtin_ctz(fl_map);
+        sl_map = tlsf->sl_bitmap[fl];
+    }
+
+    return tlsf->free[fl][__builtin_ctz(sl_map)];
+}
+
+static inline void block_set_used(tlsf_block_t* b)
+{
+    b->size &= ~BLOCK_FREE;
+    block_next(b)->size &= ~BLOCK_PREV_FREE;
+}
+
+static inline void block_set_free(tlsf_block_t* b)
+{
+    tlsf_block_t* next = block_next(b);
+
+    b->size |= BLOCK_FREE;
+    next->size |= BLOCK_PREV_FREE;
+    next->prev_phys = b;
+}
+
+// cut the tail off a block if it is large enough to stand on its own
+static void block_trim(tlsf_t* tlsf, tlsf_block_t* b, uint32_t size)
+{
+    uint32_t total = block_size(b);
+
+    if (total < size + BLOCK_HDR_SIZE + BLOCK_MIN_SIZE)
+        return;
+
+    tlsf_block_t* rest = (tlsf_block_t*) ((char*) block_payload(b) + size);
+
+    rest->size = total - size - BLOCK_HDR_SIZE;
+    b->size = size | (b->size & BLOCK_FLAGS);
+
+    // a trimmed block is always in use, so rest never merges backwards
+    block_set_free(rest);
+    tlsf_block_t* next = block_next(rest);
+    if (next->size & BLOCK_FREE) {
+        free_remove(tlsf, next);
+        rest->size += BLOCK_HDR_SIZE + block_size(next);
+        block_set_free(rest);
+    }
+
+    free_insert(tlsf, rest);
+}
+
+static inline uint32_t adjust_size(size_t size)
+{
+    if (0 == size || size > BLOCK_MAX_SIZE)
+        return 0;
+
+    size = (size + TLSF_ALIGN - 1) & ~(size_t) (TLSF_ALIGN - 1);
+
+    return size < BLOCK_MIN_SIZE ? BLOCK_MIN_SIZE : size;
+}
+
+int tlsf_init(tlsf_t* tlsf, void* mem, size_t size)
+{
+    CHECK_PTR(tlsf, -EINVAL);
+    CHECK_PTR(mem, -EINVAL);
+
+    memset(tlsf, 0, sizeof(*tlsf));
+
+    uintptr_t start = ((uintptr_t) mem + TLSF_ALIGN - 1) &
+                      ~(uintptr_t) (TLSF_ALIGN - 1);
+    uintptr_t end = ((uintptr_t) mem + size) & ~(uintptr_t) (TLSF_ALIGN - 1);
+
+    // first block header, its payload and the sentinel header
+    RETURN_IF(end < start + 2 * BLOCK_HDR_SIZE + BLOCK_MIN_SIZE, -EINVAL);
+
+    uint32_t payload = end - start - 2 * BLOCK_HDR_SIZE;
+    RETURN_IF(payload >= BLOCK_MAX_SIZE, -E2BIG);
+
+    tlsf_block_t* b = (tlsf_block_t*) start;
+    b->prev_phys = NULL;
+    b->size = payload;
+
+    tlsf_block_t* sentinel = block_next(b);
+    sentinel->size = 0;
+
+    block_set_free(b);
+    free_insert(tlsf, b);
+
+    tlsf->total = end - start;
+    // the sentinel never becomes free
+    tlsf->used = BLOCK_HDR_SIZE;
+    tlsf->peak = tlsf->used;
+
+    return 0;
+}
+
+void* tlsf_malloc(tlsf_t* tlsf, size_t size)
+{
+    uint32_t adjusted = adjust_size(size);
+    tlsf_block_t* b = NULL;
+
+    if (NULL != tlsf && 0 != adjusted)
+        b = free_find(tlsf, adjusted);
+
+    if (NULL == b) {
+        if (NULL != tlsf)
+            tlsf->fails++;
+        return NULL;
+    }
+
+    free_remove(tlsf, b);
+    block_set_used(b);
+    block_trim(tlsf, b, adjusted);
+
+    tlsf->used += BLOCK_HDR_SIZE + block_size(b);
+    if (tlsf->used > tlsf->peak)
+        tlsf->peak = tlsf->used;
+    tlsf->allocs++;
+
+    return block_payload(b);
+}
+
+void tlsf_free(tlsf_t* tlsf, void* ptr)
+{
+    if (NULL == tlsf || NULL == ptr)
+        return;
+
+    tlsf_block_t* b = block_from_payload(ptr);
+
+    tlsf->used -= BLOCK_HDR_SIZE + block_size(b);
+
+    if (b->size & BLOCK_PREV_FREE) {
+        tlsf_block_t* prev = b->prev_phys;
+
+        free_remove(tlsf, prev);
+        prev->size += BLOCK_HDR_SIZE + block_size(b);
+        b = prev;
+    }
+
+    tlsf_block_t* next = block_next(b);
+    if (next->size & BLOCK_FREE) {
+        free_remove(tlsf, next);
+        b->size += BLOCK_HDR_SIZE + block_size(next);
+    }
+
+    block_set_free(b);
+    free_insert(tlsf, b);
+}
+
+void* tlsf_realloc(tlsf_t* tlsf, void* ptr, size_t size)
+{
+    if (NULL == ptr)
+        return tlsf_malloc(tlsf, size);
+
+    if (0 == size) {
+        tlsf_free(tlsf, ptr);
+        return NULL;
+    }
+
+    uint32_t adjusted = adjust_size(size);
+    if (NULL == tlsf || 0 == adjusted)
+        return NULL;
+
+    tlsf_block_t* b = block_from_payload(ptr);
+    tlsf_block_t* next = block_next(b);
+    uint32_t cur = block_size(b);
+
+    if (adjusted > cur && (next->size & BLOCK_FREE) &&
+        cur + BLOCK_HDR_SIZE + block_size(next) >= adjusted) {
+        free_remove(tlsf, next);
+        b->size += BLOCK_HDR_SIZE + block_size(next);
+        block_set_used(b);
+    }
+
+    if (adjusted <= block_size(b)) {
+        block_trim(tlsf, b, adjusted);
+
+        tlsf->used += block_size(b) - cur;
+        if (tlsf->used > tlsf->peak)
+            tlsf->peak = tlsf->used;
+
+        return ptr;
+    }
+
+    void* moved = tlsf_malloc(tlsf, size);
+    if (NULL != moved) {
+        memcpy(moved, ptr, cur);
+        tlsf_free(tlsf, ptr);
+    }
+
+    return moved;
+}
+
+size_t tlsf_block_size(const void* ptr)
+{
+    return NULL == ptr ? 0 : block_size(block_from_payload(ptr));
+}
+
+void tlsf_get_stats(const tlsf_t* tlsf, tlsf_stats_t* stats)
+{
+    if (NULL == tlsf || NULL == stats)
+        return;
+
+    memset(stats, 0, sizeof(*stats));
+
+    for (uint32_t fl = 0; fl < TLSF_FL_COUNT; fl++) {
+        for (uint32_t sl = 0; sl < TLSF_SL_COUNT; sl++) {
+            for (const tlsf_block_t* b = tlsf->free[fl][sl]; NULL != b;
+                 b = b->next_free) {
+                stats->free_blocks++;
+                if (block_size(b) > stats->largest_free)
+                    stats->largest_free = block_size(b);
+            }
+        }
+    }
+
+    stats->total = tlsf->total;
+    stats->used = tlsf->used;
+    stats->peak = tlsf->peak;
+    stats->allocs = tlsf->allocs;
+    stats->fails = tlsf->fails;
+
+    // headers of the free blocks count as free memory as well
+    uint32_t free_bytes = tlsf->total - tlsf->used;
+    if (0 != free_bytes) {
+        uint32_t largest = stats->largest_free + BLOCK_HDR_SIZE;
+        stats->frag_permille = 1000 - (uint64_t) largest * 1000 / free_bytes;
+    }
+}
@@ -0,0 +1,76 @@
+/*
+@file: tlsf.h
+@author: ZZH
+@date: 2026-10-19
+@info: two level segregated fit allocator, malloc and free are O(1)
+
+Free blocks live on lists indexed by the position of their top bit (first
+level) and the next CONFIG_TLSF_SL_LOG2 bits (second level). Two bitmaps
+find the smallest non-empty list that fits a request without any search.
+*/
+
+#ifndef __TLSF_H__
+#define __TLSF_H__
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef CONFIG_TLSF_SL_LOG2
+#define CONFIG_TLSF_SL_LOG2 3
+#endif
+
+// largest pool is 2^CONFIG_TLSF_FL_MAX bytes
+#ifndef CONFIG_TLSF_FL_MAX
+#define CONFIG_TLSF_FL_MAX 17
+#endif
+
+#define TLSF_ALIGN_LOG2 3
+#define TLSF_ALIGN      (1U << TLSF_ALIGN_LOG2)
+#define TLSF_SL_COUNT   (1U << CONFIG_TLSF_SL_LOG2)
+#define TLSF_FL_SHIFT   (CONFIG_TLSF_SL_LOG2 + TLSF_ALIGN_LOG2)
+#define TLSF_FL_COUNT   (CONFIG_TLSF_FL_MAX - TLSF_FL_SHIFT + 1)
+
+typedef struct tlsf_block tlsf_block_t;
+
+typedef struct
+{
+    uint32_t fl_bitmap;
+    uint32_t sl_bitmap[TLSF_FL_COUNT];
+    tlsf_block_t* free[TLSF_FL_COUNT][TLSF_SL_COUNT];
+
+    // headers included
+    uint32_t total;
+    uint32_t used;
+    uint32_t peak;
+    uint32_t allocs;
+    uint32_t fails;
+} tlsf_t;
+
+typedef struct
+{
+    uint32_t total;
+    uint32_t used;
+    uint32_t peak;
+    uint32_t free_blocks;
+    uint32_t largest_free;
+    // 0 when all free memory is one block, 1000 when it is all crumbs
+    uint32_t frag_permille;
+    uint32_t allocs;
+    uint32_t fails;
+} tlsf_stats_t;
+
+int tlsf_init(tlsf_t* tlsf, void* mem, size_t size);
+
+// the result is aligned to TLSF_ALIGN
+void* tlsf_malloc(tlsf_t* tlsf, size_t size);
+void tlsf_free(tlsf_t* tlsf, void* ptr);
+// grows in place into a free neighbour before moving
+void* tlsf_realloc(tlsf_t* tlsf, void* ptr, size_t size);
+
+size_t tlsf_block_size(const void* ptr);
+
+// walks the free lists, not O(1)
+void tlsf_get_stats(const tlsf_t* tlsf, tlsf_stats_t* stats);
+
+#endif // __TLSF_H__
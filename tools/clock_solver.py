@@ -0,0 +1,153 @@
+#! env python
+# Solve the STM32F10x clock tree for the frequencies asked for in the cross
+# file and emit a header with the register values and resulting clocks.
+from argparse import ArgumentParser
+import sys
+
+HSI_HZ = 8000000
+SYSCLK_MAX_HZ = 72000000
+PLL_MULS = range(2, 17)
+APB_DIVS = {1: 0b000, 2: 0b100, 4: 0b101, 8: 0b110, 16: 0b111}
+ADC_DIVS = {2: 0b00, 4: 0b01, 6: 0b10, 8: 0b11}
+
+# CFGR fields
+SW_HSE = 0x1
+SW_PLL = 0x2
+PPRE1_POS = 8
+PPRE2_POS = 11
+ADCPRE_POS = 14
+PLLSRC = 1 << 16
+PLLXTPRE = 1 << 17
+PLLMUL_POS = 18
+USBPRE = 1 << 22
+
+
+def process_args():
+    parser = ArgumentParser('clock_solver', description='solve the clock tree')
+    parser.add_argument('--hse', type=int, default=0, help='HSE in Hz, 0 for none')
+    parser.add_argument('--sysclk', type=int, required=True)
+    parser.add_argument('--apb1-max', type=int, default=36000000)
+    parser.add_argument('--apb2-max', type=int, default=72000000)
+    parser.add_argument('--adc-max', type=int, default=14000000)
+    parser.add_argument('--usb', type=int, default=0, help='48000000 when USB is used')
+    parser.add_argument('-o', '--output', required=True)
+
+    return parser.parse_args()
+
+
+def pll_sources(hse):
+    # (name, input Hz, CFGR bits), HSE first so it wins over HSI
+    if hse:
+        yield 'HSE', hse, PLLSRC
+        yield 'HSE/2', hse // 2, PLLSRC | PLLXTPRE
+    yield 'HSI/2', HSI_HZ // 2, 0
+
+
+def solve_sysclk(args):
+    if args.sysclk > SYSCLK_MAX_HZ:
+        raise ValueError('SYSCLK above %d Hz' % SYSCLK_MAX_HZ)
+
+    if args.sysclk == args.hse and not args.usb:
+        return {'src': 'HSE', 'cfgr': SW_HSE, 'pll': None}
+
+    if args.sysclk == HSI_HZ and not args.usb:
+        return {'src': 'HSI', 'cfgr': 0, 'pll': None}
+
+    for name, fin, bits in pll_sources(args.hse):
+        for mul in PLL_MULS:
+            if fin * mul != args.sysclk:
+                continue
+
+            cfgr = SW_PLL | bits | ((mul - 2) << PLLMUL_POS)
+
+            if args.usb:
+                # USB takes PLL/1 or PLL/1.5
+                if args.sysclk == args.usb:
+                    cfgr |= USBPRE
+                elif args.sysclk * 2 != args.usb * 3:
+                    continue
+
+            return {'src': name, 'cfgr': cfgr, 'pll': mul}
+
+    raise ValueError('no PLL setting gives %d Hz%s' %
+                     (args.sysclk, ' with a 48MHz USB clock' if args.usb else ''))
+
+
+def pick_div(divs, fin, fmax, what):
+    for div in sorted(divs):
+        if fin // div <= fmax:
+            return div
+
+    raise ValueError('%s cannot be brought under %d Hz' % (what, fmax))
+
+
+def solve(args):
+    res = solve_sysclk(args)
+    hclk = args.sysclk
+
+    apb1 = pick_div(APB_DIVS, hclk, args.apb1_max, 'APB1')
+    apb2 = pick_div(APB_DIVS, hclk, args.apb2_max, 'APB2')
+    pclk2 = hclk // apb2
+    adc = pick_div(ADC_DIVS, pclk2, args.adc_max, 'ADC clock')
+
+    res['cfgr'] |= APB_DIVS[apb1] << PPRE1_POS
+    res['cfgr'] |= APB_DIVS[apb2] << PPRE2_POS
+    res['cfgr'] |= ADC_DIVS[adc] << ADCPRE_POS
+
+    res['sysclk'] = args.sysclk
+    res['hclk'] = hclk
+    res['pclk1'] = hclk // apb1
+    res['pclk2'] = pclk2
+    # timers run at twice PCLK when their APB is divided
+    res['timclk1'] = res['pclk1'] * (1 if apb1 == 1 else 2)
+    res['timclk2'] = pclk2 * (1 if apb2 == 1 else 2)
+    res['adcclk'] = pclk2 // adc
+    res['usbclk'] = args.usb
+    res['latency'] = 0 if hclk <= 24000000 else 1 if hclk <= 48000000 else 2
+
+    return res
+
+
+def emit(args, res):
+    lines = [
+        '// generated by tools/clock_solver.py, do not edit',
+        '',
+        '#ifndef __CLOCK_TREE_CONFIG_H__',
+        '#define __CLOCK_TREE_CONFIG_H__',
+        '',
+        '// sysclk source: %s%s' % (res['src'], ' x%d' % res['pll'] if res['pll'] else ''),
+        '#define CLOCK_TREE_HSE_HZ        %dUL' % args.hse,
+        '#define CLOCK_TREE_SYSCLK_HZ     %dUL' % res['sysclk'],
+        '#define CLOCK_TREE_HCLK_HZ       %dUL' % res['hclk'],
+        '#define CLOCK_TREE_PCLK1_HZ      %dUL' % res['pclk1'],
+        '#define CLOCK_TREE_PCLK2_HZ      %dUL' % res['pclk2'],
+        '#define CLOCK_TREE_TIMCLK1_HZ    %dUL' % res['timclk1'],
+        '#define CLOCK_TREE_TIMCLK2_HZ    %dUL' % res['timclk2'],
+        '#define CLOCK_TREE_ADCCLK_HZ     %dUL' % res['adcclk'],
+        '#define CLOCK_TREE_USBCLK_HZ     %dUL' % res['usbclk'],
+        '',
+        '#define CLOCK_TREE_CFGR          0x%08XUL' % res['cfgr'],
+        '#define CLOCK_TREE_FLASH_LATENCY %d' % res['latency'],
+        '#define CLOCK_TREE_USE_HSE       %d' % (1 if res['src'].startswith('HSE') else 0),
+        '#define CLOCK_TREE_USE_PLL       %d' % (1 if res['pll'] else 0),
+        '',
+        '#endif // __CLOCK_TREE_CONFIG_H__',
+        '',
+    ]
+
+    with open(args.output, 'w') as f:
+        f.write('\n'.join(lines))
+
+
+if __name__ == '__main__':
+    args = process_args()
+
+    try:
+        res = solve(args)
+    except ValueError as e:
+        print('clock_solver: %s' % e, file=sys.stderr)
+        sys.exit(1)
+
+    emit(args, res)
+    print('sysclk %d Hz from %s, pclk1 %d, pclk2 %d, adc %d' %
+          (res['sysclk'], res['src'], res['pclk1'], res['pclk2'], res['adcclk']))
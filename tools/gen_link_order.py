@@ -0,0 +1,94 @@
+#! env python
+# Turn a hot function list into a linker script fragment that places those
+# functions first in .text, or build the list from PC samples.
+from argparse import ArgumentParser
+from collections import Counter
+from bisect import bisect_right
+import sys
+
+
+def process_args():
+    parser = ArgumentParser('gen_link_order', description='hot/cold link order')
+    parser.add_argument('hot_list', nargs='?', help='one function per line, # starts a comment')
+    parser.add_argument('-o', '--output', required=True)
+    parser.add_argument('--nm', help='`nm -n` output of the image the samples came from')
+    parser.add_argument('--samples', help='one sampled PC (hex) per line')
+    parser.add_argument('--top', type=int, default=32, help='functions kept from the samples')
+
+    return parser.parse_args()
+
+
+def read_hot_list(path):
+    names = []
+
+    with open(path) as f:
+        for line in f:
+            name = line.split('#')[0].strip()
+            if name and name not in names:
+                names.append(name)
+
+    return names
+
+
+def read_symbols(path):
+    syms = []
+
+    with open(path) as f:
+        for line in f:
+            part = line.split()
+            if len(part) == 3 and part[1] in 'tTwW':
+                # thumb function addresses have bit 0 set
+                syms.append((int(part[0], 16) & ~1, part[2]))
+
+    syms.sort()
+    return syms
+
+
+def rank_samples(nm_path, samples_path, top):
+    syms = read_symbols(nm_path)
+    addrs = [addr for addr, _ in syms]
+    hits = Counter()
+
+    with open(samples_path) as f:
+        for line in f:
+            line = line.strip()
+            if not line:
+                continue
+
+            idx = bisect_right(addrs, int(line, 16)) - 1
+            if idx >= 0:
+                hits[syms[idx][1]] += 1
+
+    total = sum(hits.values())
+    lines = ['# generated by tools/gen_link_order.py from %d samples' % total]
+    for name, count in hits.most_common(top):
+        lines.append('%-40s # %5.1f%%' % (name, 100.0 * count / total))
+
+    return '\n'.join(lines) + '\n'
+
+
+def emit_fragment(names):
+    lines = ['/* generated by tools/gen_link_order.py, do not edit */']
+
+    # clones like foo.constprop.0 or foo.part.0 follow their function
+    for name in names:
+        lines.append('*(.text.%s .text.%s.*)' % (name, name))
+
+    return '\n'.join(lines) + '\n'
+
+
+if __name__ == '__main__':
+    args = process_args()
+
+    if args.samples or args.nm:
+        if not (args.samples and args.nm):
+            print('gen_link_order: --samples needs --nm and the other way round',
+                  file=sys.stderr)
+            sys.exit(1)
+
+        out = rank_samples(args.nm, args.samples, args.top)
+    else:
+        out = emit_fragment(read_hot_list(args.hot_list) if args.hot_list else [])
+
+    with open(args.output, 'w') as f:
+        f.write(out)
@@ -0,0 +1,124 @@
+#! env python
+# Compare the optimization profiles of target_dict: flash and RAM from the
+# board image of every profile, timings from the 'bench' command of its
+# semihosting image run in QEMU (instruction based, see qemu_run.py).
+from argparse import ArgumentParser
+import json
+import os
+import subprocess
+import sys
+import tempfile
+
+QEMU_RUN = os.path.join(os.path.dirname(os.path.abspath(__file__)), 'qemu_run.py')
+
+
+def process_args():
+    parser = ArgumentParser('profile_report', description='size and speed of the optimization profiles')
+    parser.add_argument('profiles', nargs='+', metavar='name=image[,bench_image]',
+                        help='board image and the semihosting image built with the same flags')
+    parser.add_argument('--size', default='arm-none-eabi-size')
+    parser.add_argument('--qemu', help='qemu-system-arm, without it only the sizes are reported')
+    parser.add_argument('--json', help='write the collected numbers here')
+
+    return parser.parse_args()
+
+
+def parse_profile(spec):
+    name, images = spec.split('=', 1)
+    images = images.split(',')
+
+    return name, images[0], images[1] if len(images) > 1 else None
+
+
+def image_size(size_tool, image):
+    out = subprocess.run([size_tool, '-B', image], stdout=subprocess.PIPE,
+                         check=True).stdout.decode()
+    text, data, bss = [int(v) for v in out.splitlines()[1].split()[:3]]
+
+    return {'text': text, 'data': data, 'bss': bss, 'flash': text + data, 'ram': data + bss}
+
+
+# median cycles per case, 'error=<n>' or 'skipped' for the cases without
+# numbers. a failed case also fails the run, the others still count
+def bench_cycles(qemu, image):
+    with tempfile.TemporaryDirectory() as tmp:
+        results = os.path.join(tmp, 'results.json')
+        proc = subprocess.run([sys.executable, QEMU_RUN, '-q', '--qemu', qemu,
+                               '--results', results, image, 'bench'])
+        if not os.path.exists(results):
+            return None
+
+        with open(results) as f:
+            bench = json.load(f).get('bench')
+
+    if 0 != proc.returncode:
+        print('profile_report: %s exited with %d' % (image, proc.returncode), file=sys.stderr)
+
+    if not bench:
+        return None
+
+    cycles = {}
+    for name, case in bench['cases'].items():
+        if 'med' in case:
+            cycles[name] = case['med']
+        elif 'error' in case:
+            cycles[name] = 'error=%s' % case['error']
+        else:
+            cycles[name] = 'skipped'
+
+    return cycles
+
+
+def print_table(report):
+    names = list(report)
+    rows = [('flash', [report[n]['flash'] for n in names]),
+            ('ram', [report[n]['ram'] for n in names])]
+
+    cases = []
+    for n in names:
+        for case in report[n].get('bench') or {}:
+            if case not in cases:
+                cases.append(case)
+
+    for case in cases:
+        rows.append((case, [(report[n].get('bench') or {}).get(case, '-') for n in names]))
+
+    width = max([len(r[0]) for r in rows] + [5])
+    print(' ' * width + ''.join('%12s' % n for n in names))
+    for label, values in rows:
+        print(label.ljust(width) + ''.join('%12s' % v for v in values))
+
+    if cases:
+        print('bench cases: median SysTick counts in QEMU, 32ns per '
+              'instruction, not core cycles')
+
+    failed = ['%s/%s' % (n, case) for n in names
+              for case, value in (report[n].get('bench') or {}).items()
+              if str(value).startswith('error')]
+    if failed:
+        print('failed bench cases: ' + ', '.join(failed))
+
+
+if __name__ == '__main__':
+    args = process_args()
+    report = {}
+
+    for spec in args.profiles:
+        name, image, bench_image = parse_profile(spec)
+
+        try:
+            report[name] = image_size(args.size, image)
+        except (OSError, subprocess.CalledProcessError) as e:
+            print('profile_report: cannot size %s: %s' % (image, e), file=sys.stderr)
+            sys.exit(2)
+
+        if args.qemu and bench_image:
+            report[name]['bench'] = bench_cycles(args.qemu, bench_image)
+            if report[name]['bench'] is None:
+                print('profile_report: no bench results from %s' % bench_image, file=sys.stderr)
+
+    print_table(report)
+
+    if args.json:
+        with open(args.json, 'w') as f:
+            json.dump(report, f, indent=2)
@@ -0,0 +1,143 @@
+#! env python
+# Run a semihosting image (CONFIG_SEMIHOSTING=1) under qemu-system-arm, type
+# console commands into it and turn what it prints into an exit status.
+from argparse import ArgumentParser
+import json
+import re
+import subprocess
+import sys
+
+# lines of the run_tc console command
+TEST_RES = re.compile(r'(passed|failed) \[(\d+)/(\d+)\]')
+# key=value records of the bench console command
+BENCH_RES = re.compile(r'bench: (.*)$')
+
+EXIT_TESTS_FAILED = 1
+EXIT_TIMEOUT = 124
+
+
+def process_args():
+    parser = ArgumentParser('qemu_run', description='run a firmware image in QEMU')
+    parser.add_argument('image', help='ELF image built with CONFIG_SEMIHOSTING=1')
+    parser.add_argument('commands', nargs='*',
+                        help='console commands, read from stdin (one per line) when none are given')
+    parser.add_argument('--qemu', default='qemu-system-arm')
+    parser.add_argument('--machine', default='stm32vldiscovery', help='a Cortex-M3 machine of QEMU')
+    # every instruction takes 2^5 = 32ns of virtual time (31.25MHz), no
+    # shift gives the 24MHz of the machine. the SysTick counts of the image
+    # are then 0.768 per instruction rather than core cycles, but the same
+    # image gives the same counts on every run
+    parser.add_argument('--icount', default='shift=5,align=off,sleep=off')
+    parser.add_argument('--timeout', type=float, default=60, help='seconds')
+    parser.add_argument('--results', help='write the collected results here (JSON)')
+    parser.add_argument('-q', '--quiet', action='store_true', help='do not echo the firmware output')
+
+    return parser.parse_args()
+
+
+def read_commands(args):
+    if args.commands:
+        return args.commands
+
+    if sys.stdin.isatty():
+        return []
+
+    return [line.strip() for line in sys.stdin if line.strip()]
+
+
+def qemu_cmdline(args, commands):
+    return [
+        args.qemu,
+        '-M', args.machine,
+        '-display', 'none',
+        '-monitor', 'none',
+        '-serial', 'null',
+        '-icount', args.icount,
+        '-semihosting-config', 'enable=on,target=native',
+        '-kernel', args.image,
+        # the firmware splits the commands at ';'
+        '-append', ';'.join(commands),
+    ]
+
+
+def run(args, commands):
+    # older QEMU versions print the semihosting console on stderr
+    try:
+        proc = subprocess.run(qemu_cmdline(args, commands), stdout=subprocess.PIPE,
+                              stderr=subprocess.STDOUT, timeout=args.timeout)
+    except subprocess.TimeoutExpired as e:
+        return EXIT_TIMEOUT, e.output or b''
+
+    return proc.returncode, proc.stdout
+
+
+def collect(output):
+    lines = [line.rstrip('\r') for line in output.decode(errors='replace').split('\n')]
+    tests = None
+    bench = {'cases': {}}
+
+    for line in lines:
+        match = BENCH_RES.search(line)
+        if match:
+            record = dict(kv.split('=', 1) for kv in match.group(1).split() if '=' in kv)
+            for key, value in record.items():
+                if value.isdigit() or value.lstrip('-').isdigit():
+                    record[key] = int(value)
+
+            # the first line of every run describes the counter
+            name = record.pop('name', None)
+            if name is None:
+                bench.update(record)
+            else:
+                bench['cases'][name] = record
+            continue
+
+        match = TEST_RES.search(line)
+        if not match:
+            continue
+
+        tests = tests or {'passed': 0, 'failed': 0, 'total': 0}
+        tests[match.group(1)] += int(match.group(2))
+        if 'passed' == match.group(1):
+            tests['total'] += int(match.group(3))
+
+    return lines, tests, bench if bench['cases'] else None
+
+
+if __name__ == '__main__':
+    args = process_args()
+    commands = read_commands(args)
+
+    try:
+        status, output = run(args, commands)
+    except OSError as e:
+        print('qemu_run: cannot start %s: %s' % (args.qemu, e), file=sys.stderr)
+        sys.exit(2)
+
+    lines, tests, bench = collect(output)
+
+    if not args.quiet:
+        print('\n'.join(lines))
+
+    if args.results:
+        with open(args.results, 'w') as f:
+            json.dump({
+                'image': args.image,
+                'machine': args.machine,
+                'commands': commands,
+                'status': status,
+                'tests': tests,
+                'bench': bench,
+                'output': lines,
+            }, f, indent=2)
+
+    if EXIT_TIMEOUT == status:
+        print('qemu_run: no exit after %g s' % args.timeout, file=sys.stderr)
+    elif 0 != status:
+        print('qemu_run: firmware exited with %d' % status, file=sys.stderr)
+    elif tests and tests['failed']:
+        print('qemu_run: %d of %d test cases failed' % (tests['failed'], tests['total']),
+              file=sys.stderr)
+        status = EXIT_TESTS_FAILED
+
+    sys.exit(status)